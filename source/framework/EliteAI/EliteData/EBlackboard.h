@@ -10,47 +10,166 @@
 
 //Includes
 #include <unordered_map>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <new>
 #include <stdafx.h>
 
 namespace Elite
 {
 	//-----------------------------------------------------------------
-	// BLACKBOARD TYPES (BASE)
+	// BLACKBOARD KEYS
 	//-----------------------------------------------------------------
-	class IBlackBoardField
+	//Identifies a type without RTTI, every T gets its own address
+	using BlackboardTypeId = const void*;
+	template<typename T>
+	struct BlackboardTypeTag
+	{
+		static const char id;
+	};
+	template<typename T>
+	const char BlackboardTypeTag<T>::id = 0;
+
+	template<typename T>
+	BlackboardTypeId GetBlackboardTypeId() { return &BlackboardTypeTag<T>::id; }
+
+	//Global table of all keys, a name and type pair always gets the same slot index in every blackboard.
+	//The same name with another type is another slot, asking for the wrong type finds nothing (like the old dynamic_cast)
+	class BlackboardKeyRegistry final
 	{
 	public:
-		IBlackBoardField() = default;
-		virtual ~IBlackBoardField() = default;
+		static int Intern(const std::string& name, BlackboardTypeId typeId)
+		{
+			std::vector<std::pair<BlackboardTypeId, int>>& slots = GetIndices()[name];
+			for(const auto& slot : slots)
+			{
+				if(slot.first == typeId)
+					return slot.second;
+			}
+
+			const int index = static_cast<int>(GetNames().size());
+			GetNames().push_back(name);
+			slots.push_back(std::make_pair(typeId, index));
+			return index;
+		}
+
+		static const std::string& GetName(int index)
+		{
+			static const std::string invalidName{ "<invalid key>" };
+			return index >= 0 && index < static_cast<int>(GetNames().size()) ? GetNames()[index] : invalidName;
+		}
+
+		static int GetNrOfKeys() { return static_cast<int>(GetNames().size()); }
+
+	private:
+		//Function statics, keys can be created during static initialization
+		static std::unordered_map<std::string, std::vector<std::pair<BlackboardTypeId, int>>>& GetIndices()
+		{
+			static std::unordered_map<std::string, std::vector<std::pair<BlackboardTypeId, int>>> indices{};
+			return indices;
+		}
+		static std::vector<std::string>& GetNames()
+		{
+			static std::vector<std::string> names{};
+			return names;
+		}
+	};
+
+	//Key without its type, to refer to entries of different types together (e.g. the keys a conditional observes)
+	class BlackboardKeyBase
+	{
+	public:
+		int GetIndex() const { return m_Index; }
+		bool IsValid() const { return m_Index >= 0; }
+		const std::string& GetName() const { return BlackboardKeyRegistry::GetName(m_Index); }
+
+	protected:
+		BlackboardKeyBase() = default;
+		explicit BlackboardKeyBase(int index) : m_Index(index) {}
+
+		int m_Index = -1;
 	};
 
-	//BlackboardField does not take ownership of pointers whatsoever!
+	//Typed handle to a blackboard entry, the name is looked up once when the key is made.
+	//Make keys once (e.g. as constants next to the behaviors) and reuse them, access is then an index and a static_cast
 	template<typename T>
-	class BlackboardField: public IBlackBoardField
+	class BlackboardKey final : public BlackboardKeyBase
 	{
 	public:
-		explicit BlackboardField(T data): m_Data(data)
+		using ValueType = T;
+
+		BlackboardKey() = default;
+		explicit BlackboardKey(const std::string& name)
+			: BlackboardKeyBase(BlackboardKeyRegistry::Intern(name, GetBlackboardTypeId<T>()))
 		{}
-		T GetData() { return m_Data; };
-		void SetData(T data) { m_Data = data; }
+	};
+
+	//-----------------------------------------------------------------
+	// BLACKBOARD SCHEMA
+	//-----------------------------------------------------------------
+	//Layout of a blackboard: every field gets a fixed offset in one buffer. Make one schema for all the agents of a kind
+	//and pass it to their blackboards, each blackboard is then a single allocation.
+	//Values are copied as bytes and never destroyed, so only trivially copyable types (pointers, numbers, vectors) can be stored.
+	class BlackboardSchema final
+	{
+	public:
+		struct Field
+		{
+			int keyIndex;
+			size_t offset;
+			size_t size;
+		};
+
+		template<typename T> bool AddField(const BlackboardKey<T>& key)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Blackboard data is copied as bytes, store a pointer to this type instead");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Blackboard buffers are only aligned to std::max_align_t");
+
+			if(!key.IsValid() || GetFieldIndex(key.GetIndex()) >= 0)
+				return false;
+
+			const size_t offset{ (m_ValuesSize + alignof(T) - 1) / alignof(T) * alignof(T) };
+			m_Fields.push_back(Field{ key.GetIndex(), offset, sizeof(T) });
+			m_ValuesSize = offset + sizeof(T);
+
+			if(key.GetIndex() >= static_cast<int>(m_FieldIndices.size()))
+				m_FieldIndices.resize(key.GetIndex() + 1, -1);
+			m_FieldIndices[key.GetIndex()] = static_cast<int>(m_Fields.size()) - 1;
+			return true;
+		}
+
+		int GetFieldIndex(int keyIndex) const
+		{
+			return keyIndex >= 0 && keyIndex < static_cast<int>(m_FieldIndices.size()) ? m_FieldIndices[keyIndex] : -1;
+		}
+		const Field& GetField(int fieldIndex) const { return m_Fields[fieldIndex]; }
+		int GetNrOfFields() const { return static_cast<int>(m_Fields.size()); }
+
+		size_t GetValuesSize() const { return m_ValuesSize; }
+		//The values, then per field the version of its last change and a byte that tells if it's set
+		size_t GetBufferSize() const { return GetVersionsOffset(m_ValuesSize) + m_Fields.size() * (sizeof(unsigned int) + 1); }
+		static size_t GetVersionsOffset(size_t valuesSize) { return (valuesSize + alignof(unsigned int) - 1) / alignof(unsigned int) * alignof(unsigned int); }
 
 	private:
-		T m_Data;
+		std::vector<Field> m_Fields;
+		std::vector<int> m_FieldIndices;  //Indexed by key, -1 when the key isn't in the schema
+		size_t m_ValuesSize = 0;  //Fields are only appended, so existing offsets never change
 	};
 
 	//-----------------------------------------------------------------
 	// BLACKBOARD (BASE)
 	//-----------------------------------------------------------------
+	//Blackboard does not take ownership of pointers whatsoever!
 	class Blackboard final
 	{
 	public:
-		Blackboard() = default;
-		~Blackboard()
-		{
-			for(auto el : m_BlackboardData)
-				SAFE_DELETE(el.second);
-			m_BlackboardData.clear();
-		}
+		//Without a schema the blackboard makes its own, it grows with every new key that is added
+		Blackboard() : m_pSchema(&m_LocalSchema) {}
+		//The schema is shared and has to outlive the blackboard, only its keys can be added
+		explicit Blackboard(const BlackboardSchema* pSchema) : m_pSchema(pSchema) { Resize(); }
+		~Blackboard() = default;
 
 		Blackboard(const Blackboard& other) = delete;
 		Blackboard& operator=(const Blackboard& other) = delete;
@@ -58,50 +177,135 @@ namespace Elite
 		Blackboard& operator=(Blackboard&& other) = delete;
 
 		//Add data to the blackboard
-		template<typename T> bool AddData(const std::string& name, T data)
+		template<typename T> bool AddData(const BlackboardKey<T>& key, typename BlackboardKey<T>::ValueType data)
 		{
-			auto it = m_BlackboardData.find(name);
-			if(it == m_BlackboardData.end())
+			int fieldIndex = GetFieldIndex(key.GetIndex());
+			if(fieldIndex < 0 && m_pSchema == &m_LocalSchema && m_LocalSchema.AddField(key))
 			{
-				m_BlackboardData[name] = new BlackboardField<T>(data);
-				return true;
+				Resize();
+				fieldIndex = GetFieldIndex(key.GetIndex());
 			}
-			printf("WARNING: Data '%s' of type '%s' already in Blackboard \n", name.c_str(), typeid(T).name());
-			return false;
+
+			if(fieldIndex < 0)
+			{
+				printf("WARNING: Data '%s' of type '%s' not in the Blackboard schema \n", key.GetName().c_str(), typeid(T).name());
+				return false;
+			}
+			if(GetFlags()[fieldIndex] != 0)
+			{
+				printf("WARNING: Data '%s' of type '%s' already in Blackboard \n", key.GetName().c_str(), typeid(T).name());
+				return false;
+			}
+
+			new (GetBytes() + m_pSchema->GetField(fieldIndex).offset) T(data);
+			GetFlags()[fieldIndex] = 1;
+			MarkChanged(fieldIndex);
+			return true;
 		}
 
 		//Change the data of the blackboard
-		template<typename T> bool ChangeData(const std::string& name, T data)
+		template<typename T> bool ChangeData(const BlackboardKey<T>& key, typename BlackboardKey<T>::ValueType data)
 		{
-			auto it = m_BlackboardData.find(name);
-			if(it != m_BlackboardData.end())
+			T* p = GetValue(key);
+			if(p)
 			{
-				BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(m_BlackboardData[name]);
-				if(p)
+				//Writing the same value again is not a change, observers only care about new values
+				if(std::memcmp(p, &data, sizeof(T)) != 0)
 				{
-					p->SetData(data);
-					return true;
+					*p = data;
+					MarkChanged(GetFieldIndex(key.GetIndex()));
 				}
+				return true;
 			}
-			printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
+			printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.GetName().c_str(), typeid(T).name());
 			return false;
 		}
 
 		//Get the data from the blackboard
-		template<typename T> bool GetData(const std::string& name, T& data)
+		template<typename T> bool GetData(const BlackboardKey<T>& key, T& data) const
 		{
-			BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(m_BlackboardData[name]);
+			const T* p = GetValue(key);
 			if(p != nullptr)
 			{
-				data = p->GetData();
+				data = *p;
 				return true;
 			}
-			printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
+			printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.GetName().c_str(), typeid(T).name());
 			return false;
 		}
 
+		template<typename T> bool HasData(const BlackboardKey<T>& key) const { return GetValue(key) != nullptr; }
+
+		//--- Changes ---
+		//Every add or change of a value gets the next version, observers remember the version they saw and check what changed since
+		unsigned int GetVersion() const { return m_Version; }
+		bool HasChangedSince(const BlackboardKeyBase& key, unsigned int version) const
+		{
+			const int fieldIndex{ GetFieldIndex(key.GetIndex()) };
+			return fieldIndex >= 0 && GetVersions()[fieldIndex] > version;
+		}
+		//For changes the blackboard can't see itself, like the data behind a stored pointer
+		void MarkChanged(const BlackboardKeyBase& key)
+		{
+			const int fieldIndex{ GetFieldIndex(key.GetIndex()) };
+			if(fieldIndex >= 0)
+				MarkChanged(fieldIndex);
+		}
+
+		//By name, looks the key up on every call. Fine for setup, use a BlackboardKey in anything that runs every frame
+		template<typename T> bool AddData(const std::string& name, T data) { return AddData(BlackboardKey<T>{ name }, data); }
+		template<typename T> bool ChangeData(const std::string& name, T data) { return ChangeData(BlackboardKey<T>{ name }, data); }
+		template<typename T> bool GetData(const std::string& name, T& data) const { return GetData(BlackboardKey<T>{ name }, data); }
+
 	private:
-		std::unordered_map<std::string, IBlackBoardField*> m_BlackboardData;
+		//Fields added to a shared schema after this blackboard was made are not in the buffer
+		int GetFieldIndex(int keyIndex) const
+		{
+			const int fieldIndex{ m_pSchema->GetFieldIndex(keyIndex) };
+			return fieldIndex < m_NrOfFields ? fieldIndex : -1;
+		}
+
+		//A key is only made for one T, so the bytes at its offset are always a T
+		template<typename T> T* GetValue(const BlackboardKey<T>& key) const
+		{
+			const int fieldIndex{ GetFieldIndex(key.GetIndex()) };
+			if(fieldIndex < 0 || GetFlags()[fieldIndex] == 0)
+				return nullptr;
+			return reinterpret_cast<T*>(GetBytes() + m_pSchema->GetField(fieldIndex).offset);
+		}
+
+		void MarkChanged(int fieldIndex) { GetVersions()[fieldIndex] = ++m_Version; }
+
+		//Values keep their offsets when the schema grows, only the versions and set flags move behind them
+		void Resize()
+		{
+			std::vector<std::max_align_t> buffer((m_pSchema->GetBufferSize() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(buffer.data());
+			std::memset(pBytes, 0, buffer.size() * sizeof(std::max_align_t));  //The flags can land in padding, value-initializing doesn't clear that
+			if(!m_Buffer.empty())
+			{
+				const size_t versionsOffset{ BlackboardSchema::GetVersionsOffset(m_pSchema->GetValuesSize()) };
+				const size_t flagsOffset{ versionsOffset + m_pSchema->GetNrOfFields() * sizeof(unsigned int) };
+				std::memcpy(pBytes, GetBytes(), m_ValuesSize);
+				std::memcpy(pBytes + versionsOffset, GetVersions(), m_NrOfFields * sizeof(unsigned int));
+				std::memcpy(pBytes + flagsOffset, GetFlags(), m_NrOfFields);
+			}
+
+			m_Buffer.swap(buffer);
+			m_ValuesSize = m_pSchema->GetValuesSize();
+			m_NrOfFields = m_pSchema->GetNrOfFields();
+		}
+
+		unsigned char* GetBytes() const { return reinterpret_cast<unsigned char*>(const_cast<std::max_align_t*>(m_Buffer.data())); }
+		unsigned int* GetVersions() const { return reinterpret_cast<unsigned int*>(GetBytes() + BlackboardSchema::GetVersionsOffset(m_ValuesSize)); }
+		unsigned char* GetFlags() const { return reinterpret_cast<unsigned char*>(GetVersions() + m_NrOfFields); }
+
+		BlackboardSchema m_LocalSchema;  //Only used without a shared schema
+		const BlackboardSchema* m_pSchema;
+		std::vector<std::max_align_t> m_Buffer;  //The values at their schema offsets, then the versions and set flags
+		size_t m_ValuesSize = 0;
+		int m_NrOfFields = 0;
+		unsigned int m_Version = 0;
 	};
 }
 #endif
\ No newline at end of file
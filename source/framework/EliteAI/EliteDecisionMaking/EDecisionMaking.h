@@ -31,6 +31,10 @@ namespace Elite
 #include "framework/EliteAI/EliteDecisionMaking/EliteFiniteStateMachine/EFiniteStateMachine.h"
 #include "framework/EliteAI/EliteDecisionMaking/EliteBehaviorTree/EBehaviorTree.h"
 
+/* --- Scheduling --- */
+#include "framework/EliteAI/EliteDecisionMaking/EDecisionMakingScheduler.h"
+#include "framework/EliteAI/EliteDecisionMaking/EParallelDecisionMaking.h"
+
 
 #endif
 
@@ -0,0 +1,87 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EDecisionMakingScheduler.h"
+using namespace Elite;
+
+//-----------------------------------------------------------------
+// DECISION MAKING SCHEDULER
+//-----------------------------------------------------------------
+DecisionMakingScheduler::DecisionMakingScheduler(std::vector<LevelOfDetail> levels)
+	: m_Levels(levels)
+{
+	std::sort(m_Levels.begin(), m_Levels.end(),
+		[](const LevelOfDetail& a, const LevelOfDetail& b) { return a.maxDistance < b.maxDistance; });
+}
+
+void DecisionMakingScheduler::BeginFrame(const Vector2& focus)
+{
+	//Frames without updates say nothing about their cost
+	if(m_CurrentNrOfUpdates > 0)
+	{
+		const double millisecondsPerUpdate = m_CurrentMilliseconds / m_CurrentNrOfUpdates;
+		m_MillisecondsPerUpdate = m_MillisecondsPerUpdate > 0.0
+			? m_MillisecondsPerUpdate * 0.9 + millisecondsPerUpdate * 0.1
+			: millisecondsPerUpdate;
+	}
+
+	m_NrOfUpdates = m_CurrentNrOfUpdates;
+	m_NrOfDeferred = m_CurrentNrOfDeferred;
+	m_Milliseconds = m_CurrentMilliseconds;
+	m_CurrentNrOfUpdates = 0;
+	m_CurrentNrOfDeferred = 0;
+	m_CurrentMilliseconds = 0.0;
+
+	m_Focus = focus;
+	++m_Frame;
+}
+
+bool DecisionMakingScheduler::IsDue(Schedule& schedule, const Vector2& position)
+{
+	if(!schedule.isDeferred)
+	{
+		const int frameInterval = GetFrameInterval(position);
+		if((m_Frame + static_cast<unsigned int>(schedule.phase)) % static_cast<unsigned int>(frameInterval) != 0)
+			return false;
+
+		const double expectedMilliseconds = (m_CurrentNrOfUpdates + 1) * m_MillisecondsPerUpdate;
+		if(m_TimeBudget > 0.f && expectedMilliseconds > m_TimeBudget)
+		{
+			schedule.isDeferred = true;
+			++m_CurrentNrOfDeferred;
+			return false;
+		}
+	}
+
+	schedule.isDeferred = false;
+	++m_CurrentNrOfUpdates;
+	return true;
+}
+
+int DecisionMakingScheduler::GetFrameInterval(const Vector2& position) const
+{
+	if(m_Levels.empty())
+		return 1;
+
+	const float distanceSquared = position.DistanceSquared(m_Focus);
+	for(const LevelOfDetail& level : m_Levels)
+	{
+		if(distanceSquared <= level.maxDistance * level.maxDistance)
+			return std::max(level.frameInterval, 1);
+	}
+	return std::max(m_Levels.back().frameInterval, 1);
+}
+
+//-----------------------------------------------------------------
+// SCHEDULED DECISION MAKING
+//-----------------------------------------------------------------
+void ScheduledDecisionMaking::Update(float deltaT)
+{
+	//The skipped frames are not lost, timers in the decision making see the whole time when it's their turn
+	m_PendingTime += deltaT;
+	if(m_pDecisionMaking == nullptr || !m_pScheduler->IsDue(m_Schedule, m_fpGetPosition()))
+		return;
+
+	DecisionMakingScheduler::TimeScope timeScope{ *m_pScheduler };
+	m_pDecisionMaking->Update(m_PendingTime);
+	m_PendingTime = 0.f;
+}
@@ -0,0 +1,119 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// EDecisionMakingScheduler.h: spreads the decision making of many agents over the frames.
+// Agents close to the focus (e.g. the player) decide every frame, agents further away every few frames. The agents of one
+// level take turns (round robin), so every frame gets a similar share. With a time budget, updates that don't fit in a
+// frame move to the next one.
+/*=============================================================================*/
+#ifndef ELITE_DECISION_MAKING_SCHEDULER
+#define ELITE_DECISION_MAKING_SCHEDULER
+
+namespace Elite
+{
+	class DecisionMakingScheduler final
+	{
+	public:
+		//Agents up to maxDistance from the focus update every frameInterval frames, the last level is used for every agent further away
+		struct LevelOfDetail
+		{
+			float maxDistance;
+			int frameInterval;
+		};
+
+		//What the scheduler needs to know of one agent, kept by the ScheduledDecisionMaking
+		struct Schedule
+		{
+			int phase = 0;  //Which frames of the interval are the turns of this agent
+			bool isDeferred = false;  //Missed its turn because of the budget, goes first next frame
+		};
+
+		//Measures work done for the scheduled agents outside their own update (e.g. a BehaviorTreeBatch)
+		class TimeScope final
+		{
+		public:
+			explicit TimeScope(DecisionMakingScheduler& scheduler)
+				: m_Scheduler(scheduler), m_Start(std::chrono::high_resolution_clock::now()) {}
+			~TimeScope()
+			{
+				m_Scheduler.AddTime(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_Start).count());
+			}
+
+			TimeScope(const TimeScope&) = delete;
+			TimeScope& operator=(const TimeScope&) = delete;
+
+		private:
+			DecisionMakingScheduler& m_Scheduler;
+			std::chrono::high_resolution_clock::time_point m_Start;
+		};
+
+		explicit DecisionMakingScheduler(std::vector<LevelOfDetail> levels = { { 40.f, 1 }, { 80.f, 2 }, { FLT_MAX, 4 } });
+
+		//Call once per frame, before the agents update
+		void BeginFrame(const Vector2& focus);
+
+		//0 = no budget. Agents that were deferred once always get their turn, so the budget can be exceeded when too
+		//many agents are due at once
+		void SetTimeBudget(float milliseconds) { m_TimeBudget = milliseconds; }
+		float GetTimeBudget() const { return m_TimeBudget; }
+
+		Schedule CreateSchedule() { return Schedule{ m_NextPhase++, false }; }
+		//Asks if the agent at this position has its turn this frame, counts it as an update when it does
+		bool IsDue(Schedule& schedule, const Vector2& position);
+		void AddTime(double milliseconds) { m_CurrentMilliseconds += milliseconds; }
+
+		//--- Stats of the last whole frame ---
+		int GetNrOfUpdates() const { return m_NrOfUpdates; }
+		int GetNrOfDeferred() const { return m_NrOfDeferred; }
+		double GetMilliseconds() const { return m_Milliseconds; }
+
+	private:
+		int GetFrameInterval(const Vector2& position) const;
+
+		std::vector<LevelOfDetail> m_Levels = {};
+		Vector2 m_Focus = {};
+		float m_TimeBudget = 0.f;
+		unsigned int m_Frame = 0;
+		int m_NextPhase = 0;
+
+		//The budget is checked before the work is done, with the average time of one update in the frames before
+		double m_MillisecondsPerUpdate = 0.0;
+		int m_CurrentNrOfUpdates = 0;
+		int m_CurrentNrOfDeferred = 0;
+		double m_CurrentMilliseconds = 0.0;
+
+		int m_NrOfUpdates = 0;
+		int m_NrOfDeferred = 0;
+		double m_Milliseconds = 0.0;
+	};
+
+	//Runs a decision making structure on the turns the scheduler gives it, with the time of the frames it skipped.
+	//Takes ownership of the decision making, the scheduler has to outlive it
+	class ScheduledDecisionMaking final : public IDecisionMaking
+	{
+	public:
+		ScheduledDecisionMaking(IDecisionMaking* pDecisionMaking, DecisionMakingScheduler* pScheduler, std::function<Vector2()> fpGetPosition)
+			: m_pDecisionMaking(pDecisionMaking), m_pScheduler(pScheduler), m_fpGetPosition(fpGetPosition),
+			m_Schedule(pScheduler->CreateSchedule()) {}
+		~ScheduledDecisionMaking()
+		{
+			SAFE_DELETE(m_pDecisionMaking);
+		}
+
+		ScheduledDecisionMaking(const ScheduledDecisionMaking&) = delete;
+		ScheduledDecisionMaking& operator=(const ScheduledDecisionMaking&) = delete;
+
+		virtual void Update(float deltaT) override;
+
+		IDecisionMaking* GetDecisionMaking() const { return m_pDecisionMaking; }
+
+	private:
+		IDecisionMaking* m_pDecisionMaking = nullptr;
+		DecisionMakingScheduler* m_pScheduler = nullptr;
+		std::function<Vector2()> m_fpGetPosition = nullptr;
+		DecisionMakingScheduler::Schedule m_Schedule = {};
+		float m_PendingTime = 0.f;
+	};
+}
+#endif
@@ -0,0 +1,196 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EParallelDecisionMaking.h"
+using namespace Elite;
+
+//-----------------------------------------------------------------
+// COMMAND BUFFER
+//-----------------------------------------------------------------
+thread_local DecisionCommandBuffer* DecisionCommandBuffer::s_pCurrentBuffer = nullptr;
+
+void DecisionCommandBuffer::Execute()
+{
+	for(const std::function<void()>& command : m_Commands)
+		command();
+	m_Commands.clear();
+}
+
+void DecisionCommandBuffer::Submit(std::function<void()> command)
+{
+	if(s_pCurrentBuffer != nullptr)
+		s_pCurrentBuffer->Add(std::move(command));
+	else
+		command();
+}
+
+//-----------------------------------------------------------------
+// WORKERS
+//-----------------------------------------------------------------
+DecisionWorkers::DecisionWorkers(int nrOfThreads, int minItemsPerChunk)
+	: m_MinItemsPerChunk(std::max(minItemsPerChunk, 1))
+{
+	if(nrOfThreads <= 0)
+		nrOfThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	m_CommandBuffers.resize(nrOfThreads);
+	m_Threads.reserve(nrOfThreads - 1);
+	for(int chunkIndex = 1; chunkIndex < nrOfThreads; ++chunkIndex)
+		m_Threads.emplace_back(&DecisionWorkers::WorkerLoop, this, chunkIndex);
+}
+
+DecisionWorkers::~DecisionWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+	m_StartCondition.notify_all();
+	for(std::thread& thread : m_Threads)
+		thread.join();
+}
+
+void DecisionWorkers::ParallelFor(int nrOfItems, const Job& job)
+{
+	if(nrOfItems <= 0)
+		return;
+
+	//Chunk 0 is run by this thread, a worker per other chunk. With a single chunk no worker is woken
+	const int nrOfChunks = std::max(std::min(GetNrOfThreads(), nrOfItems / m_MinItemsPerChunk), 1);
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_pJob = &job;
+		m_NrOfItems = nrOfItems;
+		m_NrOfChunks = nrOfChunks;
+		m_NrOfBusyWorkers = nrOfChunks - 1;
+		++m_JobIndex;
+	}
+	if(nrOfChunks > 1)
+		m_StartCondition.notify_all();
+
+	RunChunk(0);
+
+	{
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+		m_DoneCondition.wait(lock, [this]() { return m_NrOfBusyWorkers == 0; });
+		m_pJob = nullptr;
+	}
+
+	//The sync point: every decision is made, now the world can change
+	for(int chunkIndex = 0; chunkIndex < nrOfChunks; ++chunkIndex)
+		m_CommandBuffers[chunkIndex].Execute();
+}
+
+void DecisionWorkers::WorkerLoop(int chunkIndex)
+{
+	unsigned int lastJobIndex = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_StartCondition.wait(lock, [this, lastJobIndex]() { return m_IsStopping || m_JobIndex != lastJobIndex; });
+			if(m_IsStopping)
+				return;
+			lastJobIndex = m_JobIndex;
+			if(chunkIndex >= m_NrOfChunks)
+				continue;  //Fewer items than threads
+		}
+
+		RunChunk(chunkIndex);
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			--m_NrOfBusyWorkers;
+		}
+		m_DoneCondition.notify_one();
+	}
+}
+
+void DecisionWorkers::RunChunk(int chunkIndex)
+{
+	const int firstItem = static_cast<int>(static_cast<long long>(m_NrOfItems) * chunkIndex / m_NrOfChunks);
+	const int endItem = static_cast<int>(static_cast<long long>(m_NrOfItems) * (chunkIndex + 1) / m_NrOfChunks);
+
+	DecisionCommandBuffer::s_pCurrentBuffer = &m_CommandBuffers[chunkIndex];
+	(*m_pJob)(firstItem, endItem, chunkIndex);
+	DecisionCommandBuffer::s_pCurrentBuffer = nullptr;
+}
+
+//-----------------------------------------------------------------
+// DECISION MAKING GROUP
+//-----------------------------------------------------------------
+DecisionMakingGroup::~DecisionMakingGroup()
+{
+	for(GroupedDecisionMaking* pMember : m_pMembers)
+		pMember->m_pGroup = nullptr;
+	m_pMembers.clear();
+}
+
+void DecisionMakingGroup::AddMember(GroupedDecisionMaking* pMember)
+{
+	m_pMembers.push_back(pMember);
+}
+
+void DecisionMakingGroup::RemoveMember(GroupedDecisionMaking* pMember)
+{
+	const auto it = std::find(m_pMembers.begin(), m_pMembers.end(), pMember);
+	if(it != m_pMembers.end())
+		m_pMembers.erase(it);
+}
+
+void DecisionMakingGroup::Update(DecisionWorkers* pWorkers)
+{
+	ELITE_PROFILE_SCOPE("DecisionMakingGroup::Update");
+
+	m_pWaitingMembers.clear();
+	for(GroupedDecisionMaking* pMember : m_pMembers)
+	{
+		if(pMember->m_IsWaiting)
+			m_pWaitingMembers.push_back(pMember);
+	}
+
+	const auto updateMembers = [this](int firstMember, int endMember, int)
+	{
+		for(int memberIndex = firstMember; memberIndex < endMember; ++memberIndex)
+		{
+			GroupedDecisionMaking* pMember = m_pWaitingMembers[memberIndex];
+			pMember->m_pDecisionMaking->Update(pMember->m_PendingTime);
+			pMember->m_PendingTime = 0.f;
+			pMember->m_IsWaiting = false;
+		}
+	};
+
+	const int nrOfWaitingMembers = static_cast<int>(m_pWaitingMembers.size());
+	if(pWorkers != nullptr)
+		pWorkers->ParallelFor(nrOfWaitingMembers, updateMembers);
+	else
+		updateMembers(0, nrOfWaitingMembers, 0);
+}
+
+GroupedDecisionMaking::GroupedDecisionMaking(IDecisionMaking* pDecisionMaking, DecisionMakingGroup* pGroup)
+	: m_pDecisionMaking(pDecisionMaking), m_pGroup(pGroup)
+{
+	if(m_pGroup != nullptr)
+		m_pGroup->AddMember(this);
+}
+
+GroupedDecisionMaking::~GroupedDecisionMaking()
+{
+	if(m_pGroup != nullptr)
+		m_pGroup->RemoveMember(this);
+	SAFE_DELETE(m_pDecisionMaking);
+}
+
+void GroupedDecisionMaking::Update(float deltaT)
+{
+	if(m_pDecisionMaking == nullptr)
+		return;
+
+	if(m_pGroup == nullptr)
+	{
+		m_pDecisionMaking->Update(deltaT);
+		return;
+	}
+
+	m_PendingTime += deltaT;
+	m_IsWaiting = true;
+}
@@ -0,0 +1,129 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// EParallelDecisionMaking.h: runs the decision making of many agents on all cores.
+// While decisions run in parallel the world is only read. Every change to it (steering, debug drawing, ...) goes through
+// DecisionCommandBuffer::Submit and is applied on the main thread once all decisions are done. Writing to the agent's own
+// blackboard is fine, nothing else uses it at the same time. Use keys made up front, the string overloads register new keys.
+/*=============================================================================*/
+#ifndef ELITE_PARALLEL_DECISION_MAKING
+#define ELITE_PARALLEL_DECISION_MAKING
+
+namespace Elite
+{
+	//-----------------------------------------------------------------
+	// COMMAND BUFFER
+	//-----------------------------------------------------------------
+	class DecisionCommandBuffer final
+	{
+	public:
+		void Add(std::function<void()> command) { m_Commands.push_back(std::move(command)); }
+		void Execute();  //In the order they were added, the buffer is empty after
+		size_t GetNrOfCommands() const { return m_Commands.size(); }
+
+		//For every change decision making makes outside its own blackboard. Runs the command right away, unless this
+		//thread is running decisions in parallel, then the command waits in the buffer of the thread until the sync point
+		static void Submit(std::function<void()> command);
+
+	private:
+		friend class DecisionWorkers;
+		static thread_local DecisionCommandBuffer* s_pCurrentBuffer;
+
+		std::vector<std::function<void()>> m_Commands = {};
+	};
+
+	//-----------------------------------------------------------------
+	// WORKERS
+	//-----------------------------------------------------------------
+	//Threads that wait for jobs, the calling thread helps with every job
+	class DecisionWorkers final
+	{
+	public:
+		using Job = std::function<void(int firstItem, int endItem, int chunkIndex)>;
+
+		//nrOfThreads 0 = one thread per core, including the calling thread. A chunk gets at least minItemsPerChunk items,
+		//fewer items than that run on the calling thread only, waking the workers would cost more than the items
+		explicit DecisionWorkers(int nrOfThreads = 0, int minItemsPerChunk = 32);
+		~DecisionWorkers();
+
+		DecisionWorkers(const DecisionWorkers&) = delete;
+		DecisionWorkers& operator=(const DecisionWorkers&) = delete;
+
+		int GetNrOfThreads() const { return static_cast<int>(m_Threads.size()) + 1; }
+		int GetMinItemsPerChunk() const { return m_MinItemsPerChunk; }
+
+		//Splits the items in one chunk per thread and returns when all chunks are done. The commands of every chunk
+		//are then applied in chunk order, so the result doesn't depend on the number of threads
+		void ParallelFor(int nrOfItems, const Job& job);
+
+	private:
+		void WorkerLoop(int chunkIndex);
+		void RunChunk(int chunkIndex);
+
+		std::vector<std::thread> m_Threads = {};
+		std::vector<DecisionCommandBuffer> m_CommandBuffers = {};  //One per chunk
+		int m_MinItemsPerChunk = 1;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_StartCondition;
+		std::condition_variable m_DoneCondition;
+		const Job* m_pJob = nullptr;
+		int m_NrOfItems = 0;
+		int m_NrOfChunks = 0;
+		int m_NrOfBusyWorkers = 0;
+		unsigned int m_JobIndex = 0;  //Tells the workers a new job started
+		bool m_IsStopping = false;
+	};
+
+	//-----------------------------------------------------------------
+	// DECISION MAKING GROUP
+	//-----------------------------------------------------------------
+	//Decision making structures that are updated together, in parallel when the group gets workers.
+	//Update of a GroupedDecisionMaking only marks it, Update of the group then runs the marked ones. The group has to
+	//outlive its members, a member leaves the group when it is deleted
+	class GroupedDecisionMaking;
+	class DecisionMakingGroup final
+	{
+	public:
+		DecisionMakingGroup() = default;
+		~DecisionMakingGroup();  //The members left update themselves again
+
+		DecisionMakingGroup(const DecisionMakingGroup&) = delete;
+		DecisionMakingGroup& operator=(const DecisionMakingGroup&) = delete;
+
+		void AddMember(GroupedDecisionMaking* pMember);
+		void RemoveMember(GroupedDecisionMaking* pMember);
+		size_t GetNrOfMembers() const { return m_pMembers.size(); }
+
+		void Update(DecisionWorkers* pWorkers = nullptr);
+
+	private:
+		std::vector<GroupedDecisionMaking*> m_pMembers = {};
+		std::vector<GroupedDecisionMaking*> m_pWaitingMembers = {};
+	};
+
+	//Takes ownership of the decision making
+	class GroupedDecisionMaking final : public IDecisionMaking
+	{
+	public:
+		GroupedDecisionMaking(IDecisionMaking* pDecisionMaking, DecisionMakingGroup* pGroup);
+		~GroupedDecisionMaking();
+
+		GroupedDecisionMaking(const GroupedDecisionMaking&) = delete;
+		GroupedDecisionMaking& operator=(const GroupedDecisionMaking&) = delete;
+
+		virtual void Update(float deltaT) override;
+
+		IDecisionMaking* GetDecisionMaking() const { return m_pDecisionMaking; }
+
+	private:
+		friend class DecisionMakingGroup;
+
+		IDecisionMaking* m_pDecisionMaking = nullptr;
+		DecisionMakingGroup* m_pGroup = nullptr;
+		float m_PendingTime = 0.f;
+		bool m_IsWaiting = false;
+	};
+}
+#endif
@@ -3,120 +3,597 @@
 #include "EBehaviorTree.h"
 using namespace Elite;
 
+//-----------------------------------------------------------------
+// BEHAVIOR INTERFACES (BASE)
+//-----------------------------------------------------------------
+void IBehavior::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	CompiledBehavior node{};
+	node.type = CompiledBehavior::Type::Behavior;
+	node.nodeIndex = m_NodeIndex;
+	node.pBehavior = this;
+	nodes.push_back(node);
+	nodes.back().endIndex = static_cast<int>(nodes.size());
+}
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE COMPOSITES (IBehavior)
 //-----------------------------------------------------------------
 #pragma region COMPOSITES
+void BehaviorComposite::CompileComposite(std::vector<CompiledBehavior>& nodes, CompiledBehavior::Type type, int runningIndexSlot) const
+{
+	const size_t compositeIndex = nodes.size();
+
+	CompiledBehavior node{};
+	node.type = type;
+	node.nodeIndex = m_NodeIndex;
+	node.nrOfChildren = static_cast<int>(m_ChildBehaviors.size());
+	node.runningIndexSlot = runningIndexSlot;
+	node.pBehavior = this;
+	nodes.push_back(node);
+
+	for(auto pb : m_ChildBehaviors)
+		pb->Compile(nodes);
+	nodes[compositeIndex].endIndex = static_cast<int>(nodes.size());
+}
+
 //SELECTOR
-BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
 {
 	//TODO: Fill in this code
 	// Loop over all children in m_ChildBehaviors
 	for(auto& child : m_ChildBehaviors)
 	{
-		//Every Child: Execute and store the result in m_CurrentState
+		//Every Child: Execute and store the result in currentState
 		//Check the currentstate and apply the selector Logic:
-		m_CurrentState = child->Execute(pBlackBoard);
+		const BehaviorState currentState = child->Execute(pBlackBoard, state);
 
 		//you can use and if but we use switch case for less lines of code and cleaner
 
-		switch(m_CurrentState) {
+		switch(currentState) {
 			default:
 			case BehaviorState::Failure:
 				continue;
 			case BehaviorState::Success:
 			case BehaviorState::Running:
-				return m_CurrentState;
+				return StoreState(state, currentState);
 		}
 
 		//The selector fails if all children failed.
 	}
 
 	//All children failed
-	m_CurrentState = BehaviorState::Failure;
-	return m_CurrentState;
+	return StoreState(state, BehaviorState::Failure);
+}
+void BehaviorSelector::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	CompileComposite(nodes, CompiledBehavior::Type::Selector, -1);
 }
 //SEQUENCE
-BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
 {
 	//Loop over all children in m_ChildBehaviors
 	for(auto& child : m_ChildBehaviors)
 	{
-		//Every Child: Execute and store the result in m_CurrentState
-		m_CurrentState = child->Execute(pBlackBoard);
+		//Every Child: Execute and store the result in currentState
+		const BehaviorState currentState = child->Execute(pBlackBoard, state);
 		//Check the currentstate and apply the sequence Logic:
 		//if a child returns Failed:
 			//stop looping over all children and return Failed
 		//if a child returns Running:
 			//Running: stop looping and return Running
-		switch(m_CurrentState) {
+		switch(currentState) {
 			default:
 			case BehaviorState::Success:
 				continue;
 			case BehaviorState::Failure:
-				return m_CurrentState;
+				return StoreState(state, currentState);
 			case BehaviorState::Running:
-				return m_CurrentState;
+				return StoreState(state, currentState);
 		}
 		//The selector succeeds if all children succeeded.
 	}
 	//All children succeeded 
-	m_CurrentState = BehaviorState::Success;
-	return m_CurrentState;
+	return StoreState(state, BehaviorState::Success);
+}
+void BehaviorSequence::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	CompileComposite(nodes, CompiledBehavior::Type::Sequence, -1);
 }
 //PARTIAL SEQUENCE
-BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
 {
-	while(m_CurrentBehaviorIndex < m_ChildBehaviors.size())
+	unsigned int currentBehaviorIndex = state.GetRunningIndex(m_RunningIndexSlot);
+	while(currentBehaviorIndex < m_ChildBehaviors.size())
 	{
-		m_CurrentState = m_ChildBehaviors[m_CurrentBehaviorIndex]->Execute(pBlackBoard);
-		switch(m_CurrentState)
+		const BehaviorState currentState = m_ChildBehaviors[currentBehaviorIndex]->Execute(pBlackBoard, state);
+		switch(currentState)
 		{
 			case BehaviorState::Failure:
-				m_CurrentBehaviorIndex = 0;
-				return m_CurrentState;
+				state.SetRunningIndex(m_RunningIndexSlot, 0);
+				return StoreState(state, currentState);
 			case BehaviorState::Success:
-				++m_CurrentBehaviorIndex;
-				m_CurrentState = BehaviorState::Running;
-				return m_CurrentState;
+				state.SetRunningIndex(m_RunningIndexSlot, currentBehaviorIndex + 1);
+				return StoreState(state, BehaviorState::Running);
 			case BehaviorState::Running:
-				return m_CurrentState;
+				return StoreState(state, currentState);
 		}
 	}
 
-	m_CurrentBehaviorIndex = 0;
-	m_CurrentState = BehaviorState::Success;
-	return m_CurrentState;
+	state.SetRunningIndex(m_RunningIndexSlot, 0);
+	return StoreState(state, BehaviorState::Success);
+}
+void BehaviorPartialSequence::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	CompileComposite(nodes, CompiledBehavior::Type::PartialSequence, m_RunningIndexSlot);
 }
 #pragma endregion
 //-----------------------------------------------------------------
 // BEHAVIOR TREE CONDITIONAL (IBehavior)
 //-----------------------------------------------------------------
-BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
 {
 	if(m_fpConditional == nullptr)
 		return BehaviorState::Failure;
 
+	if(state.IsObserving())
+		state.Observe(m_ObservedKeys);
+
 	switch(m_fpConditional(pBlackBoard))
 	{
 		case true:
-			m_CurrentState = BehaviorState::Success;
-			return m_CurrentState;
+			return StoreState(state, BehaviorState::Success);
 		case false:
-			m_CurrentState = m_CurrentState = BehaviorState::Failure;
-			return m_CurrentState;
+			return StoreState(state, BehaviorState::Failure);
 	}
 
-	return m_CurrentState;
+	return state.GetNodeState(m_NodeIndex);
+}
+void BehaviorConditional::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	//Only a plain function can be called without the std::function, lambdas and bound functions run through Execute
+	IBehavior::Compile(nodes);
+	bool(* const* pfpConditional)(Blackboard*) = m_fpConditional.target<bool(*)(Blackboard*)>();
+	if(pfpConditional != nullptr && *pfpConditional != nullptr)
+	{
+		nodes.back().type = CompiledBehavior::Type::Conditional;
+		nodes.back().fpConditional = *pfpConditional;
+		if(!m_ObservedKeys.empty())
+			nodes.back().pObservedKeys = &m_ObservedKeys;
+	}
 }
 //-----------------------------------------------------------------
 // BEHAVIOR TREE ACTION (IBehavior)
 //-----------------------------------------------------------------
-BehaviorState BehaviorAction::Execute(Blackboard* pBlackBoard)
+BehaviorState BehaviorAction::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
 {
 	if(m_fpAction == nullptr)
 		return BehaviorState::Failure;
 
-	m_CurrentState = m_fpAction(pBlackBoard);
-	return m_CurrentState;
-}
\ No newline at end of file
+	BehaviorState result{};
+	if(!state.TakeFinishedResult(this, result))
+		result = m_fpAction(pBlackBoard);
+	if(result == BehaviorState::Running)
+		state.SetRunningAction(this);
+	return StoreState(state, result);
+}
+void BehaviorAction::Compile(std::vector<CompiledBehavior>& nodes) const
+{
+	IBehavior::Compile(nodes);
+	BehaviorState(* const* pfpAction)(Blackboard*) = m_fpAction.target<BehaviorState(*)(Blackboard*)>();
+	if(pfpAction != nullptr && *pfpAction != nullptr)
+	{
+		nodes.back().type = CompiledBehavior::Type::Action;
+		nodes.back().fpAction = *pfpAction;
+	}
+}
+//-----------------------------------------------------------------
+// BEHAVIOR TREE DEFINITION
+//-----------------------------------------------------------------
+BehaviorTreeDefinition::BehaviorTreeDefinition(IBehavior* pRootBehavior)
+	: m_pRootBehavior(pRootBehavior)
+{
+	if(m_pRootBehavior == nullptr)
+		return;
+
+	m_pRootBehavior->AssignSlots(m_NrOfNodes, m_NrOfRunningIndices);
+	m_pRootBehavior->Compile(m_CompiledBehaviors);
+
+	//The interpreter keeps the open composites in a fixed array, so the nesting is limited
+	std::vector<int> openEndIndices{};
+	size_t maxDepth = 0;
+	for(int index = 0; index < static_cast<int>(m_CompiledBehaviors.size()); ++index)
+	{
+		while(!openEndIndices.empty() && openEndIndices.back() <= index)
+			openEndIndices.pop_back();
+
+		const CompiledBehavior& node = m_CompiledBehaviors[index];
+		if(node.endIndex > index + 1)
+			openEndIndices.push_back(node.endIndex);
+		maxDepth = std::max(maxDepth, openEndIndices.size());
+	}
+
+	if(maxDepth > MaxCompiledDepth)
+		m_CompiledBehaviors.clear();
+	else
+		m_MaxDepth = static_cast<int>(maxDepth);
+}
+
+namespace
+{
+	//The leaves, shared by the single and the batched interpreter
+	inline BehaviorState RunConditional(const CompiledBehavior& node, Blackboard* pBlackBoard, BehaviorTreeState& state)
+	{
+		if(node.pObservedKeys != nullptr && state.IsObserving())
+			state.Observe(*node.pObservedKeys);
+		const BehaviorState result = node.fpConditional(pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+		state.SetNodeState(node.nodeIndex, result);
+		return result;
+	}
+
+	inline BehaviorState RunAction(const CompiledBehavior& node, Blackboard* pBlackBoard, BehaviorTreeState& state)
+	{
+		BehaviorState result{};
+		if(!state.TakeFinishedResult(node.pBehavior, result))
+			result = node.fpAction(pBlackBoard);
+		if(result == BehaviorState::Running)
+			state.SetRunningAction(node.pBehavior);
+		state.SetNodeState(node.nodeIndex, result);
+		return result;
+	}
+
+	inline BehaviorState RunLeaf(const CompiledBehavior& node, Blackboard* pBlackBoard, BehaviorTreeState& state)
+	{
+		switch(node.type)
+		{
+			case CompiledBehavior::Type::Conditional:
+				return RunConditional(node, pBlackBoard, state);
+			case CompiledBehavior::Type::Action:
+				return RunAction(node, pBlackBoard, state);
+			default:
+				return node.pBehavior->Execute(pBlackBoard, state);
+		}
+	}
+
+	inline bool IsComposite(CompiledBehavior::Type type)
+	{
+		return type == CompiledBehavior::Type::Selector || type == CompiledBehavior::Type::Sequence
+			|| type == CompiledBehavior::Type::PartialSequence;
+	}
+}
+
+bool BehaviorTreeDefinition::EnterComposite(int& index, Frame* pFrames, int& nrOfFrames, BehaviorTreeState& state, BehaviorState& result) const
+{
+	const CompiledBehavior* pNodes = m_CompiledBehaviors.data();
+	const CompiledBehavior& node = pNodes[index];
+	if(node.type == CompiledBehavior::Type::PartialSequence)
+	{
+		const unsigned int runningIndex = state.GetRunningIndex(node.runningIndexSlot);
+		if(runningIndex >= static_cast<unsigned int>(node.nrOfChildren))
+		{
+			state.SetRunningIndex(node.runningIndexSlot, 0);
+			result = BehaviorState::Success;
+			state.SetNodeState(node.nodeIndex, result);
+			return false;
+		}
+
+		int childIndex = index + 1;
+		for(unsigned int skipped = 0; skipped < runningIndex; ++skipped)
+			childIndex = pNodes[childIndex].endIndex;
+		pFrames[nrOfFrames++] = Frame{ index, childIndex };
+		index = childIndex;
+		return true;
+	}
+
+	if(node.nrOfChildren == 0)
+	{
+		result = node.type == CompiledBehavior::Type::Selector ? BehaviorState::Failure : BehaviorState::Success;
+		state.SetNodeState(node.nodeIndex, result);
+		return false;
+	}
+	pFrames[nrOfFrames++] = Frame{ index, index + 1 };
+	++index;
+	return true;
+}
+
+bool BehaviorTreeDefinition::LeaveNode(int& index, Frame* pFrames, int& nrOfFrames, BehaviorTreeState& state, BehaviorState& result) const
+{
+	const CompiledBehavior* pNodes = m_CompiledBehaviors.data();
+	while(nrOfFrames > 0)
+	{
+		Frame& frame = pFrames[nrOfFrames - 1];
+		const CompiledBehavior& composite = pNodes[frame.compositeIndex];
+		if(composite.type == CompiledBehavior::Type::PartialSequence)
+		{
+			if(result == BehaviorState::Failure)
+			{
+				state.SetRunningIndex(composite.runningIndexSlot, 0);
+			}
+			else if(result == BehaviorState::Success)
+			{
+				state.SetRunningIndex(composite.runningIndexSlot, state.GetRunningIndex(composite.runningIndexSlot) + 1);
+				result = BehaviorState::Running;
+			}
+		}
+		else
+		{
+			//A selector tries the next child on failure, a sequence on success
+			const BehaviorState nextChildState = composite.type == CompiledBehavior::Type::Selector ? BehaviorState::Failure : BehaviorState::Success;
+			const int nextChildIndex = pNodes[frame.childIndex].endIndex;
+			if(result == nextChildState && nextChildIndex < composite.endIndex)
+			{
+				frame.childIndex = nextChildIndex;
+				index = nextChildIndex;
+				return true;
+			}
+		}
+
+		state.SetNodeState(composite.nodeIndex, result);
+		--nrOfFrames;
+	}
+	return false;
+}
+
+BehaviorState BehaviorTreeDefinition::Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const
+{
+	if(m_CompiledBehaviors.empty())
+		return m_pRootBehavior != nullptr ? m_pRootBehavior->Execute(pBlackBoard, state) : BehaviorState::Failure;
+
+	//The open composites and the child they are running, makes the same decisions as the Execute functions without recursion
+	Frame frames[MaxCompiledDepth];
+	int nrOfFrames = 0;
+
+	const CompiledBehavior* pNodes = m_CompiledBehaviors.data();
+	int index = 0;
+	BehaviorState result = BehaviorState::Failure;
+	while(true)
+	{
+		//Going down: composites open at their first (or running) child, leaves give a result
+		const CompiledBehavior& node = pNodes[index];
+		if(IsComposite(node.type))
+		{
+			if(EnterComposite(index, frames, nrOfFrames, state, result))
+				continue;
+		}
+		else
+		{
+			result = RunLeaf(node, pBlackBoard, state);
+		}
+
+		//Going up: hand the result to the open composites until one of them runs its next child
+		if(!LeaveNode(index, frames, nrOfFrames, state, result))
+			return result;
+	}
+}
+
+void BehaviorTreeDefinition::ExecuteBatch(Blackboard* const* pBlackBoards, BehaviorTreeState* const* pStates, BehaviorState* pResults,
+	int nrOfAgents, BatchMemory& memory) const
+{
+	if(m_CompiledBehaviors.empty())
+	{
+		for(int agentIndex = 0; agentIndex < nrOfAgents; ++agentIndex)
+			pResults[agentIndex] = Execute(pBlackBoards[agentIndex], *pStates[agentIndex]);
+		return;
+	}
+
+	//Every agent only moves forward through the array (down to a child or on to a next sibling), so running the nodes
+	//in order, each for all agents waiting at it, gives every agent the same path as Execute
+	const int nrOfNodes = static_cast<int>(m_CompiledBehaviors.size());
+	memory.frames.resize(static_cast<size_t>(nrOfAgents) * m_MaxDepth);
+	memory.nrOfFrames.assign(nrOfAgents, 0);
+	memory.firstAgents.assign(nrOfNodes, -1);
+	memory.lastAgents.assign(nrOfNodes, -1);
+	memory.nextAgents.assign(nrOfAgents, -1);
+
+	//The agents waiting at a node are a list, in agent order
+	const auto moveTo = [&memory](int nodeIndex, int agentIndex)
+	{
+		memory.nextAgents[agentIndex] = -1;
+		if(memory.lastAgents[nodeIndex] < 0)
+			memory.firstAgents[nodeIndex] = agentIndex;
+		else
+			memory.nextAgents[memory.lastAgents[nodeIndex]] = agentIndex;
+		memory.lastAgents[nodeIndex] = agentIndex;
+	};
+	const auto leave = [this, &memory, &moveTo, pStates, pResults](int nodeIndex, int agentIndex)
+	{
+		if(LeaveNode(nodeIndex, memory.frames.data() + static_cast<size_t>(agentIndex) * m_MaxDepth, memory.nrOfFrames[agentIndex],
+			*pStates[agentIndex], pResults[agentIndex]))
+			moveTo(nodeIndex, agentIndex);
+	};
+
+	for(int agentIndex = 0; agentIndex < nrOfAgents; ++agentIndex)
+		moveTo(0, agentIndex);
+
+	const CompiledBehavior* pNodes = m_CompiledBehaviors.data();
+	for(int index = 0; index < nrOfNodes; ++index)
+	{
+		const int firstAgent = memory.firstAgents[index];
+		if(firstAgent < 0)
+			continue;
+
+		//The next agent is read before moving one on, moving reuses its link
+		const CompiledBehavior& node = pNodes[index];
+		switch(node.type)
+		{
+			case CompiledBehavior::Type::Conditional:
+				for(int agentIndex = firstAgent; agentIndex >= 0; agentIndex = memory.nextAgents[agentIndex])
+					pResults[agentIndex] = RunConditional(node, pBlackBoards[agentIndex], *pStates[agentIndex]);
+				break;
+			case CompiledBehavior::Type::Action:
+				for(int agentIndex = firstAgent; agentIndex >= 0; agentIndex = memory.nextAgents[agentIndex])
+					pResults[agentIndex] = RunAction(node, pBlackBoards[agentIndex], *pStates[agentIndex]);
+				break;
+			case CompiledBehavior::Type::Behavior:
+				for(int agentIndex = firstAgent; agentIndex >= 0; agentIndex = memory.nextAgents[agentIndex])
+					pResults[agentIndex] = node.pBehavior->Execute(pBlackBoards[agentIndex], *pStates[agentIndex]);
+				break;
+			default:
+				for(int agentIndex = firstAgent; agentIndex >= 0;)
+				{
+					const int nextAgent = memory.nextAgents[agentIndex];
+					int nodeIndex = index;
+					if(EnterComposite(nodeIndex, memory.frames.data() + static_cast<size_t>(agentIndex) * m_MaxDepth,
+						memory.nrOfFrames[agentIndex], *pStates[agentIndex], pResults[agentIndex]))
+						moveTo(nodeIndex, agentIndex);
+					else
+						leave(index, agentIndex);
+					agentIndex = nextAgent;
+				}
+				continue;
+		}
+
+		for(int agentIndex = firstAgent; agentIndex >= 0;)
+		{
+			const int nextAgent = memory.nextAgents[agentIndex];
+			leave(index, agentIndex);
+			agentIndex = nextAgent;
+		}
+	}
+}
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE (BASE)
+//-----------------------------------------------------------------
+BehaviorTree::~BehaviorTree()
+{
+	if(m_pBatch != nullptr)
+		m_pBatch->RemoveTree(this);
+	SAFE_DELETE(m_pOwnedDefinition);
+	SAFE_DELETE(m_pBlackBoard); //Takes ownership of passed blackboard!
+}
+
+bool BehaviorTree::BeginUpdate(float deltaTime)
+{
+	if(!m_IsEventDriven)
+		return true;
+
+	m_TimeSinceEvaluation += deltaTime;
+	const bool isRefreshDue = m_RefreshInterval > 0.f && m_TimeSinceEvaluation >= m_RefreshInterval;
+	if(!m_NeedsEvaluation && !isRefreshDue && !HasObservedChanges())
+	{
+		//Nothing the last decision depended on changed, it still holds
+		const IBehavior* pRunningAction = m_State.GetRunningAction();
+		if(pRunningAction == nullptr)
+			return false;
+
+		const BehaviorState result = pRunningAction->Execute(m_pBlackBoard, m_State);
+		if(result == BehaviorState::Running)
+			return false;
+
+		//The parents decide what comes after the action, the evaluation uses this result instead of running it again
+		m_State.SetFinishedAction(pRunningAction, result);
+	}
+
+	m_State.BeginEvaluation(true);
+	return true;
+}
+
+void BehaviorTree::EndUpdate(BehaviorState result)
+{
+	m_CurrentState = result;
+	if(!m_IsEventDriven)
+		return;
+
+	m_State.EndEvaluation();
+
+	//The changes the conditionals and actions made themselves are part of this decision
+	m_EvaluatedVersion = m_pBlackBoard->GetVersion();
+	m_TimeSinceEvaluation = 0.f;
+	m_NeedsEvaluation = false;
+}
+
+bool BehaviorTree::HasObservedChanges() const
+{
+	if(m_pBlackBoard->GetVersion() == m_EvaluatedVersion)
+		return false;
+
+	for(const BlackboardKeyBase& key : m_State.GetObservedKeys())
+	{
+		if(m_pBlackBoard->HasChangedSince(key, m_EvaluatedVersion))
+			return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE BATCH
+//-----------------------------------------------------------------
+BehaviorTreeBatch::~BehaviorTreeBatch()
+{
+	for(BehaviorTree* pTree : m_pTrees)
+		pTree->m_pBatch = nullptr;
+	m_pTrees.clear();
+}
+
+bool BehaviorTreeBatch::AddTree(BehaviorTree* pTree)
+{
+	if(pTree == nullptr || pTree->m_pDefinition != m_pDefinition || pTree->m_pBatch != nullptr)
+		return false;
+
+	pTree->m_pBatch = this;
+	m_pTrees.push_back(pTree);
+	return true;
+}
+
+void BehaviorTreeBatch::RemoveTree(BehaviorTree* pTree)
+{
+	const auto it = std::find(m_pTrees.begin(), m_pTrees.end(), pTree);
+	if(it == m_pTrees.end())
+		return;
+
+	pTree->m_pBatch = nullptr;
+	m_pTrees.erase(it);
+}
+
+void BehaviorTreeBatch::Update(DecisionWorkers* pWorkers)
+{
+	ELITE_PROFILE_SCOPE("BehaviorTreeBatch::Update");
+
+	m_pWaitingTrees.clear();
+	for(BehaviorTree* pTree : m_pTrees)
+	{
+		if(pTree->m_IsWaitingForBatch)
+			m_pWaitingTrees.push_back(pTree);
+	}
+
+	const int nrOfChunks = pWorkers != nullptr ? pWorkers->GetNrOfThreads() : 1;
+	if(static_cast<int>(m_Chunks.size()) < nrOfChunks)
+		m_Chunks.resize(nrOfChunks);
+
+	const int nrOfWaitingTrees = static_cast<int>(m_pWaitingTrees.size());
+	if(pWorkers != nullptr)
+	{
+		pWorkers->ParallelFor(nrOfWaitingTrees,
+			[this](int firstTree, int endTree, int chunkIndex) { UpdateChunk(firstTree, endTree, m_Chunks[chunkIndex]); });
+	}
+	else
+		UpdateChunk(0, nrOfWaitingTrees, m_Chunks[0]);
+}
+
+void BehaviorTreeBatch::UpdateChunk(int firstTree, int endTree, Chunk& chunk)
+{
+	//Event driven trees that don't need an evaluation are done after BeginUpdate
+	chunk.pEvaluatedTrees.clear();
+	chunk.pBlackBoards.clear();
+	chunk.pStates.clear();
+	for(int treeIndex = firstTree; treeIndex < endTree; ++treeIndex)
+	{
+		BehaviorTree* pTree = m_pWaitingTrees[treeIndex];
+		const float deltaTime = pTree->m_BatchTime;
+		pTree->m_BatchTime = 0.f;
+		pTree->m_IsWaitingForBatch = false;
+		if(!pTree->BeginUpdate(deltaTime))
+			continue;
+		chunk.pEvaluatedTrees.push_back(pTree);
+		chunk.pBlackBoards.push_back(pTree->m_pBlackBoard);
+		chunk.pStates.push_back(&pTree->m_State);
+	}
+
+	const int nrOfTrees = static_cast<int>(chunk.pEvaluatedTrees.size());
+	chunk.results.resize(nrOfTrees);
+	m_pDefinition->ExecuteBatch(chunk.pBlackBoards.data(), chunk.pStates.data(), chunk.results.data(), nrOfTrees, chunk.memory);
+
+	for(int treeIndex = 0; treeIndex < nrOfTrees; ++treeIndex)
+		chunk.pEvaluatedTrees[treeIndex]->EndUpdate(chunk.results[treeIndex]);
+}
@@ -22,6 +22,102 @@ namespace Elite
 		Running
 	};
 
+	//Runtime data of one agent in a tree, the nodes themselves are shared and never change while executing.
+	//Every node has a slot for its last result, nodes that continue where they left off (partial sequence) also get a running index
+	class IBehavior;
+	class BehaviorTreeState final
+	{
+	public:
+		BehaviorTreeState() = default;
+		BehaviorTreeState(int nrOfNodes, int nrOfRunningIndices)
+			: m_NodeStates(nrOfNodes, BehaviorState::Failure), m_RunningIndices(nrOfRunningIndices, 0) {}
+
+		BehaviorState GetNodeState(int nodeIndex) const { return m_NodeStates[nodeIndex]; }
+		void SetNodeState(int nodeIndex, BehaviorState state) { m_NodeStates[nodeIndex] = state; }
+
+		unsigned int GetRunningIndex(int slot) const { return m_RunningIndices[slot]; }
+		void SetRunningIndex(int slot, unsigned int index) { m_RunningIndices[slot] = index; }
+
+		//--- Event driven updates (see BehaviorTree::SetEventDriven) ---
+		//While observing, the conditionals that get evaluated add the blackboard keys they depend on
+		void BeginEvaluation(bool isObserving)
+		{
+			m_IsObserving = isObserving;
+			m_ObservedKeys.clear();
+			m_pRunningAction = nullptr;
+		}
+		void EndEvaluation()
+		{
+			m_IsObserving = false;
+			m_pFinishedAction = nullptr;
+		}
+		bool IsObserving() const { return m_IsObserving; }
+		void Observe(const std::vector<BlackboardKeyBase>& keys)
+		{
+			for(const BlackboardKeyBase& key : keys)
+			{
+				const auto isSameKey = [&key](const BlackboardKeyBase& observedKey) { return observedKey.GetIndex() == key.GetIndex(); };
+				if(std::find_if(m_ObservedKeys.begin(), m_ObservedKeys.end(), isSameKey) == m_ObservedKeys.end())
+					m_ObservedKeys.push_back(key);
+			}
+		}
+		const std::vector<BlackboardKeyBase>& GetObservedKeys() const { return m_ObservedKeys; }
+
+		//The action that returned Running last, it can be continued without going through the tree again
+		const IBehavior* GetRunningAction() const { return m_pRunningAction; }
+		void SetRunningAction(const IBehavior* pAction) { m_pRunningAction = pAction; }
+
+		//An action that finished outside the tree hands its result to the next evaluation instead of running again
+		void SetFinishedAction(const IBehavior* pAction, BehaviorState result)
+		{
+			m_pFinishedAction = pAction;
+			m_FinishedResult = result;
+		}
+		bool TakeFinishedResult(const IBehavior* pAction, BehaviorState& result)
+		{
+			if(m_pFinishedAction != pAction)
+				return false;
+			result = m_FinishedResult;
+			m_pFinishedAction = nullptr;
+			return true;
+		}
+
+	private:
+		std::vector<BehaviorState> m_NodeStates = {};
+		std::vector<unsigned int> m_RunningIndices = {};
+
+		std::vector<BlackboardKeyBase> m_ObservedKeys = {};
+		const IBehavior* m_pRunningAction = nullptr;
+		const IBehavior* m_pFinishedAction = nullptr;
+		BehaviorState m_FinishedResult = BehaviorState::Failure;
+		bool m_IsObserving = false;
+	};
+
+	//One node of a tree compiled by the definition: the nodes are stored depth first, so the children of a composite
+	//follow it and the subtree of every node ends at endIndex, which is also where its next sibling starts
+	struct CompiledBehavior
+	{
+		enum class Type
+		{
+			Selector,
+			Sequence,
+			PartialSequence,
+			Conditional,  //Plain function, called directly
+			Action,  //Plain function, called directly
+			Behavior  //Anything else, runs through IBehavior::Execute
+		};
+
+		Type type = Type::Behavior;
+		int nodeIndex = -1;  //Slot in the BehaviorTreeState
+		int endIndex = 0;
+		int nrOfChildren = 0;
+		int runningIndexSlot = -1;
+		bool(*fpConditional)(Blackboard*) = nullptr;
+		BehaviorState(*fpAction)(Blackboard*) = nullptr;
+		const IBehavior* pBehavior = nullptr;
+		const std::vector<BlackboardKeyBase>* pObservedKeys = nullptr;  //Conditionals only, nullptr when they observe nothing
+	};
+
 	//-----------------------------------------------------------------
 	// BEHAVIOR INTERFACES (BASE)
 	//-----------------------------------------------------------------
@@ -30,10 +126,23 @@ namespace Elite
 	public:
 		IBehavior() = default;
 		virtual ~IBehavior() = default;
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) = 0;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const = 0;
+
+		//Gives this node (and its children) their slots in the BehaviorTreeState, done once by the definition
+		virtual void AssignSlots(int& nrOfNodes, int& nrOfRunningIndices) { m_NodeIndex = nrOfNodes++; }
+		int GetNodeIndex() const { return m_NodeIndex; }
+
+		//Appends this node (and its children) to the flat tree, custom behaviors keep running through Execute
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const;
 
 	protected:
-		BehaviorState m_CurrentState = BehaviorState::Failure;
+		BehaviorState StoreState(BehaviorTreeState& state, BehaviorState result) const
+		{
+			state.SetNodeState(m_NodeIndex, result);
+			return result;
+		}
+
+		int m_NodeIndex = -1;
 	};
 
 	//-----------------------------------------------------------------
@@ -53,9 +162,17 @@ namespace Elite
 			m_ChildBehaviors.clear();
 		}
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override = 0;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override = 0;
+		virtual void AssignSlots(int& nrOfNodes, int& nrOfRunningIndices) override
+		{
+			IBehavior::AssignSlots(nrOfNodes, nrOfRunningIndices);
+			for (auto pb : m_ChildBehaviors)
+				pb->AssignSlots(nrOfNodes, nrOfRunningIndices);
+		}
 
 	protected:
+		void CompileComposite(std::vector<CompiledBehavior>& nodes, CompiledBehavior::Type type, int runningIndexSlot) const;
+
 		std::vector<IBehavior*> m_ChildBehaviors = {};
 	};
 
@@ -67,7 +184,8 @@ namespace Elite
 			BehaviorComposite(childBehaviors) {}
 		virtual ~BehaviorSelector() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override;
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const override;
 	};
 
 	//--- SEQUENCE ---
@@ -78,7 +196,8 @@ namespace Elite
 			BehaviorComposite(childBehaviors) {}
 		virtual ~BehaviorSequence() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override;
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const override;
 	};
 
 	//--- PARTIAL SEQUENCE ---
@@ -89,24 +208,37 @@ namespace Elite
 			: BehaviorSequence(childBehaviors) {}
 		virtual ~BehaviorPartialSequence() = default;
 
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override;
+		virtual void AssignSlots(int& nrOfNodes, int& nrOfRunningIndices) override
+		{
+			BehaviorSequence::AssignSlots(nrOfNodes, nrOfRunningIndices);
+			m_RunningIndexSlot = nrOfRunningIndices++;
+		}
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const override;
 
 	private:
-		unsigned int m_CurrentBehaviorIndex = 0;
+		int m_RunningIndexSlot = -1;  //The child to continue with lives in the agent's state
 	};
 #pragma endregion
 
 	//-----------------------------------------------------------------
 	// BEHAVIOR TREE CONDITIONAL (IBehavior)
 	//-----------------------------------------------------------------
+	//The observed keys are the blackboard entries the result depends on, an event driven tree only evaluates
+	//the conditional again when one of them changes (or when its refresh interval passed)
 	class BehaviorConditional : public IBehavior
 	{
 	public:
-		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		explicit BehaviorConditional(std::function<bool(Blackboard*)> fp, std::vector<BlackboardKeyBase> observedKeys = {})
+			: m_fpConditional(fp), m_ObservedKeys(observedKeys) {}
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override;
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const override;
+
+		const std::vector<BlackboardKeyBase>& GetObservedKeys() const { return m_ObservedKeys; }
 
 	private:
 		std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+		std::vector<BlackboardKeyBase> m_ObservedKeys = {};
 	};
 
 	//-----------------------------------------------------------------
@@ -116,43 +248,198 @@ namespace Elite
 	{
 	public:
 		explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp) : m_fpAction(fp) {}
-		virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+		virtual BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const override;
+		virtual void Compile(std::vector<CompiledBehavior>& nodes) const override;
 
 	private:
 		std::function<BehaviorState(Blackboard*)> m_fpAction = nullptr;
 	};
 
+	//-----------------------------------------------------------------
+	// BEHAVIOR TREE DEFINITION
+	//-----------------------------------------------------------------
+	//The nodes of a tree, built once and shared by every agent that runs it. Takes ownership of the root behavior!
+	//The tree is compiled into a flat array that is run by a loop instead of recursive virtual calls
+	class BehaviorTreeDefinition final
+	{
+	public:
+		//An open composite and the child it is running
+		struct Frame
+		{
+			int compositeIndex;
+			int childIndex;
+		};
+
+		//Memory ExecuteBatch works in, kept by the caller so a batch doesn't allocate every update
+		struct BatchMemory
+		{
+			std::vector<Frame> frames = {};  //GetMaxDepth() per agent
+			std::vector<int> nrOfFrames = {};
+			std::vector<int> firstAgents = {};  //Per node, the agents waiting to run it
+			std::vector<int> lastAgents = {};
+			std::vector<int> nextAgents = {};  //Per agent, the next one waiting at the same node
+		};
+
+		explicit BehaviorTreeDefinition(IBehavior* pRootBehavior);
+		~BehaviorTreeDefinition()
+		{
+			SAFE_DELETE(m_pRootBehavior);
+		}
+
+		BehaviorTreeDefinition(const BehaviorTreeDefinition& other) = delete;
+		BehaviorTreeDefinition& operator=(const BehaviorTreeDefinition& other) = delete;
+		BehaviorTreeDefinition(BehaviorTreeDefinition&& other) = delete;
+		BehaviorTreeDefinition& operator=(BehaviorTreeDefinition&& other) = delete;
+
+		BehaviorState Execute(Blackboard* pBlackBoard, BehaviorTreeState& state) const;
+		//Runs the tree for many agents at once: a node runs for every agent that reaches it before the next node does,
+		//so each conditional and action is a loop over the blackboards. Every agent gets the result Execute would give,
+		//as long as the behaviors of one agent don't read what another agent's behaviors write in the same update
+		void ExecuteBatch(Blackboard* const* pBlackBoards, BehaviorTreeState* const* pStates, BehaviorState* pResults,
+			int nrOfAgents, BatchMemory& memory) const;
+
+		const IBehavior* GetRootBehavior() const { return m_pRootBehavior; }
+		const std::vector<CompiledBehavior>& GetCompiledBehaviors() const { return m_CompiledBehaviors; }
+		BehaviorTreeState CreateState() const { return BehaviorTreeState{ m_NrOfNodes, m_NrOfRunningIndices }; }
+		int GetMaxDepth() const { return m_MaxDepth; }
+
+	private:
+		static const int MaxCompiledDepth = 64;  //Deeper trees run recursively
+
+		//One step of the interpreter each, they return false when the node is done and result holds its result
+		bool EnterComposite(int& index, Frame* pFrames, int& nrOfFrames, BehaviorTreeState& state, BehaviorState& result) const;
+		bool LeaveNode(int& index, Frame* pFrames, int& nrOfFrames, BehaviorTreeState& state, BehaviorState& result) const;
+
+		IBehavior* m_pRootBehavior = nullptr;
+		std::vector<CompiledBehavior> m_CompiledBehaviors = {};  //Empty when the tree isn't compiled
+		int m_NrOfNodes = 0;
+		int m_NrOfRunningIndices = 0;
+		int m_MaxDepth = 0;  //Most composites open at once
+	};
+
 	//-----------------------------------------------------------------
 	// BEHAVIOR TREE (BASE)
 	//-----------------------------------------------------------------
+	class BehaviorTreeBatch;
+	class DecisionWorkers;
 	class BehaviorTree final : public Elite::IDecisionMaking
 	{
 	public:
+		//Builds a tree for this agent only, takes ownership of the root behavior
 		explicit BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
-			: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior) {};
-		~BehaviorTree()
-		{
-			SAFE_DELETE(m_pRootBehavior);
-			SAFE_DELETE(m_pBlackBoard); //Takes ownership of passed blackboard!
-		};
+			: m_pBlackBoard(pBlackBoard), m_pOwnedDefinition(new BehaviorTreeDefinition(pRootBehavior)),
+			m_pDefinition(m_pOwnedDefinition), m_State(m_pDefinition->CreateState()) {};
+		//Runs a shared tree, the definition has to outlive this tree
+		explicit BehaviorTree(Blackboard* pBlackBoard, const BehaviorTreeDefinition* pDefinition)
+			: m_pBlackBoard(pBlackBoard), m_pDefinition(pDefinition), m_State(m_pDefinition->CreateState()) {};
+		~BehaviorTree();
 
 		virtual void Update(float deltaTime) override
 		{
-			if (m_pRootBehavior == nullptr)
+			if(m_pBatch != nullptr)
 			{
-				m_CurrentState = BehaviorState::Failure;
+				//Runs with the other trees of the batch, that can be some frames later when a scheduler skips Update
+				m_BatchTime += deltaTime;
+				m_IsWaitingForBatch = true;
 				return;
 			}
-				
-			m_CurrentState = m_pRootBehavior->Execute(m_pBlackBoard);
+
+			ELITE_PROFILE_SCOPE("BehaviorTree::Update");
+			if(BeginUpdate(deltaTime))
+				EndUpdate(m_pDefinition->Execute(m_pBlackBoard, m_State));
 		}
+
+		//Event driven: the tree is only evaluated again when a key observed by the last evaluation changed, when the
+		//running action finished, when asked to or after refreshInterval seconds (0 = never, for conditionals that
+		//depend on more than the blackboard, like positions). In between only the running action is continued.
+		void SetEventDriven(bool isEventDriven, float refreshInterval = 0.f)
+		{
+			m_IsEventDriven = isEventDriven;
+			m_RefreshInterval = refreshInterval;
+			m_NeedsEvaluation = true;
+		}
+		bool IsEventDriven() const
+		{ return m_IsEventDriven; }
+		void RequestEvaluation()
+		{ m_NeedsEvaluation = true; }
+
 		Blackboard* GetBlackboard() const
 		{ return m_pBlackBoard;	}
+		BehaviorState GetCurrentState() const
+		{ return m_CurrentState; }
+		const BehaviorTreeState& GetState() const
+		{ return m_State; }
+
+		BehaviorTreeBatch* GetBatch() const
+		{ return m_pBatch; }
 
 	private:
+		friend class BehaviorTreeBatch;
+
+		//BeginUpdate returns false when the tree doesn't have to be evaluated this update, EndUpdate takes the result
+		bool BeginUpdate(float deltaTime);
+		void EndUpdate(BehaviorState result);
+		bool HasObservedChanges() const;
+
 		BehaviorState m_CurrentState = BehaviorState::Failure;
 		Blackboard* m_pBlackBoard = nullptr;
-		IBehavior* m_pRootBehavior = nullptr;
+		BehaviorTreeDefinition* m_pOwnedDefinition = nullptr;
+		const BehaviorTreeDefinition* m_pDefinition = nullptr;
+		BehaviorTreeState m_State = {};
+		BehaviorTreeBatch* m_pBatch = nullptr;
+		float m_BatchTime = 0.f;
+		bool m_IsWaitingForBatch = false;
+
+		bool m_IsEventDriven = false;
+		bool m_NeedsEvaluation = true;
+		float m_RefreshInterval = 0.f;
+		float m_TimeSinceEvaluation = 0.f;
+		unsigned int m_EvaluatedVersion = 0;  //Blackboard version right after the last evaluation
+	};
+
+	//-----------------------------------------------------------------
+	// BEHAVIOR TREE BATCH
+	//-----------------------------------------------------------------
+	//Updates all trees that run one definition together with BehaviorTreeDefinition::ExecuteBatch, instead of every
+	//agent going through the whole tree on its own. BehaviorTree::Update of a tree in a batch only marks it, Update of the
+	//batch then runs the marked trees. A tree leaves its batch when it is deleted, the batch has to outlive the trees in it
+	class BehaviorTreeBatch final
+	{
+	public:
+		explicit BehaviorTreeBatch(const BehaviorTreeDefinition* pDefinition) : m_pDefinition(pDefinition) {}
+		~BehaviorTreeBatch();  //The trees left update themselves again
+
+		BehaviorTreeBatch(const BehaviorTreeBatch& other) = delete;
+		BehaviorTreeBatch& operator=(const BehaviorTreeBatch& other) = delete;
+		BehaviorTreeBatch(BehaviorTreeBatch&& other) = delete;
+		BehaviorTreeBatch& operator=(BehaviorTreeBatch&& other) = delete;
+
+		bool AddTree(BehaviorTree* pTree);  //Fails for trees of another definition or in another batch
+		void RemoveTree(BehaviorTree* pTree);
+		size_t GetNrOfTrees() const { return m_pTrees.size(); }
+		const std::vector<BehaviorTree*>& GetTrees() const { return m_pTrees; }
+
+		//With workers every thread runs a part of the trees, changes outside the blackboards have to go through
+		//DecisionCommandBuffer::Submit then
+		void Update(DecisionWorkers* pWorkers = nullptr);
+
+	private:
+		//The trees one thread evaluates in this update, kept to not allocate every frame
+		struct Chunk
+		{
+			std::vector<BehaviorTree*> pEvaluatedTrees = {};
+			std::vector<Blackboard*> pBlackBoards = {};
+			std::vector<BehaviorTreeState*> pStates = {};
+			std::vector<BehaviorState> results = {};
+			BehaviorTreeDefinition::BatchMemory memory = {};
+		};
+
+		void UpdateChunk(int firstTree, int endTree, Chunk& chunk);
+
+		const BehaviorTreeDefinition* m_pDefinition = nullptr;
+		std::vector<BehaviorTree*> m_pTrees = {};
+		std::vector<BehaviorTree*> m_pWaitingTrees = {};
+		std::vector<Chunk> m_Chunks = {};
 	};
 }
 #endif
\ No newline at end of file
@@ -3,55 +3,92 @@
 #include "EFiniteStateMachine.h"
 using namespace Elite;
 
+//-----------------------------------------------------------------
+// FINITE STATE MACHINE DEFINITION
+//-----------------------------------------------------------------
+int FiniteStateMachineDefinition::AddState(FSMState* pState)
+{
+    assert(pState != nullptr);
+
+    const int stateId = GetStateId(pState);
+    if (stateId >= 0)
+        return stateId;
+
+    m_pStates.push_back(pState);
+    m_FirstTransitions.push_back(m_FirstTransitions.back());  //No transitions yet
+    return GetNrOfStates() - 1;
+}
+
+void FiniteStateMachineDefinition::AddTransition(FSMState* startState, FSMState* toState, FSMCondition* condition)
+{
+    assert(condition != nullptr);
+
+    const int startStateId = AddState(startState);
+    const int toStateId = AddState(toState);
+
+    //Behind the other transitions of the start state, the states after it move up one
+    const int transitionIndex = m_FirstTransitions[startStateId + 1];
+    m_Transitions.insert(m_Transitions.begin() + transitionIndex, Transition{ condition, toStateId });
+    for (int stateId = startStateId + 1; stateId < static_cast<int>(m_FirstTransitions.size()); ++stateId)
+        ++m_FirstTransitions[stateId];
+}
+
+int FiniteStateMachineDefinition::GetStateId(const FSMState* pState) const
+{
+    //Only used while building the machines, a few states are found faster by a search than a map
+    const auto stateIt = std::find(m_pStates.begin(), m_pStates.end(), pState);
+    return stateIt != m_pStates.end() ? static_cast<int>(stateIt - m_pStates.begin()) : -1;
+}
+
+//-----------------------------------------------------------------
+// FINITE STATE MACHINE
+//-----------------------------------------------------------------
 FiniteStateMachine::FiniteStateMachine(FSMState* startState, Blackboard* pBlackboard)
-    : m_pCurrentState(nullptr),
+    : m_pOwnedDefinition(new FiniteStateMachineDefinition()),
+    m_pDefinition(m_pOwnedDefinition),
+    m_pBlackboard(pBlackboard)
+{
+    ChangeState(m_pOwnedDefinition->AddState(startState));
+}
+
+FiniteStateMachine::FiniteStateMachine(const FiniteStateMachineDefinition* pDefinition, FSMState* startState, Blackboard* pBlackboard)
+    : m_pDefinition(pDefinition),
     m_pBlackboard(pBlackboard)
 {
-    ChangeState(startState);
+    //Checked in every build, a state that isn't part of the definition has no id to run from
+    const int startStateId = m_pDefinition->GetStateId(startState);
+    if (startStateId < 0)
+        throw Elite_Exception("FiniteStateMachine: the start state is not part of the definition!");
+    ChangeState(startStateId);
 }
 
 FiniteStateMachine::~FiniteStateMachine()
 {
+    SAFE_DELETE(m_pOwnedDefinition);
     SAFE_DELETE(m_pBlackboard);
 }
 
 void FiniteStateMachine::AddTransition(FSMState* startState, FSMState* toState, FSMCondition* condition)
 {
-    auto it = m_Transitions.find(startState);
-    if (it == m_Transitions.end())
-    {
-        m_Transitions[startState] = Transitions();
-    }
-   
-    m_Transitions[startState].push_back(std::make_pair(condition, toState));
+    //A shared machine is the same for every agent, it's built on the definition
+    assert(m_pOwnedDefinition != nullptr);
+    if (m_pOwnedDefinition != nullptr)
+        m_pOwnedDefinition->AddTransition(startState, toState, condition);
 }
 
 void FiniteStateMachine::Update(float deltaTime)
 {
-    //TODO 4: Look if 1 or more transition exists for the current state that we are in
-    //Tip: Check the transitions map for a TransitionState pair
-    auto transitionIt = m_Transitions.find(m_pCurrentState);
-	
-    //TODO 5: if a TransitionState exists
-    if (transitionIt != m_Transitions.end())
+    ELITE_PROFILE_SCOPE("FiniteStateMachine::Update");
+    //The transitions of the current state are one range in the table, the first condition that holds wins
+    const FiniteStateMachineDefinition::Transition* pEnd = m_pDefinition->GetTransitionsEnd(m_CurrentStateId);
+    for (const FiniteStateMachineDefinition::Transition* pTransition = m_pDefinition->GetTransitionsBegin(m_CurrentStateId); pTransition != pEnd; ++pTransition)
     {
-        //TODO 6: Loop over all the TransitionState pairs 
-        for (auto& transition : transitionIt->second)
+        if (pTransition->pCondition->Evaluate(m_pBlackboard))
         {
-            FSMCondition* cond = transition.first;
-            FSMState* state = transition.second;
-			
-			assert(cond && state);
-
-			if (cond->Evaluate(m_pBlackboard))
-			{
-                //TODO 8: Update the current state (if one exists)
-				ChangeState(transition.second);
-                return;
-			}
+            ChangeState(pTransition->toStateId);
+            return;
         }
     }
-    
 }
 
 Blackboard* FiniteStateMachine::GetBlackboard() const
@@ -59,20 +96,17 @@ Blackboard* FiniteStateMachine::GetBlackboard() const
     return m_pBlackboard;
 }
 
-void FiniteStateMachine::ChangeState(FSMState* newState)
+void FiniteStateMachine::ChangeState(int newStateId)
 {
-    //TODO 1. If currently in a state => make sure the OnExit of that state gets called
-    if (m_pCurrentState != nullptr)
+    assert(newStateId >= 0 && newStateId < m_pDefinition->GetNrOfStates());
+
+    //If currently in a state => make sure the OnExit of that state gets called
+    if (m_CurrentStateId >= 0)
     {
-		m_pCurrentState->OnExit(m_pBlackboard);
+        m_pDefinition->GetState(m_CurrentStateId)->OnExit(m_pBlackboard);
     }
 
-    //TODO 2. Change the current state to the new state
-    m_pCurrentState = newState;
-
-    assert(m_pCurrentState != nullptr);
-
-    //TODO 3. Call the OnEnter of the new state
-	m_pCurrentState->OnEnter(m_pBlackboard);
-        
+    //Change the current state to the new state and call its OnEnter
+    m_CurrentStateId = newStateId;
+    m_pDefinition->GetState(m_CurrentStateId)->OnEnter(m_pBlackboard);
 }
@@ -30,24 +30,64 @@ namespace Elite
 		virtual bool Evaluate(Blackboard* pBlackboard) const = 0;
 	};
 
+	//The states and transitions of a machine, built once and shared by every agent that runs it.
+	//States get dense ids in the order they are added, the transitions of a state are stored next to each other.
+	//The states and conditions are not owned by the definition
+	class FiniteStateMachineDefinition final
+	{
+	public:
+		struct Transition
+		{
+			const FSMCondition* pCondition;
+			int toStateId;
+		};
+
+		FiniteStateMachineDefinition() = default;
+		~FiniteStateMachineDefinition() = default;
+
+		FiniteStateMachineDefinition(const FiniteStateMachineDefinition& other) = delete;
+		FiniteStateMachineDefinition& operator=(const FiniteStateMachineDefinition& other) = delete;
+		FiniteStateMachineDefinition(FiniteStateMachineDefinition&& other) = delete;
+		FiniteStateMachineDefinition& operator=(FiniteStateMachineDefinition&& other) = delete;
+
+		int AddState(FSMState* pState);  //Returns the id of the state, also when it was added before
+		void AddTransition(FSMState* startState, FSMState* toState, FSMCondition* condition);
+
+		int GetStateId(const FSMState* pState) const;  //-1 when the state isn't part of this machine
+		FSMState* GetState(int stateId) const { return m_pStates[stateId]; }
+		int GetNrOfStates() const { return static_cast<int>(m_pStates.size()); }
+
+		//The transitions of a state, in the order they were added
+		const Transition* GetTransitionsBegin(int stateId) const { return m_Transitions.data() + m_FirstTransitions[stateId]; }
+		const Transition* GetTransitionsEnd(int stateId) const { return m_Transitions.data() + m_FirstTransitions[stateId + 1]; }
+
+	private:
+		std::vector<FSMState*> m_pStates = {};
+		std::vector<Transition> m_Transitions = {};  //Grouped per start state
+		std::vector<int> m_FirstTransitions = { 0 };  //Per state the index of its first transition, then the end of the last state
+	};
+
 	class FiniteStateMachine final : public Elite::IDecisionMaking
 	{
 	public:
+		//Builds a machine for this agent only, add the transitions with AddTransition
 		FiniteStateMachine(FSMState* startState, Blackboard* pBlackboard);
+		//Runs a shared machine, the definition has to outlive this machine. Throws an Elite_Exception when the start state isn't part of it
+		FiniteStateMachine(const FiniteStateMachineDefinition* pDefinition, FSMState* startState, Blackboard* pBlackboard);
 		virtual ~FiniteStateMachine();
 		
-		void AddTransition(FSMState* startState, FSMState* toState, FSMCondition* transition);
+		void AddTransition(FSMState* startState, FSMState* toState, FSMCondition* transition);  //Only on a machine of its own
 		virtual void Update(float deltaTime) override;
 		Elite::Blackboard* GetBlackboard() const;
+		int GetCurrentStateId() const { return m_CurrentStateId; }
+		const FiniteStateMachineDefinition* GetDefinition() const { return m_pDefinition; }
 
 	private:
-		void ChangeState(FSMState* newState);
+		void ChangeState(int newStateId);
 	private:
-		typedef std::pair<FSMCondition*, FSMState*> TransitionStatePair;
-		typedef std::vector<TransitionStatePair> Transitions;
-
-		std::map<FSMState*, Transitions> m_Transitions; //Key is the state, value are all the transitions for that current state 
-		FSMState* m_pCurrentState;
+		FiniteStateMachineDefinition* m_pOwnedDefinition = nullptr;
+		const FiniteStateMachineDefinition* m_pDefinition = nullptr;
+		int m_CurrentStateId = -1;  //All the state an agent has in the machine
 		Blackboard* m_pBlackboard = nullptr; // takes ownership of the blackboard
 	};
 
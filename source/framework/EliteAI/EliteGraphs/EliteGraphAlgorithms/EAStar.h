@@ -50,6 +50,7 @@ namespace Elite
 	template <class T_NodeType, class T_ConnectionType>
 	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode)
 	{
+		ELITE_PROFILE_SCOPE("AStar::FindPath");
 		std::vector<T_NodeType*> path{};
 		std::vector<NodeRecord> openList{};
 		std::vector<NodeRecord> closedList{};
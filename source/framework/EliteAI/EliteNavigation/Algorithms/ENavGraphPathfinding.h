@@ -12,6 +12,7 @@ namespace Elite
 	public:
 		static std::vector<Vector2> FindPath(Vector2 startPos, Vector2 endPos, NavGraph* pNavGraph, std::vector<Vector2>& debugNodePositions, std::vector<Portal>& debugPortals)
 		{
+			ELITE_PROFILE_SCOPE("NavMeshPathfinding::FindPath");
 			//Create the path to return
 			std::vector<Vector2> finalPath{};
 
@@ -0,0 +1,124 @@
+#include "stdafx.h"
+#include "EHeadlessRunner.h"
+#include "framework/EliteInterfaces/EIApp.h"
+
+#include <iomanip>
+
+namespace
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	double GetMilliseconds(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	//Same order as the application loop in main.cpp, without window events and presenting
+	void Tick(IApp* pApp, Elite::EImmediateUI& immediateUI, const Elite::EHeadlessRunner::Settings& settings)
+	{
+		ELITE_PROFILE_BEGIN_FRAME();
+		immediateUI.NewFrameHeadless(settings.deltaTime);
+
+		PHYSICSWORLD->Simulate(settings.deltaTime);
+		{
+			ELITE_PROFILE_SCOPE("App Update");
+			pApp->Update(settings.deltaTime);
+		}
+
+		{
+			ELITE_PROFILE_SCOPE("App FixedUpdate");
+			const int nrOfSteps = SIMULATIONCLOCK->Advance(settings.deltaTime);
+			for (int step = 0; step < nrOfSteps; ++step)
+				pApp->FixedUpdate(SIMULATIONCLOCK->GetStepTime());
+		}
+
+		if (settings.renderApp)
+		{
+			ELITE_PROFILE_SCOPE("App Render");
+			pApp->Render(settings.deltaTime);
+		}
+
+		DEBUGRENDERER2D->Render();
+		immediateUI.Render();
+		ELITE_PROFILE_END_FRAME();
+	}
+}
+
+Elite::EHeadlessRunner::Result Elite::EHeadlessRunner::Run(const Settings& settings, const std::function<IApp*()>& createApp, std::ostream& output)
+{
+	//Camera only exists for the apps that set it up or convert coordinates, it never moves
+	Camera2D camera(settings.displayWidth, settings.displayHeight);
+	DEBUGRENDERER2D->InitializeHeadless(&camera);
+
+	EImmediateUI immediateUI;
+	immediateUI.InitializeHeadless(settings.displayWidth, settings.displayHeight);
+
+	PHYSICSWORLD; //Boot
+	SIMULATIONCLOCK->Reset();
+
+	Result result{};
+
+	//Apps build UI in Start too, so there has to be a frame to put it in
+	immediateUI.NewFrameHeadless(settings.deltaTime);
+	const Clock::time_point startStart = Clock::now();
+	IApp* pApp = createApp();
+	pApp->Start();
+	result.startMilliseconds = GetMilliseconds(startStart);
+	immediateUI.Render();
+
+	for (int tick = 0; tick < settings.nrOfWarmupTicks; ++tick)
+		Tick(pApp, immediateUI, settings);
+
+#ifdef USE_PROFILER
+	if (!settings.traceFilePath.empty())
+		PROFILER->StartCapture(settings.nrOfTicks, settings.traceFilePath);
+#endif
+
+	std::vector<double> tickMilliseconds;
+	tickMilliseconds.reserve(std::max(settings.nrOfTicks, 0));
+
+	const Clock::time_point runStart = Clock::now();
+	for (int tick = 0; tick < settings.nrOfTicks; ++tick)
+	{
+		const Clock::time_point tickStart = Clock::now();
+		Tick(pApp, immediateUI, settings);
+		tickMilliseconds.push_back(GetMilliseconds(tickStart));
+	}
+	result.totalMilliseconds = GetMilliseconds(runStart);
+
+	SAFE_DELETE(pApp);
+	DEBUGRENDERER2D->InitializeHeadless(nullptr); //The camera only lives for this run
+
+	result.nrOfTicks = static_cast<int>(tickMilliseconds.size());
+	if (result.nrOfTicks > 0)
+	{
+		std::sort(tickMilliseconds.begin(), tickMilliseconds.end());
+		const auto percentile = [&tickMilliseconds](double fraction)
+		{
+			const size_t index = static_cast<size_t>(fraction * (tickMilliseconds.size() - 1) + 0.5);
+			return tickMilliseconds[index];
+		};
+
+		double sum = 0.0;
+		for (double milliseconds : tickMilliseconds)
+			sum += milliseconds;
+
+		result.averageMilliseconds = sum / result.nrOfTicks;
+		result.minMilliseconds = tickMilliseconds.front();
+		result.maxMilliseconds = tickMilliseconds.back();
+		result.medianMilliseconds = percentile(0.5);
+		result.p95Milliseconds = percentile(0.95);
+		result.p99Milliseconds = percentile(0.99);
+	}
+
+	output << std::fixed << std::setprecision(3)
+		<< "ticks: " << result.nrOfTicks << " (dt " << settings.deltaTime << " s, " << settings.nrOfWarmupTicks << " warmup)\n"
+		<< "start: " << result.startMilliseconds << " ms\n"
+		<< "total: " << result.totalMilliseconds << " ms ("
+		<< (result.totalMilliseconds > 0.0 ? 1000.0 * result.nrOfTicks / result.totalMilliseconds : 0.0) << " ticks/s, "
+		<< (result.totalMilliseconds > 0.0 ? result.nrOfTicks * settings.deltaTime * 1000.0 / result.totalMilliseconds : 0.0) << "x realtime)\n"
+		<< "tick ms: avg " << result.averageMilliseconds << "  min " << result.minMilliseconds << "  median " << result.medianMilliseconds
+		<< "  p95 " << result.p95Milliseconds << "  p99 " << result.p99Milliseconds << "  max " << result.maxMilliseconds << "\n";
+
+	return result;
+}
@@ -0,0 +1,50 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// EHeadlessRunner.h: runs an app without window, GL context or visible UI, as fast as possible.
+// Physics, Update and FixedUpdate run like in the normal loop with a fixed frame time, the debug renderer and ImGui
+// still accept every call but nothing is drawn. Reports the time per tick, start with --headless [ticks] [trace.json].
+/*=============================================================================*/
+#ifndef ELITE_HEADLESS_RUNNER
+#define	ELITE_HEADLESS_RUNNER
+
+#include <ostream>
+#include <string>
+#include <functional>
+class IApp;
+
+namespace Elite
+{
+	class EHeadlessRunner final
+	{
+	public:
+		struct Settings
+		{
+			int nrOfTicks = 1000;
+			int nrOfWarmupTicks = 10;  //Run before the timing starts, not part of the results
+			float deltaTime = 1.f / 60.f;  //Frame time every tick pretends to take
+			bool renderApp = false;  //Also time IApp::Render (building the debug draw data)
+			int displayWidth = 1280;
+			int displayHeight = 720;
+			std::string traceFilePath;  //Writes a Chrome trace of the timed ticks when set (needs USE_PROFILER)
+		};
+
+		struct Result
+		{
+			int nrOfTicks = 0;
+			double startMilliseconds = 0.0;  //IApp::Start
+			double totalMilliseconds = 0.0;
+			double averageMilliseconds = 0.0;
+			double minMilliseconds = 0.0;
+			double maxMilliseconds = 0.0;
+			double medianMilliseconds = 0.0;
+			double p95Milliseconds = 0.0;
+			double p99Milliseconds = 0.0;
+		};
+
+		//Creates the app, starts it and runs the ticks, the report is written to output
+		static Result Run(const Settings& settings, const std::function<IApp*()>& createApp, std::ostream& output);
+	};
+}
+#endif
@@ -13,6 +13,9 @@ public:
 	//App Functions
 	virtual void Start() = 0;
 	virtual void Update(float deltaTime) = 0;
+	//Called after Update, zero or more times per frame with the fixed step of the SIMULATIONCLOCK
+	//Apps that move their simulation here keep the input and UI in Update (once per frame)
+	virtual void FixedUpdate(float fixedDeltaTime) {}
 	virtual void Render(float deltaTime) const = 0;
 
 protected:
@@ -0,0 +1,168 @@
+#include "stdafx.h"
+#include "EVector2SIMD.h"
+
+namespace Elite
+{
+namespace SIMD
+{
+	// Widest packet the build supports, the kernels below are written once against it
+#ifdef ELITE_SIMD_AVX
+	using FloatN = Float8;
+#else
+	using FloatN = Float4;
+#endif
+	using Vector2N = Vector2Packet<FloatN>;
+
+	// Smallest magnitude that still gets normalized, same threshold as Vector2::Normalize
+	constexpr float NormalizeEpsilonSquared{ FLT_EPSILON * FLT_EPSILON };
+
+	void DistanceSquared(const float* pX, const float* pY, int count, const Vector2& point, float* pResults)
+	{
+		const Vector2N points{ Vector2N::Set(point) };
+
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			MagnitudeSquared(Vector2N::Load(pX + index, pY + index) - points).Store(pResults + index);
+		}
+		for (; index < count; ++index)
+		{
+			pResults[index] = Square(pX[index] - point.x) + Square(pY[index] - point.y);
+		}
+	}
+
+	int FilterWithinDistanceSquared(const float* pX, const float* pY, int count, const Vector2& point, float radiusSquared,
+		int* pIndices, float* pDistancesSquared)
+	{
+		const Vector2N points{ Vector2N::Set(point) };
+		const FloatN radiiSquared{ FloatN::Set(radiusSquared) };
+		float distancesSquared[FloatN::Width];
+		int nrOfResults{};
+
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			const FloatN distanceSquared{ MagnitudeSquared(Vector2N::Load(pX + index, pY + index) - points) };
+			const int mask{ MoveMask(Less(distanceSquared, radiiSquared)) };
+			if (mask == 0)
+				continue;
+
+			distanceSquared.Store(distancesSquared);
+			for (int lane{}; lane < FloatN::Width; ++lane)
+			{
+				if ((mask & (1 << lane)) == 0)
+					continue;
+
+				if (pDistancesSquared)
+					pDistancesSquared[nrOfResults] = distancesSquared[lane];
+				pIndices[nrOfResults++] = index + lane;
+			}
+		}
+		for (; index < count; ++index)
+		{
+			const float distanceSquared{ Square(pX[index] - point.x) + Square(pY[index] - point.y) };
+			if (distanceSquared >= radiusSquared)
+				continue;
+
+			if (pDistancesSquared)
+				pDistancesSquared[nrOfResults] = distanceSquared;
+			pIndices[nrOfResults++] = index;
+		}
+
+		return nrOfResults;
+	}
+
+	void Normalize(float* pX, float* pY, int count)
+	{
+		const FloatN epsilons{ FloatN::Set(NormalizeEpsilonSquared) };
+		const FloatN ones{ FloatN::Set(1.0f) };
+		const FloatN zeros{ FloatN::Set(0.0f) };
+
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			const Vector2N vectors{ Vector2N::Load(pX + index, pY + index) };
+			const FloatN magnitudeSquared{ MagnitudeSquared(vectors) };
+			const FloatN scale{ Select(Greater(magnitudeSquared, epsilons), ones / Sqrt(magnitudeSquared), zeros) };
+			(vectors * scale).Store(pX + index, pY + index);
+		}
+		for (; index < count; ++index)
+		{
+			const float magnitudeSquared{ Square(pX[index]) + Square(pY[index]) };
+			const float scale{ magnitudeSquared > NormalizeEpsilonSquared ? 1.0f / sqrtf(magnitudeSquared) : 0.0f };
+			pX[index] *= scale;
+			pY[index] *= scale;
+		}
+	}
+
+	void Truncate(float* pX, float* pY, int count, float maxLength)
+	{
+		const FloatN maxLengthsSquared{ FloatN::Set(Square(maxLength)) };
+		const FloatN maxLengths{ FloatN::Set(maxLength) };
+		const FloatN ones{ FloatN::Set(1.0f) };
+
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			const Vector2N vectors{ Vector2N::Load(pX + index, pY + index) };
+			const FloatN magnitudeSquared{ MagnitudeSquared(vectors) };
+			// Only lanes longer than maxLength get scaled, so the division never sees a zero length
+			const FloatN isTooLong{ Greater(magnitudeSquared, maxLengthsSquared) };
+			const FloatN scale{ Select(isTooLong, maxLengths / Sqrt(Select(isTooLong, magnitudeSquared, ones)), ones) };
+			(vectors * scale).Store(pX + index, pY + index);
+		}
+		for (; index < count; ++index)
+		{
+			const float magnitudeSquared{ Square(pX[index]) + Square(pY[index]) };
+			if (magnitudeSquared <= Square(maxLength))
+				continue;
+
+			const float scale{ maxLength / sqrtf(magnitudeSquared) };
+			pX[index] *= scale;
+			pY[index] *= scale;
+		}
+	}
+
+	void Clamp(float* pValues, int count, float min, float max)
+	{
+		const FloatN mins{ FloatN::Set(min) };
+		const FloatN maxs{ FloatN::Set(max) };
+
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			Min(Max(FloatN::Load(pValues + index), mins), maxs).Store(pValues + index);
+		}
+		for (; index < count; ++index)
+		{
+			pValues[index] = std::min(std::max(pValues[index], min), max);
+		}
+	}
+
+	void Dot(const float* pAX, const float* pAY, const float* pBX, const float* pBY, int count, float* pResults)
+	{
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			Elite::Dot(Vector2N::Load(pAX + index, pAY + index), Vector2N::Load(pBX + index, pBY + index)).Store(pResults + index);
+		}
+		for (; index < count; ++index)
+		{
+			pResults[index] = pAX[index] * pBX[index] + pAY[index] * pBY[index];
+		}
+	}
+
+	void Cross(const float* pAX, const float* pAY, const float* pBX, const float* pBY, int count, float* pResults)
+	{
+		int index{};
+		for (; index + FloatN::Width <= count; index += FloatN::Width)
+		{
+			Elite::Cross(Vector2N::Load(pAX + index, pAY + index), Vector2N::Load(pBX + index, pBY + index)).Store(pResults + index);
+		}
+		for (; index < count; ++index)
+		{
+			pResults[index] = pAX[index] * pBY[index] - pAY[index] * pBX[index];
+		}
+	}
+}
+}
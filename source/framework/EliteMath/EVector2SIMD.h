@@ -0,0 +1,188 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// EVector2SIMD.h: Packets of 4/8 Vector2 and kernels that work on structure of arrays (separate x and y arrays).
+// Uses AVX when the compiler targets it (/arch:AVX or higher), SSE2 otherwise (default for Win32 and x64),
+// and falls back to plain loops when neither is available.
+/*=============================================================================*/
+#ifndef ELITE_MATH_VECTOR2_SIMD
+#define ELITE_MATH_VECTOR2_SIMD
+
+#include "EVector2.h"
+
+#if defined(__AVX__)
+#define ELITE_SIMD_AVX
+#endif
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ELITE_SIMD_SSE
+#include <immintrin.h>
+#endif
+
+namespace Elite
+{
+	// --- Float4 ---
+	// --------------
+	// Comparisons return a mask, use it with Select or MoveMask
+	struct Float4
+	{
+		static constexpr int Width{ 4 };
+
+#ifdef ELITE_SIMD_SSE
+		__m128 v;
+
+		static Float4 Load(const float* pData) { return { _mm_loadu_ps(pData) }; }
+		static Float4 Set(float value) { return { _mm_set1_ps(value) }; }
+		void Store(float* pData) const { _mm_storeu_ps(pData, v); }
+#else
+		float v[Width];
+
+		static Float4 Load(const float* pData) { return { pData[0], pData[1], pData[2], pData[3] }; }
+		static Float4 Set(float value) { return { value, value, value, value }; }
+		void Store(float* pData) const { for (int i{}; i < Width; ++i) pData[i] = v[i]; }
+#endif
+	};
+
+#ifdef ELITE_SIMD_SSE
+	inline Float4 operator+(const Float4& a, const Float4& b) { return { _mm_add_ps(a.v, b.v) }; }
+	inline Float4 operator-(const Float4& a, const Float4& b) { return { _mm_sub_ps(a.v, b.v) }; }
+	inline Float4 operator*(const Float4& a, const Float4& b) { return { _mm_mul_ps(a.v, b.v) }; }
+	inline Float4 operator/(const Float4& a, const Float4& b) { return { _mm_div_ps(a.v, b.v) }; }
+	inline Float4 Min(const Float4& a, const Float4& b) { return { _mm_min_ps(a.v, b.v) }; }
+	inline Float4 Max(const Float4& a, const Float4& b) { return { _mm_max_ps(a.v, b.v) }; }
+	inline Float4 Sqrt(const Float4& a) { return { _mm_sqrt_ps(a.v) }; }
+	inline Float4 Less(const Float4& a, const Float4& b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+	inline Float4 Greater(const Float4& a, const Float4& b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+	inline Float4 Select(const Float4& mask, const Float4& a, const Float4& b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+	inline int MoveMask(const Float4& mask) { return _mm_movemask_ps(mask.v); }
+#else
+	template<typename Operation>
+	inline Float4 PerLane(const Float4& a, const Float4& b, Operation operation)
+	{
+		Float4 result;
+		for (int i{}; i < Float4::Width; ++i) result.v[i] = operation(a.v[i], b.v[i]);
+		return result;
+	}
+	inline Float4 operator+(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x + y; }); }
+	inline Float4 operator-(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x - y; }); }
+	inline Float4 operator*(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x * y; }); }
+	inline Float4 operator/(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x / y; }); }
+	inline Float4 Min(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	inline Float4 Max(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	inline Float4 Sqrt(const Float4& a) { return PerLane(a, a, [](float x, float) { return sqrtf(x); }); }
+	inline Float4 Less(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); }
+	inline Float4 Greater(const Float4& a, const Float4& b) { return PerLane(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); }
+	inline Float4 Select(const Float4& mask, const Float4& a, const Float4& b)
+	{
+		Float4 result;
+		for (int i{}; i < Float4::Width; ++i) result.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+		return result;
+	}
+	inline int MoveMask(const Float4& mask)
+	{
+		int bits{};
+		for (int i{}; i < Float4::Width; ++i) bits |= (mask.v[i] != 0.0f ? 1 : 0) << i;
+		return bits;
+	}
+#endif
+
+	// --- Float8 ---
+	// --------------
+	// Two Float4 when AVX is not available
+	struct Float8
+	{
+		static constexpr int Width{ 8 };
+
+#ifdef ELITE_SIMD_AVX
+		__m256 v;
+
+		static Float8 Load(const float* pData) { return { _mm256_loadu_ps(pData) }; }
+		static Float8 Set(float value) { return { _mm256_set1_ps(value) }; }
+		void Store(float* pData) const { _mm256_storeu_ps(pData, v); }
+#else
+		Float4 low;
+		Float4 high;
+
+		static Float8 Load(const float* pData) { return { Float4::Load(pData), Float4::Load(pData + 4) }; }
+		static Float8 Set(float value) { return { Float4::Set(value), Float4::Set(value) }; }
+		void Store(float* pData) const { low.Store(pData); high.Store(pData + 4); }
+#endif
+	};
+
+#ifdef ELITE_SIMD_AVX
+	inline Float8 operator+(const Float8& a, const Float8& b) { return { _mm256_add_ps(a.v, b.v) }; }
+	inline Float8 operator-(const Float8& a, const Float8& b) { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline Float8 operator*(const Float8& a, const Float8& b) { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline Float8 operator/(const Float8& a, const Float8& b) { return { _mm256_div_ps(a.v, b.v) }; }
+	inline Float8 Min(const Float8& a, const Float8& b) { return { _mm256_min_ps(a.v, b.v) }; }
+	inline Float8 Max(const Float8& a, const Float8& b) { return { _mm256_max_ps(a.v, b.v) }; }
+	inline Float8 Sqrt(const Float8& a) { return { _mm256_sqrt_ps(a.v) }; }
+	inline Float8 Less(const Float8& a, const Float8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+	inline Float8 Greater(const Float8& a, const Float8& b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+	inline Float8 Select(const Float8& mask, const Float8& a, const Float8& b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+	inline int MoveMask(const Float8& mask) { return _mm256_movemask_ps(mask.v); }
+#else
+	inline Float8 operator+(const Float8& a, const Float8& b) { return { a.low + b.low, a.high + b.high }; }
+	inline Float8 operator-(const Float8& a, const Float8& b) { return { a.low - b.low, a.high - b.high }; }
+	inline Float8 operator*(const Float8& a, const Float8& b) { return { a.low * b.low, a.high * b.high }; }
+	inline Float8 operator/(const Float8& a, const Float8& b) { return { a.low / b.low, a.high / b.high }; }
+	inline Float8 Min(const Float8& a, const Float8& b) { return { Min(a.low, b.low), Min(a.high, b.high) }; }
+	inline Float8 Max(const Float8& a, const Float8& b) { return { Max(a.low, b.low), Max(a.high, b.high) }; }
+	inline Float8 Sqrt(const Float8& a) { return { Sqrt(a.low), Sqrt(a.high) }; }
+	inline Float8 Less(const Float8& a, const Float8& b) { return { Less(a.low, b.low), Less(a.high, b.high) }; }
+	inline Float8 Greater(const Float8& a, const Float8& b) { return { Greater(a.low, b.low), Greater(a.high, b.high) }; }
+	inline Float8 Select(const Float8& mask, const Float8& a, const Float8& b) { return { Select(mask.low, a.low, b.low), Select(mask.high, a.high, b.high) }; }
+	inline int MoveMask(const Float8& mask) { return MoveMask(mask.low) | (MoveMask(mask.high) << 4); }
+#endif
+
+	// --- Vector2 Packets ---
+	// -----------------------
+	template<typename Float>
+	struct Vector2Packet
+	{
+		static constexpr int Width{ Float::Width };
+
+		Float x;
+		Float y;
+
+		static Vector2Packet Load(const float* pX, const float* pY) { return { Float::Load(pX), Float::Load(pY) }; }
+		static Vector2Packet Set(const Vector2& v) { return { Float::Set(v.x), Float::Set(v.y) }; }
+		void Store(float* pX, float* pY) const { x.Store(pX); y.Store(pY); }
+	};
+	using Vector2x4 = Vector2Packet<Float4>;
+	using Vector2x8 = Vector2Packet<Float8>;
+
+	template<typename Float>
+	inline Vector2Packet<Float> operator+(const Vector2Packet<Float>& a, const Vector2Packet<Float>& b) { return { a.x + b.x, a.y + b.y }; }
+	template<typename Float>
+	inline Vector2Packet<Float> operator-(const Vector2Packet<Float>& a, const Vector2Packet<Float>& b) { return { a.x - b.x, a.y - b.y }; }
+	template<typename Float>
+	inline Vector2Packet<Float> operator*(const Vector2Packet<Float>& v, const Float& scale) { return { v.x * scale, v.y * scale }; }
+	template<typename Float>
+	inline Float Dot(const Vector2Packet<Float>& a, const Vector2Packet<Float>& b) { return a.x * b.x + a.y * b.y; }
+	template<typename Float>
+	inline Float Cross(const Vector2Packet<Float>& a, const Vector2Packet<Float>& b) { return a.x * b.y - a.y * b.x; }
+	template<typename Float>
+	inline Float MagnitudeSquared(const Vector2Packet<Float>& v) { return Dot(v, v); }
+
+	// --- Kernels ---
+	// ---------------
+	// Work on count elements of separate x and y arrays, no alignment required.
+	// The full packets are done with the widest available type, the remainder with scalar code.
+	namespace SIMD
+	{
+		void DistanceSquared(const float* pX, const float* pY, int count, const Vector2& point, float* pResults);
+		// Writes the indices of the points closer than the radius (strictly) and returns the amount written,
+		// pIndices (and pDistancesSquared when used) need room for count elements
+		int FilterWithinDistanceSquared(const float* pX, const float* pY, int count, const Vector2& point, float radiusSquared,
+			int* pIndices, float* pDistancesSquared = nullptr);
+
+		void Normalize(float* pX, float* pY, int count);  // In place, vectors too small to normalize become zero (same as Vector2::Normalize)
+		void Truncate(float* pX, float* pY, int count, float maxLength);  // In place, scales down vectors longer than maxLength
+		void Clamp(float* pValues, int count, float min, float max);
+
+		void Dot(const float* pAX, const float* pAY, const float* pBX, const float* pBY, int count, float* pResults);
+		void Cross(const float* pAX, const float* pAY, const float* pBX, const float* pBY, int count, float* pResults);
+	}
+}
+#endif
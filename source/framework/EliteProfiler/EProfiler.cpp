@@ -0,0 +1,180 @@
+#include "stdafx.h"
+#include "EProfiler.h"
+
+#include <iomanip>
+#include <cstring>
+
+Elite::EProfiler::EProfiler()
+	: m_Epoch(std::chrono::high_resolution_clock::now()),
+	m_MainThreadId(std::this_thread::get_id())
+{
+	m_CurrentFrame.reserve(64);
+	m_LastFrame.reserve(64);
+	m_OpenScopes.reserve(16);
+}
+
+void Elite::EProfiler::BeginFrame()
+{
+	m_MainThreadId = std::this_thread::get_id();
+	m_CurrentFrame.clear();
+	m_OpenScopes.clear();
+	m_FrameStartMicroseconds = GetMicroseconds();
+	m_IsRecording = m_FramesToCapture > 0;
+}
+
+void Elite::EProfiler::EndFrame()
+{
+	const double frameEnd = GetMicroseconds();
+	m_LastFrameMilliseconds = (frameEnd - m_FrameStartMicroseconds) / 1000.0;
+	m_LastFrame.swap(m_CurrentFrame);
+	m_CurrentFrame.clear();
+
+	if (!m_IsRecording)
+		return;
+
+	m_TraceEvents.push_back(TraceEvent{ "Frame", m_FrameStartMicroseconds, frameEnd - m_FrameStartMicroseconds });
+	if (--m_FramesToCapture > 0)
+		return;
+
+	if (WriteChromeTrace(m_CaptureFilePath))
+		std::cout << "Profiler: trace written to " << m_CaptureFilePath << std::endl;
+	else
+		std::cout << "Profiler: could not write " << m_CaptureFilePath << std::endl;
+
+	m_TraceEvents.clear();
+	m_TraceEvents.shrink_to_fit();
+	m_IsRecording = false;
+}
+
+void Elite::EProfiler::BeginScope(const char* name)
+{
+	//Scopes on other threads (parallel decision making) would mix up the open scopes of the main thread
+	if (std::this_thread::get_id() != m_MainThreadId)
+		return;
+
+	const int parentIndex = m_OpenScopes.empty() ? -1 : m_OpenScopes.back().statsIndex;
+	const int statsIndex = FindOrAddStats(name, parentIndex);
+	m_OpenScopes.push_back(OpenScope{ statsIndex, GetMicroseconds() });
+}
+
+void Elite::EProfiler::EndScope()
+{
+	//A frame can begin while scopes are open (e.g. the headless runner inside a profiled benchmark), those are dropped
+	if (std::this_thread::get_id() != m_MainThreadId || m_OpenScopes.empty())
+		return;
+
+	const OpenScope scope = m_OpenScopes.back();
+	m_OpenScopes.pop_back();
+
+	const double duration = GetMicroseconds() - scope.startMicroseconds;
+	ScopeStats& stats = m_CurrentFrame[scope.statsIndex];
+	stats.milliseconds += duration / 1000.0;
+	++stats.nrOfCalls;
+
+	if (m_IsRecording)
+		m_TraceEvents.push_back(TraceEvent{ stats.name, scope.startMicroseconds, duration });
+}
+
+void Elite::EProfiler::StartCapture(int nrOfFrames, const std::string& filePath)
+{
+	if (nrOfFrames <= 0 || IsCapturing())
+		return;
+
+	m_FramesToCapture = nrOfFrames;
+	m_CaptureFilePath = filePath;
+	m_TraceEvents.reserve(size_t(nrOfFrames) * 64);
+}
+
+bool Elite::EProfiler::WriteChromeTrace(const std::string& filePath) const
+{
+	std::ofstream file{ filePath };
+	if (!file)
+		return false;
+
+	//Complete events ("X"), the viewer nests them by time so the depth doesn't have to be written
+	file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (size_t eventIndex = 0; eventIndex < m_TraceEvents.size(); ++eventIndex)
+	{
+		const TraceEvent& traceEvent = m_TraceEvents[eventIndex];
+		file << (eventIndex == 0 ? "\n" : ",\n") << "{\"name\":\"";
+		for (const char* pCharacter = traceEvent.name; *pCharacter != '\0'; ++pCharacter)
+		{
+			if (*pCharacter == '"' || *pCharacter == '\\')
+				file << '\\';
+			file << *pCharacter;
+		}
+		file << "\",\"cat\":\"elite\",\"ph\":\"X\",\"ts\":" << traceEvent.startMicroseconds
+			<< ",\"dur\":" << traceEvent.durationMicroseconds << ",\"pid\":1,\"tid\":1}";
+	}
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+void Elite::EProfiler::RenderUI()
+{
+	//Top left and collapsed, the app menus live on the right
+	ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiSetCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(320, 240), ImGuiSetCond_FirstUseEver);
+	ImGui::SetNextWindowCollapsed(true, ImGuiSetCond_FirstUseEver);
+	if (!ImGui::Begin("Profiler"))
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("%.3f ms/frame (profiled)", m_LastFrameMilliseconds);
+	if (IsCapturing())
+		ImGui::Text("Capturing, %d frames left", m_FramesToCapture);
+	else if (ImGui::Button("Capture 120 frames"))
+		StartCapture(120, "profile_trace.json");
+
+	ImGui::Separator();
+	//A child can be added after scopes of another parent, so walk the tree instead of the list
+	const std::function<void(int)> renderChildren = [this, &renderChildren](int parentIndex)
+	{
+		for (int statsIndex = 0; statsIndex < static_cast<int>(m_LastFrame.size()); ++statsIndex)
+		{
+			const ScopeStats& stats = m_LastFrame[statsIndex];
+			if (stats.parentIndex != parentIndex)
+				continue;
+
+			ImGui::Text("%*s%s", stats.depth * 2, "", stats.name);
+			ImGui::SameLine(200);
+			ImGui::Text("%.3f ms", stats.milliseconds);
+			if (stats.nrOfCalls > 1)
+			{
+				ImGui::SameLine();
+				ImGui::Text("x%d", stats.nrOfCalls);
+			}
+			renderChildren(statsIndex);
+		}
+	};
+	renderChildren(-1);
+
+	ImGui::End();
+}
+
+double Elite::EProfiler::GetMicroseconds() const
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - m_Epoch).count();
+}
+
+int Elite::EProfiler::FindOrAddStats(const char* name, int parentIndex)
+{
+	//Few scopes per frame, a linear search is cheaper than hashing. Names are compared by pointer first,
+	//the same literal in different translation units isn't always merged
+	for (int statsIndex = static_cast<int>(m_CurrentFrame.size()) - 1; statsIndex >= 0; --statsIndex)
+	{
+		const ScopeStats& stats = m_CurrentFrame[statsIndex];
+		if (stats.parentIndex == parentIndex && (stats.name == name || std::strcmp(stats.name, name) == 0))
+			return statsIndex;
+	}
+
+	ScopeStats stats{};
+	stats.name = name;
+	stats.parentIndex = parentIndex;
+	stats.depth = parentIndex < 0 ? 0 : m_CurrentFrame[parentIndex].depth + 1;
+	m_CurrentFrame.push_back(stats);
+	return static_cast<int>(m_CurrentFrame.size()) - 1;
+}
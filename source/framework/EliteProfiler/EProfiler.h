@@ -0,0 +1,107 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// EProfiler.h: lightweight hierarchical timing of named scopes, for finding where a frame goes without an external profiler.
+// Scopes are opened with ELITE_PROFILE_SCOPE("Name") and closed at the end of the C++ scope, nested scopes become children.
+// The time per scope is summed per frame (shown in the profiler window), a capture records every scope of a number of
+// frames and writes them as a Chrome trace_event JSON file (open in chrome://tracing or ui.perfetto.dev).
+// Only the thread that runs the frames is recorded, scopes on other threads are ignored. Remove USE_PROFILER in stdafx.h to compile all scopes out.
+/*=============================================================================*/
+#ifndef ELITE_PROFILER
+#define	ELITE_PROFILER
+namespace Elite
+{
+	class EProfiler final : public ESingleton<EProfiler>
+	{
+	public:
+		//Time of one scope in one frame, summed over all the times it was entered with the same parent
+		struct ScopeStats
+		{
+			const char* name = nullptr;
+			int parentIndex = -1;  //Index in the same frame, -1 for the top level scopes
+			int depth = 0;
+			int nrOfCalls = 0;
+			double milliseconds = 0.0;
+		};
+
+		//=== Constructors & Destructors ===
+		EProfiler();
+		~EProfiler() = default;
+
+		//=== Profiler Functions ===
+		void BeginFrame();
+		void EndFrame();
+
+		//Names are not copied, they have to outlive the profiler (string literals, __FUNCTION__)
+		void BeginScope(const char* name);
+		void EndScope();
+
+		//Records every scope of the next whole frames and writes the trace to the file when they are done
+		void StartCapture(int nrOfFrames, const std::string& filePath);
+		bool IsCapturing() const { return m_FramesToCapture > 0; }
+		bool WriteChromeTrace(const std::string& filePath) const;
+
+		const std::vector<ScopeStats>& GetLastFrame() const { return m_LastFrame; }  //Parents come before their children
+		double GetLastFrameMilliseconds() const { return m_LastFrameMilliseconds; }
+
+		void RenderUI();
+
+	private:
+		struct OpenScope
+		{
+			int statsIndex;
+			double startMicroseconds;
+		};
+
+		struct TraceEvent
+		{
+			const char* name;
+			double startMicroseconds;
+			double durationMicroseconds;
+		};
+
+		double GetMicroseconds() const;
+		int FindOrAddStats(const char* name, int parentIndex);
+
+		//=== Datamembers ===
+		std::chrono::high_resolution_clock::time_point m_Epoch;
+		std::thread::id m_MainThreadId;
+		std::vector<ScopeStats> m_CurrentFrame;
+		std::vector<ScopeStats> m_LastFrame;
+		std::vector<OpenScope> m_OpenScopes;
+		double m_FrameStartMicroseconds = 0.0;
+		double m_LastFrameMilliseconds = 0.0;
+
+		std::vector<TraceEvent> m_TraceEvents;
+		std::string m_CaptureFilePath;
+		int m_FramesToCapture = 0;
+		bool m_IsRecording = false;  //Only set on BeginFrame, so a capture never starts halfway a frame
+	};
+
+	//RAII helper behind ELITE_PROFILE_SCOPE
+	class EProfileScope final
+	{
+	public:
+		explicit EProfileScope(const char* name) { EProfiler::GetInstance()->BeginScope(name); }
+		~EProfileScope() { EProfiler::GetInstance()->EndScope(); }
+
+		EProfileScope(const EProfileScope&) = delete;
+		EProfileScope& operator=(const EProfileScope&) = delete;
+	};
+}
+
+#ifdef USE_PROFILER
+	#define ELITE_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define ELITE_PROFILE_CONCAT(a, b) ELITE_PROFILE_CONCAT_IMPL(a, b)
+	#define ELITE_PROFILE_SCOPE(name) Elite::EProfileScope ELITE_PROFILE_CONCAT(profileScope, __LINE__){ name }
+	#define ELITE_PROFILE_FUNCTION() ELITE_PROFILE_SCOPE(__FUNCTION__)
+	#define ELITE_PROFILE_BEGIN_FRAME() Elite::EProfiler::GetInstance()->BeginFrame()
+	#define ELITE_PROFILE_END_FRAME() Elite::EProfiler::GetInstance()->EndFrame()
+#else
+	#define ELITE_PROFILE_SCOPE(name) ((void)0)
+	#define ELITE_PROFILE_FUNCTION() ((void)0)
+	#define ELITE_PROFILE_BEGIN_FRAME() ((void)0)
+	#define ELITE_PROFILE_END_FRAME() ((void)0)
+#endif
+#endif
@@ -22,6 +22,7 @@ namespace Elite
 
 		//--- Functions ---
 		void Initialize(Camera2D* pActiveCamera);
+		void InitializeHeadless(Camera2D* pActiveCamera);
 		void Render();
 		unsigned int LoadShadersToProgram(const char* vertexShaderPath, const char* fragmentShaderPath);
 		unsigned int LoadShadersToProgramFromEmbeddedSource(const char* vertexShader, const char* fragmentShader);
@@ -58,8 +58,29 @@ void SDLDebugRenderer2D::Initialize(Camera2D* pActiveCamera)
 	}
 }
 
+void SDLDebugRenderer2D::InitializeHeadless(Camera2D* pActiveCamera)
+{
+	m_pActiveCamera = pActiveCamera;
+	m_IsHeadless = true;
+
+	int initialSize = 512;
+	m_vPoints.reserve(initialSize);
+	m_vLines.reserve(initialSize);
+	m_vTriangles.reserve(initialSize);
+}
+
 void SDLDebugRenderer2D::Render()
 {
+	ELITE_PROFILE_SCOPE("DebugRenderer2D::Render");
+	if (m_IsHeadless)
+	{
+		m_vTriangles.clear();
+		m_vLines.clear();
+		m_vPoints.clear();
+		m_CurrDepthSlice = DEPTH_SLICE_MAX;
+		return;
+	}
+
 	//Clear color
 	glClear(GL_COLOR_BUFFER_BIT);
 	glClear(GL_DEPTH_BUFFER_BIT);
@@ -134,6 +155,9 @@ void SDLDebugRenderer2D::Shutdown()
 	m_vLines.clear();
 	m_vTriangles.clear();
 
+	if (m_IsHeadless)
+		return;
+
 	glDeleteBuffers(1, m_bufferIDs);
 	glDeleteVertexArrays(1, &m_vaoId);
 	glDeleteProgram(m_programID);
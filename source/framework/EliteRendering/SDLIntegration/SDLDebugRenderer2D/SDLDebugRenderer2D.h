@@ -24,7 +24,9 @@ namespace Elite
 
 		//--- Functions ---
 		void Initialize(Camera2D* pActiveCamera);
+		void InitializeHeadless(Camera2D* pActiveCamera); //Without GL context, draw calls are collected and dropped on Render
 		void Render();
+		bool IsHeadless() const { return m_IsHeadless; }
 		unsigned int LoadShadersToProgram(const char* vertexShaderPath, const char* fragmentShaderPath);
 		unsigned int LoadShadersToProgramFromEmbeddedSource(const char* vertexShader, const char* fragmentShader);
 
@@ -58,6 +60,7 @@ namespace Elite
 		int m_sizeAttribute = 2;
 		unsigned int m_vaoId = 0;
 		unsigned int m_bufferIDs[1] = {};
+		bool m_IsHeadless = false;
 
 		//Functions
 		void Shutdown();
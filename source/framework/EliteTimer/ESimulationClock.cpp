@@ -0,0 +1,52 @@
+#include "stdafx.h"
+#include "ESimulationClock.h"
+
+int Elite::ESimulationClock::Advance(float elapsedTime)
+{
+	m_StepsThisFrame = 0;
+	if (m_IsPaused || elapsedTime <= 0.f)
+		return 0;
+
+	m_Accumulator += elapsedTime;
+
+	//Count the steps instead of subtracting in a loop, the float error doesn't build up over a long frame
+	int nrOfSteps = static_cast<int>(m_Accumulator / m_StepTime);
+	if (nrOfSteps > m_MaxStepsPerFrame)
+	{
+		m_DroppedTime += (nrOfSteps - m_MaxStepsPerFrame) * m_StepTime;
+		nrOfSteps = m_MaxStepsPerFrame;
+		m_Accumulator = std::fmod(m_Accumulator, m_StepTime);
+	}
+	else
+	{
+		m_Accumulator -= nrOfSteps * m_StepTime;
+	}
+
+	//Rounding can leave a tiny bit less than zero or a full step
+	m_Accumulator = Clamp(m_Accumulator, 0.f, m_StepTime);
+	m_Alpha = std::min(m_Accumulator / m_StepTime, 0.9999f);
+
+	m_StepsThisFrame = nrOfSteps;
+	m_TotalSteps += nrOfSteps;
+	return nrOfSteps;
+}
+
+void Elite::ESimulationClock::Reset()
+{
+	m_Accumulator = 0.f;
+	m_Alpha = 0.f;
+	m_DroppedTime = 0.f;
+	m_StepsThisFrame = 0;
+	m_TotalSteps = 0;
+}
+
+void Elite::ESimulationClock::SetUpdateRate(float updateRate)
+{
+	if (updateRate <= 0.f)
+		return;
+
+	//Keep the progress towards the next step, only the length of the step changes
+	m_Accumulator = m_Alpha * (1.f / updateRate);
+	m_UpdateRate = updateRate;
+	m_StepTime = 1.f / updateRate;
+}
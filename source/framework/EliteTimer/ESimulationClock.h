@@ -0,0 +1,58 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// ESimulationClock.h: fixed timestep scheduler for the app simulation (IApp::FixedUpdate), decoupled from the frame rate.
+// The frame time is accumulated and consumed in steps of 1 / updateRate, so the simulation always sees the same deltaT
+// and runs the same amount of steps for the same amount of time, no matter how fast the frames are rendered.
+// The rate can be lower than the frame rate (e.g. AI at 30 Hz), the alpha is the fraction of a step that is left over
+// and can be used to interpolate the rendered state between the last two steps.
+/*=============================================================================*/
+#ifndef ELITE_SIMULATION_CLOCK
+#define	ELITE_SIMULATION_CLOCK
+namespace Elite
+{
+	class ESimulationClock final : public ESingleton<ESimulationClock>
+	{
+	public:
+		//=== Constructors & Destructors ===
+		ESimulationClock() = default;
+		~ESimulationClock() = default;
+
+		//=== Clock Functions ===
+		//Adds the frame time and returns the amount of steps to run this frame (at most the max steps per frame),
+		//time that can't be caught up within that cap is dropped so a slow frame doesn't make the next ones slower
+		int Advance(float elapsedTime);
+		void Reset();
+
+		void SetUpdateRate(float updateRate);  //Steps per second
+		float GetUpdateRate() const { return m_UpdateRate; }
+		float GetStepTime() const { return m_StepTime; }
+
+		void SetMaxStepsPerFrame(int maxStepsPerFrame) { m_MaxStepsPerFrame = std::max(1, maxStepsPerFrame); }
+		int GetMaxStepsPerFrame() const { return m_MaxStepsPerFrame; }
+
+		void SetPaused(bool isPaused) { m_IsPaused = isPaused; }
+		bool IsPaused() const { return m_IsPaused; }
+
+		float GetAlpha() const { return m_Alpha; }  //[0, 1[, progress towards the next step
+		int GetStepsThisFrame() const { return m_StepsThisFrame; }
+		unsigned long long GetTotalSteps() const { return m_TotalSteps; }
+		double GetSimulationTime() const { return double(m_TotalSteps) * m_StepTime; }
+		float GetDroppedTime() const { return m_DroppedTime; }  //Total time lost to the catch-up cap
+
+	private:
+		//=== Datamembers ===
+		float m_UpdateRate = 60.f;
+		float m_StepTime = 1.f / 60.f;
+		int m_MaxStepsPerFrame = 5;
+		bool m_IsPaused = false;
+
+		float m_Accumulator = 0.f;
+		float m_Alpha = 0.f;
+		float m_DroppedTime = 0.f;
+		int m_StepsThisFrame = 0;
+		unsigned long long m_TotalSteps = 0;
+	};
+}
+#endif
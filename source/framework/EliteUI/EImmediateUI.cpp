@@ -12,6 +12,12 @@ GLint Elite::EImmediateUI::m_positionAttribute = 0, Elite::EImmediateUI::m_uvAtt
 
 Elite::EImmediateUI::~EImmediateUI()
 {
+	if (m_IsHeadless)
+	{
+		ImGui::Shutdown();
+		return;
+	}
+
 	//Shutdown
 	glDeleteVertexArrays(1, &m_vaoID);
 	glDeleteBuffers(1, &m_vboID);
@@ -118,6 +124,24 @@ void Elite::EImmediateUI::Initialize(EliteRawWindow pWindow)
 	SetupStyle();
 }
 
+void Elite::EImmediateUI::InitializeHeadless(int width, int height)
+{
+	m_IsHeadless = true;
+
+	//No draw callback, ImGui::Render only finalizes the draw lists
+	ImGuiIO& io = ImGui::GetIO();
+	io.RenderDrawListsFn = nullptr;
+	io.DisplaySize = ImVec2((float)width, (float)height);
+	io.IniFilename = nullptr;
+
+	//The font atlas still has to be built, NewFrame needs the glyphs to lay out the text
+	unsigned char* pixels;
+	int atlasWidth, atlasHeight;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+
+	SetupStyle();
+}
+
 void Elite::EImmediateUI::Render()
 {
 	ImGui::Render();
@@ -303,6 +327,14 @@ void Elite::EImmediateUI::NewFrame(EliteRawWindow pWindow, float deltaTime)
 	ImGui::NewFrame();
 }
 
+void Elite::EImmediateUI::NewFrameHeadless(float deltaTime)
+{
+	ImGuiIO& io = ImGui::GetIO();
+	io.DeltaTime = deltaTime > 0.f ? deltaTime : 1.f / 60.f; //ImGui asserts on a zero time step
+	io.MousePos = ImVec2(-1, -1);
+	ImGui::NewFrame();
+}
+
 bool Elite::EImmediateUI::FocussedOnUI()
 {
 	ImGuiIO& io = ImGui::GetIO();
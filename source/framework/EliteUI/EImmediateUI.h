@@ -21,10 +21,12 @@ namespace Elite
 
 		//--- UI Functions ---
 		void Initialize(EliteRawWindow pWindow);
+		void InitializeHeadless(int width, int height); //No window or GL context, the UI is built every frame but never drawn
 		void Render();
 		void EventProcessing();
 		static void StaticRender(ImDrawData* drawData);
 		void NewFrame(EliteRawWindow pWindow, float deltaTime);
+		void NewFrameHeadless(float deltaTime);
 		bool FocussedOnUI();
 
 	private:
@@ -32,6 +34,7 @@ namespace Elite
 		static float m_sMouseWheel;
 		static bool m_sMousePressed[3];
 		unsigned int m_atlasTextureID = 0;
+		bool m_IsHeadless = false;
 
 		static GLuint m_programID;
 		static GLuint m_vboID, m_vaoID, m_elementsID;
@@ -53,10 +56,12 @@ namespace Elite
 	public:
 		//--- UI Functions ---
 		void Initialize(EliteRawWindow pWindow){};
+		void InitializeHeadless(int width, int height){};
 		void Render(){};
 		void EventProcessing(){};
 		static void StaticRender(ImDrawData* drawData){};
 		void NewFrame(EliteRawWindow pWindow, float deltaTime){};
+		void NewFrameHeadless(float deltaTime){};
 		bool FocussedOnUI() { return false; }
 	};
 #endif
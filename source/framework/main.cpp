@@ -4,17 +4,84 @@
 //-----------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------
+//Standard
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 //Application
 #include "EliteInterfaces/EIApp.h"
 #include "projects/App_Selector.h"
+#include "projects/Movement/SteeringBehaviors/SpacePartitioning/SpatialIndexBenchmark.h"
+#include "framework/EliteHeadless/EHeadlessRunner.h"
+#include "projects/Benchmarks/AIBenchmarkSuite.h"
 
 //Hotfix for genetic algorithms project
 bool gRequestShutdown = false;
 
+//The whole argument has to be a number of at least 1, std::stoi throws on "abc" and accepts "12abc" or "-5"
+static bool ParseCount(const char* pText, int& count)
+{
+	char* pEnd = nullptr;
+	errno = 0;
+	const long value = std::strtol(pText, &pEnd, 10);
+	if (pEnd == pText || *pEnd != '\0' || errno == ERANGE || value < 1 || value > INT_MAX)
+		return false;
+
+	count = static_cast<int>(value);
+	return true;
+}
+
 //Main
 #undef main //Undefine SDL_main as main
 int main(int argc, char* argv[])
 {
+	// Headless benchmark of the spatial structures, no window needed
+	if (argc == 2 && std::string(argv[1]) == "--benchmark-spatial")
+	{
+		SpatialIndexBenchmark::Run(SpatialIndexBenchmark::Settings{}, std::cout);
+		return 0;
+	}
+
+	// Scaling benchmarks of the AI systems, headless as well
+	if (argc >= 2 && std::string(argv[1]) == "--benchmark-ai")
+	{
+		AIBenchmarkSuite::Settings settings{};
+		if (argc >= 3 && std::string(argv[2]) == "json")
+			settings.format = AIBenchmarkSuite::OutputFormat::Json;
+
+		AIBenchmarkSuite::Run(settings, std::cout);
+
+		PHYSICSWORLD->Destroy();
+		DEBUGRENDERER2D->Destroy();
+		INPUTMANAGER->Destroy();
+		SIMULATIONCLOCK->Destroy();
+		PROFILER->Destroy();
+		return 0;
+	}
+
+	// Headless run of the active app, no window, GL or visible UI (build servers), optionally writes a trace of the ticks
+	if (argc >= 2 && std::string(argv[1]) == "--headless")
+	{
+		Elite::EHeadlessRunner::Settings settings{};
+		if (argc >= 3 && !ParseCount(argv[2], settings.nrOfTicks))
+		{
+			std::cerr << "Invalid tick count '" << argv[2] << "'\n"
+				<< "Usage: " << argv[0] << " --headless [nrOfTicks >= 1] [traceFilePath]\n";
+			return 1;
+		}
+		if (argc >= 4)
+			settings.traceFilePath = argv[3];
+
+		Elite::EHeadlessRunner::Run(settings, &App_Selector::CreateApp, std::cout);
+
+		PHYSICSWORLD->Destroy();
+		DEBUGRENDERER2D->Destroy();
+		INPUTMANAGER->Destroy();
+		SIMULATIONCLOCK->Destroy();
+		PROFILER->Destroy();
+		return 0;
+	}
+
 	int x{}, y{};
 	bool runExeWithCoordinates{ argc == 3 };
 
@@ -62,6 +129,7 @@ int main(int argc, char* argv[])
 
 		//Start Timer
 		TIMER->Start();
+		SIMULATIONCLOCK->Reset();
 
 		//Application Creation
 		IApp* myApp = nullptr;
@@ -74,28 +142,55 @@ int main(int argc, char* argv[])
 		//Application Loop
 		while (!pWindow->ShutdownRequested())
 		{
+			ELITE_PROFILE_BEGIN_FRAME();
+
 			//Timer
 			TIMER->Update();
 			auto const elapsed = TIMER->GetElapsed();
 
 			//Window procedure first, to capture all events and input received by the window
-			if (!pImmediateUI->FocussedOnUI())
-				pWindow->ProcedureEWindow();
-			else
-				pImmediateUI->EventProcessing();
+			{
+				ELITE_PROFILE_SCOPE("Events");
+				if (!pImmediateUI->FocussedOnUI())
+					pWindow->ProcedureEWindow();
+				else
+					pImmediateUI->EventProcessing();
 
-			//New frame Immediate UI (Flush)
-			pImmediateUI->NewFrame(pWindow->GetRawWindowHandle(), elapsed);
+				//New frame Immediate UI (Flush)
+				pImmediateUI->NewFrame(pWindow->GetRawWindowHandle(), elapsed);
+			}
 
 			//Update (Physics, App)
 			PHYSICSWORLD->Simulate(elapsed);
 			pCamera->Update();
-			myApp->Update(elapsed);
+			{
+				ELITE_PROFILE_SCOPE("App Update");
+				myApp->Update(elapsed);
+			}
+
+			//Fixed Update (App simulation), independent of the frame rate
+			{
+				ELITE_PROFILE_SCOPE("App FixedUpdate");
+				const int nrOfSteps = SIMULATIONCLOCK->Advance(elapsed);
+				for (int step = 0; step < nrOfSteps; ++step)
+					myApp->FixedUpdate(SIMULATIONCLOCK->GetStepTime());
+			}
 
 			//Render and Present Frame
-			PHYSICSWORLD->RenderDebug();
-			myApp->Render(elapsed);
-			pFrame->SubmitAndFlipFrame(pImmediateUI);
+			{
+				ELITE_PROFILE_SCOPE("App Render");
+				PHYSICSWORLD->RenderDebug();
+				myApp->Render(elapsed);
+			}
+#ifdef USE_PROFILER
+			PROFILER->RenderUI();
+#endif
+			{
+				ELITE_PROFILE_SCOPE("Submit");
+				pFrame->SubmitAndFlipFrame(pImmediateUI);
+			}
+
+			ELITE_PROFILE_END_FRAME();
 		}
 
 		//Reversed Deletion
@@ -110,6 +205,8 @@ int main(int argc, char* argv[])
 		DEBUGRENDERER2D->Destroy();
 		INPUTMANAGER->Destroy();
 		TIMER->Destroy();
+		SIMULATIONCLOCK->Destroy();
+		PROFILER->Destroy();
 	}
 	catch (const Elite_Exception& e)
 	{
@@ -0,0 +1,437 @@
+#include "stdafx.h"
+#include "AIBenchmarkSuite.h"
+
+#include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
+#include "projects/Movement/SteeringBehaviors/Flocking/Flock.h"
+#include "projects/Movement/SteeringBehaviors/CombinedSteering/CombinedSteeringBehaviors.h"
+#include "projects/Shared/NavigationColliderElement.h"
+#include "projects/DecisionMaking/BehaviorTrees/App_AgarioGame_BT.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include "framework/EliteAI/EliteGraphs/EInfluenceMap.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include "framework/EliteAI/EliteNavigation/ENavigation.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/EPathSmoothing.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/ENavGraphPathfinding.h"
+#include "framework/EliteHeadless/EHeadlessRunner.h"
+
+#include <iomanip>
+
+namespace
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	double GetMilliseconds(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	struct Parameter
+	{
+		std::string name;
+		std::string value;
+		bool isText;
+	};
+
+	Parameter Number(const char* name, double value)
+	{
+		std::ostringstream stream{};
+		stream << value;
+		return Parameter{ name, stream.str(), false };
+	}
+
+	Parameter Text(const char* name, const char* value)
+	{
+		return Parameter{ name, value, true };
+	}
+
+	// One case of one system, times are per iteration (frame, query or propagation)
+	struct Record
+	{
+		std::string system;
+		std::vector<Parameter> parameters;
+		int nrOfIterations{};
+		double totalMilliseconds{};
+		double meanMilliseconds{};
+		double medianMilliseconds{};
+		double maxMilliseconds{};
+		std::string metricName;  // Extra number that explains the time, e.g. how many paths were found
+		double metric{};
+	};
+
+	void SetTimes(Record& record, std::vector<double>& samples)
+	{
+		record.nrOfIterations = int(samples.size());
+		if(samples.empty())
+			return;
+
+		std::sort(samples.begin(), samples.end());
+		for(double sample : samples)
+			record.totalMilliseconds += sample;
+		record.meanMilliseconds = record.totalMilliseconds / samples.size();
+		record.medianMilliseconds = samples[samples.size() / 2];
+		record.maxMilliseconds = samples.back();
+	}
+
+	const char* ToString(FlockPartitioning partitioning)
+	{
+		switch(partitioning)
+		{
+		case FlockPartitioning::None: return "none";
+		case FlockPartitioning::CellSpace: return "cells";
+		case FlockPartitioning::QuadCellSpace: return "quad_cells";
+		case FlockPartitioning::SortedCellSpace: return "sorted_cells";
+		case FlockPartitioning::SpatialIndexGrid: return "index_grid";
+		case FlockPartitioning::SpatialIndexQuadTree: return "index_quadtree";
+		case FlockPartitioning::SpatialHash: return "index_hash";
+		}
+		return "";
+	}
+
+	// --- Systems ---
+	// ---------------
+	void RunSteering(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		// One behavior shared by all agents, the batched path needs that
+		Seek seek{};
+		seek.SetTarget(TargetData{ Elite::Vector2{ settings.flockWorldSize / 2.0f, settings.flockWorldSize / 2.0f } });
+		Wander wander{};
+		BlendedSteering blended{ { { &seek, 0.5f }, { &wander, 0.5f } } };
+
+		struct BehaviorCase
+		{
+			const char* name;
+			ISteeringBehavior* pBehavior;
+		};
+		const BehaviorCase behaviorCases[]{ { "seek", &seek }, { "wander", &wander }, { "blended", &blended } };
+
+		for(int nrOfAgents : settings.steeringAgentCounts)
+		{
+			for(const BehaviorCase& behaviorCase : behaviorCases)
+			{
+				for(bool isBatched : { false, true })
+				{
+					// Every case starts from the same agents, without rigidbodies so only the steering is measured
+					srand(settings.seed);
+					std::vector<SteeringAgent*> agents{};
+					agents.reserve(nrOfAgents);
+					for(int agentIndex{}; agentIndex < nrOfAgents; ++agentIndex)
+					{
+						SteeringAgent* pAgent{ new SteeringAgent(1.0f, false) };
+						pAgent->SetPosition(Elite::randomVector2(0.0f, settings.flockWorldSize));
+						pAgent->SetSteeringBehavior(behaviorCase.pBehavior);
+						agents.push_back(pAgent);
+					}
+
+					std::vector<AgentSteeringState> states{};
+					std::vector<SteeringOutput> outputs{};
+					std::vector<double> samples{};
+					samples.reserve(settings.steeringFrames);
+					for(int frame{}; frame < settings.steeringFrames; ++frame)
+					{
+						const Clock::time_point start{ Clock::now() };
+						if(isBatched)
+						{
+							SteeringAgent::UpdateBatch(settings.deltaTime, behaviorCase.pBehavior, agents, states, outputs);
+						}
+						else
+						{
+							for(SteeringAgent* pAgent : agents)
+								pAgent->Update(settings.deltaTime);
+						}
+						samples.push_back(GetMilliseconds(start));
+					}
+
+					for(SteeringAgent* pAgent : agents)
+						SAFE_DELETE(pAgent);
+
+					Record record{ "steering", { Number("agents", nrOfAgents), Text("behavior", behaviorCase.name),
+						Text("path", isBatched ? "batch" : "per_agent") } };
+					SetTimes(record, samples);
+					record.metricName = "agent_updates_per_ms";
+					record.metric = record.totalMilliseconds > 0.0 ? double(nrOfAgents) * record.nrOfIterations / record.totalMilliseconds : 0.0;
+					records.push_back(record);
+				}
+			}
+		}
+	}
+
+	void RunFlock(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		const FlockPartitioning partitionings[]{ FlockPartitioning::None, FlockPartitioning::CellSpace, FlockPartitioning::QuadCellSpace,
+			FlockPartitioning::SortedCellSpace, FlockPartitioning::SpatialIndexGrid, FlockPartitioning::SpatialIndexQuadTree, FlockPartitioning::SpatialHash };
+
+		// Stands still in the middle, the flock evades it like in the app
+		SteeringAgent agentToEvade{ 1.0f, false };
+		agentToEvade.SetPosition(Elite::Vector2{ settings.flockWorldSize / 2.0f, settings.flockWorldSize / 2.0f });
+
+		for(int flockSize : settings.flockSizes)
+		{
+			for(float radius : settings.flockRadii)
+			{
+				for(FlockPartitioning partitioning : partitionings)
+				{
+					// Every case starts from the same flock
+					srand(settings.seed);
+					Flock flock{ flockSize, settings.flockWorldSize, &agentToEvade, true };
+					flock.SetNeighborhoodRadius(radius);
+					flock.SetPartitioning(partitioning);
+					flock.Update(settings.deltaTime);  // Warmup, fills the structures
+
+					std::vector<double> samples{};
+					samples.reserve(settings.flockFrames);
+					for(int frame{}; frame < settings.flockFrames; ++frame)
+					{
+						const Clock::time_point start{ Clock::now() };
+						flock.Update(settings.deltaTime);
+						samples.push_back(GetMilliseconds(start));
+					}
+
+					Record record{ "flock", { Number("agents", flockSize), Number("radius", radius), Text("partitioning", ToString(partitioning)) } };
+					SetTimes(record, samples);
+					record.metricName = "agent_updates_per_ms";
+					record.metric = record.totalMilliseconds > 0.0 ? double(flockSize) * record.nrOfIterations / record.totalMilliseconds : 0.0;
+					records.push_back(record);
+				}
+			}
+		}
+	}
+
+	void RunAStar(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		using Grid = Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>;
+
+		for(int gridSize : settings.gridSizes)
+		{
+			for(float density : settings.obstacleDensities)
+			{
+				std::mt19937 generator{ settings.seed };
+				std::uniform_real_distribution<float> chance{ 0.0f, 1.0f };
+
+				// Same setup as the app, obstacles are water nodes without connections
+				Grid grid{ gridSize, gridSize, 5, false, true, 1.f, 1.5f };
+				std::vector<int> freeNodes{};
+				for(int nodeIndex{}; nodeIndex < gridSize * gridSize; ++nodeIndex)
+				{
+					if(chance(generator) >= density)
+					{
+						freeNodes.push_back(nodeIndex);
+						continue;
+					}
+					grid.GetNode(nodeIndex)->SetTerrainType(TerrainType::Water);
+					grid.RemoveConnectionsToAdjacentNodes(nodeIndex);
+				}
+
+				// Picked from the free nodes, a density of 1 leaves none and then there are no queries
+				const int nrOfPathQueries{ freeNodes.empty() ? 0 : settings.nrOfPathQueries };
+				std::uniform_int_distribution<int> freeNodeDistribution{ 0, std::max(int(freeNodes.size()) - 1, 0) };
+				const auto getFreeNode = [&]()
+				{
+					return grid.GetNode(freeNodes[freeNodeDistribution(generator)]);
+				};
+
+				Elite::AStar<Elite::GridTerrainNode, Elite::GraphConnection> pathfinder{ &grid, Elite::HeuristicFunctions::Octile };
+
+				std::vector<double> samples{};
+				samples.reserve(nrOfPathQueries);
+				int nrOfPathsFound{};
+				for(int query{}; query < nrOfPathQueries; ++query)
+				{
+					Elite::GridTerrainNode* pStart{ getFreeNode() };
+					Elite::GridTerrainNode* pGoal{ getFreeNode() };
+
+					const Clock::time_point start{ Clock::now() };
+					const std::vector<Elite::GridTerrainNode*> path{ pathfinder.FindPath(pStart, pGoal) };
+					samples.push_back(GetMilliseconds(start));
+					nrOfPathsFound += !path.empty();
+				}
+
+				Record record{ "astar_grid", { Number("grid_size", gridSize), Number("obstacle_density", density) } };
+				SetTimes(record, samples);
+				record.metricName = "paths_found";
+				record.metric = nrOfPathsFound;
+				records.push_back(record);
+			}
+		}
+	}
+
+	void RunNavMesh(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		const float spacing{ 12.0f };
+		const float colliderSize{ 4.0f };
+		const float agentRadius{ 1.0f };
+
+		for(int nrOfColliders : settings.colliderCounts)
+		{
+			// Colliders on a grid with room for the agent around each of them
+			const int nrOfColumns{ int(std::ceil(std::sqrt(float(nrOfColliders)))) };
+			const float halfSize{ nrOfColumns * spacing / 2.0f };
+
+			std::vector<NavigationColliderElement*> colliders{};
+			for(int colliderIndex{}; colliderIndex < nrOfColliders; ++colliderIndex)
+			{
+				const Elite::Vector2 position{ (colliderIndex % nrOfColumns + 0.5f) * spacing - halfSize, (colliderIndex / nrOfColumns + 0.5f) * spacing - halfSize };
+				colliders.push_back(new NavigationColliderElement(position, colliderSize, colliderSize));
+			}
+
+			std::list<Elite::Vector2> baseBox{ { -halfSize, halfSize },{ -halfSize, -halfSize },{ halfSize, -halfSize },{ halfSize, halfSize } };
+
+			std::vector<double> buildSamples{};
+			Clock::time_point start{ Clock::now() };
+			Elite::NavGraph* pNavGraph{ new Elite::NavGraph(Elite::Polygon(baseBox), agentRadius) };
+			buildSamples.push_back(GetMilliseconds(start));
+
+			Record buildRecord{ "navmesh_build", { Number("colliders", nrOfColliders) } };
+			SetTimes(buildRecord, buildSamples);
+			buildRecord.metricName = "nodes";
+			buildRecord.metric = pNavGraph->GetNrOfActiveNodes();
+			records.push_back(buildRecord);
+
+			std::mt19937 generator{ settings.seed };
+			std::uniform_real_distribution<float> coordinate{ -halfSize, halfSize };
+			std::vector<Elite::Vector2> debugNodePositions{};
+			std::vector<Elite::Portal> debugPortals{};
+
+			std::vector<double> samples{};
+			samples.reserve(settings.nrOfNavMeshQueries);
+			int nrOfPathsFound{};
+			for(int query{}; query < settings.nrOfNavMeshQueries; ++query)
+			{
+				const Elite::Vector2 startPosition{ coordinate(generator), coordinate(generator) };
+				const Elite::Vector2 endPosition{ coordinate(generator), coordinate(generator) };
+
+				start = Clock::now();
+				const std::vector<Elite::Vector2> path{ Elite::NavMeshPathfinding::FindPath(startPosition, endPosition, pNavGraph, debugNodePositions, debugPortals) };
+				samples.push_back(GetMilliseconds(start));
+				nrOfPathsFound += !path.empty();
+			}
+
+			Record record{ "navmesh_path", { Number("colliders", nrOfColliders) } };
+			SetTimes(record, samples);
+			record.metricName = "paths_found";
+			record.metric = nrOfPathsFound;
+			records.push_back(record);
+
+			SAFE_DELETE(pNavGraph);
+			for(NavigationColliderElement* pCollider : colliders)
+				SAFE_DELETE(pCollider);
+		}
+	}
+
+	void RunInfluenceMap(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		using InfluenceGrid = Elite::GridGraph<Elite::InfluenceNode, Elite::GraphConnection>;
+
+		for(int gridSize : settings.influenceGridSizes)
+		{
+			Elite::InfluenceMap<InfluenceGrid> influenceMap{ false };
+			influenceMap.InitializeGrid(gridSize, gridSize, 5, false, true);
+			influenceMap.InitializeBuffer();
+			influenceMap.SetPropagationInterval(0.0f);  // Propagate on every call
+
+			// A few sources of both signs, like agents and food
+			std::mt19937 generator{ settings.seed };
+			std::uniform_int_distribution<int> nodeDistribution{ 0, gridSize * gridSize - 1 };
+			for(int source{}; source < 8; ++source)
+				influenceMap.GetNode(nodeDistribution(generator))->SetInfluence(source % 2 == 0 ? 100.0f : -100.0f);
+
+			std::vector<double> samples{};
+			samples.reserve(settings.nrOfPropagations);
+			for(int propagation{}; propagation < settings.nrOfPropagations; ++propagation)
+			{
+				const Clock::time_point start{ Clock::now() };
+				influenceMap.PropagateInfluence(settings.deltaTime);
+				samples.push_back(GetMilliseconds(start));
+			}
+
+			Record record{ "influence_map", { Number("grid_size", gridSize) } };
+			SetTimes(record, samples);
+			record.metricName = "nodes_per_ms";
+			record.metric = record.totalMilliseconds > 0.0 ? double(gridSize) * gridSize * record.nrOfIterations / record.totalMilliseconds : 0.0;
+			records.push_back(record);
+		}
+	}
+
+	void RunAgarioBehaviorTree(const AIBenchmarkSuite::Settings& settings, std::vector<Record>& records)
+	{
+		Elite::EHeadlessRunner::Settings runnerSettings{};
+		runnerSettings.nrOfTicks = settings.agarioFrames;
+		runnerSettings.deltaTime = settings.deltaTime;
+
+		for(int nrOfAgents : settings.agarioAgentCounts)
+		{
+			srand(settings.seed);
+			std::ostringstream runnerOutput{};  // The suite writes its own report
+			const Elite::EHeadlessRunner::Result result{ Elite::EHeadlessRunner::Run(runnerSettings,
+				[nrOfAgents]() -> IApp* { return new App_AgarioGame_BT(nrOfAgents); }, runnerOutput) };
+
+			Record record{ "agario_bt", { Number("agents", nrOfAgents) } };
+			record.nrOfIterations = result.nrOfTicks;
+			record.totalMilliseconds = result.totalMilliseconds;
+			record.meanMilliseconds = result.averageMilliseconds;
+			record.medianMilliseconds = result.medianMilliseconds;
+			record.maxMilliseconds = result.maxMilliseconds;
+			record.metricName = "start_ms";
+			record.metric = result.startMilliseconds;
+			records.push_back(record);
+		}
+	}
+
+	// --- Output ---
+	// --------------
+	void WriteCsv(const std::vector<Record>& records, std::ostream& output)
+	{
+		output << "system,parameters,iterations,total_ms,mean_ms,median_ms,max_ms,metric,metric_value\n";
+		output << std::fixed << std::setprecision(4);
+		for(const Record& record : records)
+		{
+			output << record.system << ",";
+			for(size_t parameterIndex{}; parameterIndex < record.parameters.size(); ++parameterIndex)
+			{
+				const Parameter& parameter{ record.parameters[parameterIndex] };
+				output << (parameterIndex > 0 ? ";" : "") << parameter.name << "=" << parameter.value;
+			}
+			output << "," << record.nrOfIterations << "," << record.totalMilliseconds << "," << record.meanMilliseconds
+				<< "," << record.medianMilliseconds << "," << record.maxMilliseconds << "," << record.metricName << "," << record.metric << "\n";
+		}
+	}
+
+	void WriteJson(const std::vector<Record>& records, std::ostream& output)
+	{
+		// Names and values are plain identifiers and numbers, nothing needs escaping
+		output << "[\n" << std::fixed << std::setprecision(4);
+		for(size_t recordIndex{}; recordIndex < records.size(); ++recordIndex)
+		{
+			const Record& record{ records[recordIndex] };
+			output << "  { \"system\": \"" << record.system << "\", \"parameters\": { ";
+			for(size_t parameterIndex{}; parameterIndex < record.parameters.size(); ++parameterIndex)
+			{
+				const Parameter& parameter{ record.parameters[parameterIndex] };
+				const char* quote{ parameter.isText ? "\"" : "" };
+				output << (parameterIndex > 0 ? ", " : "") << "\"" << parameter.name << "\": " << quote << parameter.value << quote;
+			}
+			output << " }, \"iterations\": " << record.nrOfIterations << ", \"total_ms\": " << record.totalMilliseconds
+				<< ", \"mean_ms\": " << record.meanMilliseconds << ", \"median_ms\": " << record.medianMilliseconds
+				<< ", \"max_ms\": " << record.maxMilliseconds << ", \"" << record.metricName << "\": " << record.metric << " }"
+				<< (recordIndex + 1 < records.size() ? "," : "") << "\n";
+		}
+		output << "]\n";
+	}
+}
+
+void AIBenchmarkSuite::Run(const Settings& settings, std::ostream& output)
+{
+	PHYSICSWORLD; //Boot, the navmesh colliders and the agario agents are rigidbodies
+
+	std::vector<Record> records{};
+	RunSteering(settings, records);
+	RunFlock(settings, records);
+	RunAStar(settings, records);
+	RunNavMesh(settings, records);
+	RunInfluenceMap(settings, records);
+	RunAgarioBehaviorTree(settings, records);
+
+	if(settings.format == OutputFormat::Json)
+		WriteJson(records, output);
+	else
+		WriteCsv(records, output);
+}
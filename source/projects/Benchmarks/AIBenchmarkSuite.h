@@ -0,0 +1,58 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// AIBenchmarkSuite.h: Scaling benchmarks of the AI systems, every system is run for a range of sizes
+// (steering per agent vs batched, flock agents and partitioning, A* grid size and obstacles, navmesh colliders, influence map size, BT agario agents).
+// Runs headless and writes one record per case as CSV or JSON, run the executable with --benchmark-ai [csv|json].
+/*=============================================================================*/
+
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace AIBenchmarkSuite
+{
+	enum class OutputFormat
+	{
+		Csv,
+		Json
+	};
+
+	struct Settings
+	{
+		// Steering behaviors without neighbors, every agent count is run per agent and batched
+		std::vector<int> steeringAgentCounts{ 1000, 10000, 50000 };
+		int steeringFrames{ 60 };
+
+		// Flock, every combination is run
+		std::vector<int> flockSizes{ 500, 2000, 8000 };
+		std::vector<float> flockRadii{ 5.0f, 10.0f };
+		float flockWorldSize{ 500.0f };
+		int flockFrames{ 60 };
+
+		// A* on a grid graph, square grids
+		std::vector<int> gridSizes{ 32, 64, 128 };
+		std::vector<float> obstacleDensities{ 0.0f, 0.2f };
+		int nrOfPathQueries{ 20 };
+
+		// Navmesh pathfinding, colliders are laid out on a grid
+		std::vector<int> colliderCounts{ 4, 16, 64 };
+		int nrOfNavMeshQueries{ 50 };
+
+		// Influence map propagation, square grids
+		std::vector<int> influenceGridSizes{ 32, 64, 128 };
+		int nrOfPropagations{ 100 };
+
+		// Behavior tree agario, runs the whole app headless
+		std::vector<int> agarioAgentCounts{ 20, 100, 400 };
+		int agarioFrames{ 300 };
+
+		float deltaTime{ 1.0f / 60.0f };
+		unsigned int seed{ 1337 };
+		OutputFormat format{ OutputFormat::Csv };
+	};
+
+	void Run(const Settings& settings, std::ostream& output);
+}
@@ -8,7 +8,8 @@
 #include "projects/Shared/NavigationColliderElement.h"
 
 using namespace Elite;
-App_AgarioGame_BT::App_AgarioGame_BT()
+App_AgarioGame_BT::App_AgarioGame_BT(int amountOfAgents)
+	: m_AmountOfAgents{ amountOfAgents }
 {
 }
 
@@ -32,6 +33,9 @@ App_AgarioGame_BT::~App_AgarioGame_BT()
 		SAFE_DELETE(pNC);
 	m_vNavigationColliders.clear();
 	SAFE_DELETE(m_pContactListener);
+	SAFE_DELETE(m_pAgentBatch);  //After the agents, their trees are in it
+	SAFE_DELETE(m_pDecisionWorkers);
+	SAFE_DELETE(m_pAgentBehavior);  //After the agents, their trees run it
 }
 
 void App_AgarioGame_BT::Start()
@@ -59,6 +63,25 @@ void App_AgarioGame_BT::Start()
 		m_pFoodVec.push_back(new AgarioFood(randomPos));
 	}
 
+	//Create the tree of the agents once, every agent only gets its own state
+	//m_pAgentBehavior = new BehaviorTreeDefinition(new BehaviorAction(BT_Actions::ChangeToWander));
+	m_pAgentBehavior = new BehaviorTreeDefinition(
+		new BehaviorSelector(
+			{
+				new BehaviorSequence(
+				{
+					new BehaviorConditional(BT_Conditions::IsFoodNearby, { AgarioKeys::NearbyFood }),
+					new BehaviorAction(BT_Actions::ChangeToSeek)
+				}),
+				new BehaviorAction(BT_Actions::ChangeToWander)
+			}
+	));
+
+	//The trees of the agents are updated together, node by node over all blackboards
+	m_pAgentBatch = new BehaviorTreeBatch(m_pAgentBehavior);
+	m_pDecisionWorkers = new DecisionWorkers();
+	m_DecisionMakingScheduler.SetTimeBudget(m_DecisionMakingBudget);
+
 	//Create agents
 	m_pAgentVec.reserve(m_AmountOfAgents);
 	for (int i = 0; i < m_AmountOfAgents; i++)
@@ -70,21 +93,14 @@ void App_AgarioGame_BT::Start()
 		Blackboard* pBlackboard = CreateBlackboard(newAgent);
 
 		//2. Create BehaviorTree
-		//BehaviorTree* pBehaviorTree = new BehaviorTree(pBlackboard, new BehaviorAction(BT_Actions::ChangeToWander));
-		BehaviorTree* pBehaviorTree = new BehaviorTree(pBlackboard,
-			new BehaviorSelector(
-				{
-					new BehaviorSequence(
-					{
-						new BehaviorConditional(BT_Conditions::IsFoodNearby),
-						new BehaviorAction(BT_Actions::ChangeToSeek)
-					}),
-					new BehaviorAction(BT_Actions::ChangeToWander)
-				}
-		));
-
-		//3. Set the BehaviorTree active on the agent 
-		newAgent->SetDecisionMaking(pBehaviorTree);
+		BehaviorTree* pBehaviorTree = new BehaviorTree(pBlackboard, m_pAgentBehavior);
+		//Only evaluated again when the nearby food changes (see PublishNearbyKeys), the refresh is a fallback
+		pBehaviorTree->SetEventDriven(true, m_DecisionRefreshInterval);
+		m_pAgentBatch->AddTree(pBehaviorTree);
+
+		//3. Set the BehaviorTree active on the agent, on the turns the scheduler gives it
+		newAgent->SetDecisionMaking(new ScheduledDecisionMaking(pBehaviorTree, &m_DecisionMakingScheduler,
+			[newAgent]() { return newAgent->GetPosition(); }));
 		m_pAgentVec.push_back(newAgent);
 	}
 
@@ -107,18 +123,18 @@ void App_AgarioGame_BT::Start()
 			new BehaviorSequence({
 				new BehaviorSelector({
 					new BehaviorSequence({
-						new BehaviorConditional(BT_Conditions::IsBiggerAgentNearby),
+						new BehaviorConditional(BT_Conditions::IsBiggerAgentNearby, { AgarioKeys::NearbyBiggerAgent }),
 						new BehaviorAction(BT_Actions::ChangeToFlee)
 					}),
 					new BehaviorSequence({
-						new BehaviorConditional(BT_Conditions::IsSmallerAgentNearby),
+						new BehaviorConditional(BT_Conditions::IsSmallerAgentNearby, { AgarioKeys::NearbySmallerAgent }),
 						new BehaviorAction(BT_Actions::ChangeToSeek)
 					})
 				})
 			}),
 			new BehaviorSequence(
 			{
-				new BehaviorConditional(BT_Conditions::IsFoodNearby),
+				new BehaviorConditional(BT_Conditions::IsFoodNearby, { AgarioKeys::NearbyFood }),
 				new BehaviorAction(BT_Actions::ChangeToSeek)
 			}),
 			new BehaviorAction(BT_Actions::ChangeToWander)
@@ -126,6 +142,8 @@ void App_AgarioGame_BT::Start()
 	));
 
 	//3. Set the BehaviorTree active on the agent 
+	m_pSmartBlackboard = pBlackboard;
+	PublishNearbyKeys();
 	m_pSmartAgent->SetDecisionMaking(pBehaviorTree);
 	m_pSmartAgent->SetRenderBehavior(true);
 	//m_pAgentVec.push_back(m_pSmartAgent);
@@ -145,9 +163,15 @@ void App_AgarioGame_BT::Update(float deltaTime)
 	//Update the custom agent
 	m_pSmartAgent->Update(deltaTime);
 
-	//Update the other agents and food
+	//Update the other agents and food, the trees of the agents whose turn it is run together after
+	m_DecisionMakingScheduler.BeginFrame(m_pSmartAgent->GetPosition());
 	UpdateAgarioEntities(m_pFoodVec, deltaTime);
 	UpdateAgarioEntities(m_pAgentVec, deltaTime);
+	PublishNearbyKeys();
+	{
+		DecisionMakingScheduler::TimeScope timeScope{ m_DecisionMakingScheduler };
+		m_pAgentBatch->Update(m_pDecisionWorkers);  //Nothing else runs meanwhile, the world stays as it is
+	}
 
 
 	//Check if we need to spawn new food
@@ -178,18 +202,56 @@ void App_AgarioGame_BT::Render(float deltaTime) const
 
 Blackboard* App_AgarioGame_BT::CreateBlackboard(AgarioAgent* a)
 {
-	Elite::Blackboard* pBlackboard = new Elite::Blackboard();
-	pBlackboard->AddData("Agent", a);
-	pBlackboard->AddData("AgentsVec", &m_pAgentVec);
-	pBlackboard->AddData("FoodVec", &m_pFoodVec);
-	pBlackboard->AddData("WorldSize", m_TrimWorldSize);
-	pBlackboard->AddData("Target", Elite::Vector2{});
-	pBlackboard->AddData("AgentFleeTarget", static_cast<AgarioAgent*>(nullptr)); // Needs the cast for the type
-	pBlackboard->AddData("Time", 0.0f);
+	// One layout for every agent, each blackboard is then a single allocation
+	if (m_BlackboardSchema.GetNrOfFields() == 0)
+	{
+		m_BlackboardSchema.AddField(AgarioKeys::Agent);
+		m_BlackboardSchema.AddField(AgarioKeys::AgentsVec);
+		m_BlackboardSchema.AddField(AgarioKeys::FoodVec);
+		m_BlackboardSchema.AddField(AgarioKeys::WorldSize);
+		m_BlackboardSchema.AddField(AgarioKeys::Target);
+		m_BlackboardSchema.AddField(AgarioKeys::AgentFleeTarget);
+		m_BlackboardSchema.AddField(AgarioKeys::Time);
+		m_BlackboardSchema.AddField(AgarioKeys::NearbyFood);
+		m_BlackboardSchema.AddField(AgarioKeys::NearbyBiggerAgent);
+		m_BlackboardSchema.AddField(AgarioKeys::NearbySmallerAgent);
+	}
+
+	Elite::Blackboard* pBlackboard = new Elite::Blackboard(&m_BlackboardSchema);
+	pBlackboard->AddData(AgarioKeys::Agent, a);
+	pBlackboard->AddData(AgarioKeys::AgentsVec, &m_pAgentVec);
+	pBlackboard->AddData(AgarioKeys::FoodVec, &m_pFoodVec);
+	pBlackboard->AddData(AgarioKeys::WorldSize, m_TrimWorldSize);
+	pBlackboard->AddData(AgarioKeys::Target, Elite::Vector2{});
+	pBlackboard->AddData(AgarioKeys::AgentFleeTarget, nullptr);
+	pBlackboard->AddData(AgarioKeys::Time, 0.0f);
+	pBlackboard->AddData(AgarioKeys::NearbyFood, nullptr);
+	pBlackboard->AddData(AgarioKeys::NearbyBiggerAgent, nullptr);
+	pBlackboard->AddData(AgarioKeys::NearbySmallerAgent, nullptr);
 
 	return pBlackboard;
 }
 
+void App_AgarioGame_BT::PublishNearbyKeys()
+{
+	//Finding the same food or agent again leaves the blackboard as it is, so the trees only see real changes
+	const auto publish = [this](Blackboard* pBlackboard)
+	{
+		AgarioAgent* pAgent = nullptr;
+		if (!pBlackboard->GetData(AgarioKeys::Agent, pAgent) || pAgent == nullptr)
+			return;
+
+		pBlackboard->ChangeData(AgarioKeys::NearbyFood, BT_Queries::FindNearbyFood(pAgent, m_pFoodVec));
+		pBlackboard->ChangeData(AgarioKeys::NearbyBiggerAgent, BT_Queries::FindBiggerAgentNearby(pAgent, m_pAgentVec));
+		pBlackboard->ChangeData(AgarioKeys::NearbySmallerAgent, BT_Queries::FindSmallerAgentNearby(pAgent, m_pAgentVec));
+	};
+
+	for (BehaviorTree* pTree : m_pAgentBatch->GetTrees())
+		publish(pTree->GetBlackboard());
+	if (m_pSmartBlackboard != nullptr)
+		publish(m_pSmartBlackboard);
+}
+
 void App_AgarioGame_BT::UpdateImGui()
 {
 	//------- UI --------
@@ -221,6 +283,9 @@ void App_AgarioGame_BT::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("AI: %.3f ms", m_DecisionMakingScheduler.GetMilliseconds());
+		ImGui::Text("%d updates", m_DecisionMakingScheduler.GetNrOfUpdates());
+		ImGui::Text("%d deferred", m_DecisionMakingScheduler.GetNrOfDeferred());
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -7,6 +7,7 @@
 #include "projects/Shared/Agario/AgarioFood.h"
 #include "projects/Shared/Agario/AgarioAgent.h"
 #include "projects/Shared/Agario/AgarioContactListener.h"
+#include "projects/Movement/SteeringBehaviors/SpacePartitioning/SpatialIndex.h"
 
 
 using namespace Elite;
@@ -33,6 +34,9 @@ App_AgarioGame::~App_AgarioGame()
 
 	SAFE_DELETE(m_pContactListener);
 	SAFE_DELETE(m_pSmartAgent);
+	SAFE_DELETE(m_pFoodIndex);
+	SAFE_DELETE(m_pAgentIndex);
+	SAFE_DELETE(m_pDecisionWorkers);
 	for (auto& s : m_pStates)
 	{
 		SAFE_DELETE(s);
@@ -50,6 +54,10 @@ void App_AgarioGame::Start()
 	//Creating the world contact listener that informs us of collisions
 	m_pContactListener = new AgarioContactListener();
 
+	//Spatial indices for the food and agent lookups of the conditions, the world is small so a grid is enough
+	m_pFoodIndex = CreateSpatialIndex(SpatialIndexType::Grid, m_TrimWorldSize, 10.0f);
+	m_pAgentIndex = CreateSpatialIndex(SpatialIndexType::Grid, m_TrimWorldSize, 10.0f);
+
 	//Create food items
 	m_pFoodVec.reserve(m_AmountOfFood);
 	for (int i = 0; i < m_AmountOfFood; i++)
@@ -62,7 +70,12 @@ void App_AgarioGame::Start()
 	WanderState* pWanderState = new WanderState();
 	m_pStates.push_back(pWanderState);
 
+	//The default agents only wander, they all run one machine with their own current state
+	m_AgentMachine.AddState(pWanderState);
+
 	//Create default agents
+	m_DecisionMakingScheduler.SetTimeBudget(m_DecisionMakingBudget);
+	m_pDecisionWorkers = new DecisionWorkers();
 	m_pAgentVec.reserve(m_AmountOfAgents);
 	for (int i = 0; i < m_AmountOfAgents; i++)
 	{
@@ -71,8 +84,9 @@ void App_AgarioGame::Start()
 
 		Blackboard* pBlackBoard = CreateBlackboard(newAgent);
 
-		FiniteStateMachine* pStateMachine = new FiniteStateMachine(pWanderState, pBlackBoard);
-		newAgent->SetDecisionMaking(pStateMachine);
+		FiniteStateMachine* pStateMachine = new FiniteStateMachine(&m_AgentMachine, pWanderState, pBlackBoard);
+		newAgent->SetDecisionMaking(new ScheduledDecisionMaking(new GroupedDecisionMaking(pStateMachine, &m_DecisionMakingGroup), &m_DecisionMakingScheduler,
+			[newAgent]() { return newAgent->GetPosition(); }));
 
 		m_pAgentVec.push_back(newAgent);
 	}
@@ -129,6 +143,7 @@ void App_AgarioGame::Start()
 void App_AgarioGame::Update(float deltaTime)
 {
 	UpdateImGui();
+	m_DecisionMakingScheduler.BeginFrame(m_pSmartAgent->GetPosition());
 
 	//Check if agent is still alive
 	if (m_pSmartAgent->CanBeDestroyed())
@@ -140,6 +155,16 @@ void App_AgarioGame::Update(float deltaTime)
 		UpdateAgarioEntities(m_pAgentVec, deltaTime);
 		return;
 	}
+
+	//Decision making looks up food and agents through the indices, so they need this frames vectors
+	RebuildSpatialIndices();
+
+	//The machines of the agents whose turn it was last frame, the indices match the vectors and nothing else runs meanwhile
+	{
+		DecisionMakingScheduler::TimeScope timeScope{ m_DecisionMakingScheduler };
+		m_DecisionMakingGroup.Update(m_pDecisionWorkers);
+	}
+
 	//Update the custom agent
 	m_pSmartAgent->Update(deltaTime);
 	m_pSmartAgent->TrimToWorld(m_TrimWorldSize, false);
@@ -177,16 +202,45 @@ void App_AgarioGame::Render(float deltaTime) const
 
 Blackboard* App_AgarioGame::CreateBlackboard(AgarioAgent* a)
 {
-	Blackboard* pBlackboard = new Blackboard();
-	pBlackboard->AddData("AgentPtr", a);
-	pBlackboard->AddData("FoodVecPtr", &m_pFoodVec);
-	pBlackboard->AddData("FoodPtr", static_cast<AgarioFood*>(nullptr));
-	pBlackboard->AddData("AgentVecPtr", &m_pAgentVec);  // List of all agents, to check for bigger agents
-	pBlackboard->AddData("FleeAgentPtr", static_cast<AgarioAgent*>(nullptr));  // Pointer to the agent that is bigger than the current agent and we evade
+	// One layout for every agent, each blackboard is then a single allocation
+	if (m_BlackboardSchema.GetNrOfFields() == 0)
+	{
+		m_BlackboardSchema.AddField(AgarioKeys::AgentPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::FoodVecPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::FoodPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::AgentVecPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::FleeAgentPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::FoodIndexPtr);
+		m_BlackboardSchema.AddField(AgarioKeys::AgentIndexPtr);
+	}
+
+	Blackboard* pBlackboard = new Blackboard(&m_BlackboardSchema);
+	pBlackboard->AddData(AgarioKeys::AgentPtr, a);
+	pBlackboard->AddData(AgarioKeys::FoodVecPtr, &m_pFoodVec);
+	pBlackboard->AddData(AgarioKeys::FoodPtr, nullptr);
+	pBlackboard->AddData(AgarioKeys::AgentVecPtr, &m_pAgentVec);
+	pBlackboard->AddData(AgarioKeys::FleeAgentPtr, nullptr);
+	pBlackboard->AddData(AgarioKeys::FoodIndexPtr, m_pFoodIndex);
+	pBlackboard->AddData(AgarioKeys::AgentIndexPtr, m_pAgentIndex);
 
 	return pBlackboard;
 }
 
+void App_AgarioGame::RebuildSpatialIndices()
+{
+	m_pFoodIndex->Clear();
+	for (int foodIndex{}; foodIndex < int(m_pFoodVec.size()); ++foodIndex)
+	{
+		m_pFoodIndex->Insert(foodIndex, m_pFoodVec[foodIndex]->GetPosition());
+	}
+
+	m_pAgentIndex->Clear();
+	for (int agentIndex{}; agentIndex < int(m_pAgentVec.size()); ++agentIndex)
+	{
+		m_pAgentIndex->Insert(agentIndex, m_pAgentVec[agentIndex]->GetPosition());
+	}
+}
+
 void App_AgarioGame::UpdateImGui()
 {
 	//------- UI --------
@@ -218,6 +272,9 @@ void App_AgarioGame::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("AI: %.3f ms", m_DecisionMakingScheduler.GetMilliseconds());
+		ImGui::Text("%d updates", m_DecisionMakingScheduler.GetNrOfUpdates());
+		ImGui::Text("%d deferred", m_DecisionMakingScheduler.GetNrOfDeferred());
 		ImGui::Unindent();
 
 		ImGui::Spacing();
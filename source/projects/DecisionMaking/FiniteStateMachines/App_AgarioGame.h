@@ -8,6 +8,7 @@
 class AgarioFood;
 class AgarioAgent;
 class AgarioContactListener;
+class ISpatialIndex;
 
 class App_AgarioGame final : public IApp
 {
@@ -22,8 +23,14 @@ private:
 	float m_TrimWorldSize = 100.f;
 	const int m_AmountOfAgents{ 30 };
 	std::vector<AgarioAgent*> m_pAgentVec{};
+	Elite::BlackboardSchema m_BlackboardSchema{};  // Shared by the blackboards of all agents
 
 	AgarioAgent* m_pSmartAgent = nullptr;
+	Elite::FiniteStateMachineDefinition m_AgentMachine{};  // Shared by all agents except the smart one
+	Elite::DecisionMakingScheduler m_DecisionMakingScheduler{};  // Fewer updates for agents far from the smart agent
+	const float m_DecisionMakingBudget{ 1.f };  // Milliseconds per frame
+	Elite::DecisionMakingGroup m_DecisionMakingGroup{};  // The machines of all agents except the smart one, run together
+	Elite::DecisionWorkers* m_pDecisionWorkers = nullptr;  // Runs the group on all cores
 
 	const int m_AmountOfFood{ 40 };
 	const float m_FoodSpawnDelay{ 2.f };
@@ -36,11 +43,16 @@ private:
 	std::vector<Elite::FSMState*> m_pStates{};
 	std::vector<Elite::FSMCondition*> m_pConditions{};
 
+	// Rebuilt every frame, ids are the indices in m_pFoodVec / m_pAgentVec
+	ISpatialIndex* m_pFoodIndex = nullptr;
+	ISpatialIndex* m_pAgentIndex = nullptr;
+
 private:	
 	template<class T_AgarioType>
 	void UpdateAgarioEntities(std::vector<T_AgarioType*>& entities, float deltaTime);
 
 	Elite::Blackboard* CreateBlackboard(AgarioAgent* a);
+	void RebuildSpatialIndices();
 	void UpdateImGui();
 private:
 	//C++ make the class non-copyable
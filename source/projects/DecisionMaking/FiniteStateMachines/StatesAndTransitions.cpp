@@ -16,13 +16,14 @@ void FSMStates::WanderState::OnEnter(Elite::Blackboard* pBlackboard)
 
 	AgarioAgent* pAgent;
 
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
 	{
 		return;
 	}
 	assert(pAgent != nullptr);
 
-	pAgent->SetToWander();
+	//States can be entered in parallel, the agent only changes once all decisions are made
+	DecisionCommandBuffer::Submit([pAgent]() { pAgent->SetToWander(); });
 
 }
 
@@ -32,16 +33,17 @@ void FSMStates::SeekFoodState::OnEnter(Elite::Blackboard* pBlackboard)
 
 	AgarioAgent* pAgent;
 	AgarioFood* pFood;
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
 	{
 		return;
 	}
-	if (pBlackboard->GetData("FoodPtr", pFood) == false || pFood == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FoodPtr, pFood) == false || pFood == nullptr)
 	{
 		return;
 	}
 
-	pAgent->SetToSeek(pFood->GetPosition());
+	const Vector2 foodPos{ pFood->GetPosition() };
+	DecisionCommandBuffer::Submit([pAgent, foodPos]() { pAgent->SetToSeek(foodPos); });
 
 
 }
@@ -52,16 +54,17 @@ void FSMStates::FleeState::OnEnter(Elite::Blackboard* pBlackboard)
 
 	AgarioAgent* pAgent;
 	AgarioAgent* pFleeAgent;
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
 	{
 		return;
 	}
-	if (pBlackboard->GetData("FleeAgentPtr", pFleeAgent) == false || pFleeAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FleeAgentPtr, pFleeAgent) == false || pFleeAgent == nullptr)
 	{
 		return;
 	}
 
-	pAgent->SetToFlee(pFleeAgent->GetPosition());
+	const Vector2 fleePos{ pFleeAgent->GetPosition() };
+	DecisionCommandBuffer::Submit([pAgent, fleePos]() { pAgent->SetToFlee(fleePos); });
 
 }
 
@@ -76,15 +79,21 @@ bool FSMConditions::FoodNearBy::Evaluate(Blackboard* pBlackboard) const
 
 	AgarioAgent* pAgent;
 	std::vector<AgarioFood*>* pFoodVec;
+	ISpatialIndex* pFoodIndex;
 	Vector2 agentPos{};
 
 
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
 	{
 		return false;
 	}
 
-	if (pBlackboard->GetData("FoodVecPtr", pFoodVec) == false || pFoodVec == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FoodVecPtr, pFoodVec) == false || pFoodVec == nullptr)
+	{
+		return false;
+	}
+
+	if (pBlackboard->GetData(AgarioKeys::FoodIndexPtr, pFoodIndex) == false || pFoodIndex == nullptr)
 	{
 		return false;
 	}
@@ -92,31 +101,17 @@ bool FSMConditions::FoodNearBy::Evaluate(Blackboard* pBlackboard) const
 	agentPos = pAgent->GetPosition();
 	const float foodRadius{ 50.f + pAgent->GetRadius() };
 
-	DEBUGRENDERER2D->DrawCircle(agentPos, foodRadius, Color{ 1.f, 1.f, 1.f }, DEBUGRENDERER2D->NextDepthSlice());
+	DecisionCommandBuffer::Submit([agentPos, foodRadius]()
+		{ DEBUGRENDERER2D->DrawCircle(agentPos, foodRadius, Color{ 1.f, 1.f, 1.f }, DEBUGRENDERER2D->NextDepthSlice()); });
 
-	// Iterator to find the closest food, will be end iterator if not found
-	auto elementDist = [agentPos](AgarioFood* pFood, AgarioFood* pFood2)
-	{
-		float dist1 = agentPos.DistanceSquared(pFood->GetPosition());
-		float dist2 = agentPos.DistanceSquared(pFood2->GetPosition());
-		return dist1 < dist2;
-	};
-	auto closestFoodIt = std::min_element(pFoodVec->begin(), pFoodVec->end(), elementDist);
+	// Closest food within the radius, the id is the index in the food vector
+	const int foodId{ pFoodIndex->Nearest(agentPos, foodRadius) };
 
-	if (closestFoodIt != pFoodVec->end())
+	if (foodId != -1)
 	{
-		AgarioFood* pFood = *closestFoodIt;
-
-		float distanceToFood = agentPos.DistanceSquared(pFood->GetPosition());
-
-		if (distanceToFood < foodRadius * foodRadius)
-		{
-			pBlackboard->ChangeData("FoodPtr", pFood);
-			return true;
-		}
+		pBlackboard->ChangeData(AgarioKeys::FoodPtr, (*pFoodVec)[foodId]);
+		return true;
 	}
-	//std::cout << "\n";
-
 
 	return false;
 }
@@ -125,11 +120,11 @@ bool FSMConditions::FoodGone::Evaluate(Elite::Blackboard* pBlackboard) const
 {
 	AgarioFood* pFood;
 	std::vector<AgarioFood*>* pFoodVec;
-	if (pBlackboard->GetData("FoodPtr", pFood) == false || pFood == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FoodPtr, pFood) == false || pFood == nullptr)
 	{
 		return true;
 	}
-	if (pBlackboard->GetData("FoodVecPtr", pFoodVec) == false || pFoodVec == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FoodVecPtr, pFoodVec) == false || pFoodVec == nullptr)
 	{
 		return true;
 	}
@@ -146,24 +141,39 @@ bool FSMConditions::BiggerAgentNearby::Evaluate(Elite::Blackboard* pBlackboard)
 {
 	AgarioAgent* pAgent{ nullptr };
 	std::vector<AgarioAgent*>* pAgentVec{ nullptr };
+	ISpatialIndex* pAgentIndex{ nullptr };
 
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
+	{
+		return false;
+	}
+	if (pBlackboard->GetData(AgarioKeys::AgentVecPtr, pAgentVec) == false || pAgentVec == nullptr)
 	{
 		return false;
 	}
-	if (pBlackboard->GetData("AgentVecPtr", pAgentVec) == false || pAgentVec == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentIndexPtr, pAgentIndex) == false || pAgentIndex == nullptr)
 	{
 		return false;
 	}
 
-	// Loop through all agents and check if any of them are bigger than me and within flee radius
+	// Check the agents within flee radius if any of them are bigger than me
 	const float fleeRadius{ 10.0f + pAgent->GetRadius() };
 
+	// One condition is shared by all machines and evaluated on several threads, so the query buffer is per thread (only grows)
+	thread_local std::vector<int> nearbyAgentIds{};
+	if (nearbyAgentIds.size() < pAgentVec->size())
+	{
+		nearbyAgentIds.resize(pAgentVec->size());
+	}
+	const int nrOfNearbyAgents{ pAgentIndex->QueryRadius(pAgent->GetPosition(), fleeRadius, nearbyAgentIds) };
+
 	AgarioAgent* pFleeAgent{};
 	float distanceToFleeAgentSqr = FLT_MAX;
 
-	for (AgarioAgent* enemyAgent : *pAgentVec)
+	for (int nearbyIndex{}; nearbyIndex < nrOfNearbyAgents; ++nearbyIndex)
 	{
+		AgarioAgent* enemyAgent{ (*pAgentVec)[nearbyAgentIds[nearbyIndex]] };
+
 		const float distanceToAgentSqr{ pAgent->GetPosition().DistanceSquared(enemyAgent->GetPosition()) + Square(enemyAgent->GetRadius()) };
 
 		// Check if the agent we are checking is withing flee radius,
@@ -185,7 +195,7 @@ bool FSMConditions::BiggerAgentNearby::Evaluate(Elite::Blackboard* pBlackboard)
 
 	if (pFleeAgent != nullptr)
 	{
-		pBlackboard->ChangeData("FleeAgentPtr", pFleeAgent);
+		pBlackboard->ChangeData(AgarioKeys::FleeAgentPtr, pFleeAgent);
 		return true;
 	}
 
@@ -197,11 +207,11 @@ bool FSMConditions::BiggerAgentGone::Evaluate(Elite::Blackboard* pBlackboard) co
 	AgarioAgent* pAgent;
 	AgarioAgent* pFleeAgent;
 
-	if (pBlackboard->GetData("AgentPtr", pAgent) == false || pAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::AgentPtr, pAgent) == false || pAgent == nullptr)
 	{
 		return false;
 	}
-	if (pBlackboard->GetData("FleeAgentPtr", pFleeAgent) == false || pFleeAgent == nullptr)
+	if (pBlackboard->GetData(AgarioKeys::FleeAgentPtr, pFleeAgent) == false || pFleeAgent == nullptr)
 	{
 		return false;
 	}
@@ -214,7 +224,7 @@ bool FSMConditions::BiggerAgentGone::Evaluate(Elite::Blackboard* pBlackboard) co
 		if (distanceToAgentSqr > fleeRadius)
 		{
 			// The flee agent is gone
-			pBlackboard->ChangeData("FleeAgentPtr", nullptr);
+			pBlackboard->ChangeData(AgarioKeys::FleeAgentPtr, nullptr);
 			return true;
 		}
 	}
@@ -8,8 +8,10 @@
 
 #include "projects/Shared/Agario/AgarioAgent.h"
 #include "projects/Shared/Agario/AgarioFood.h"
+#include "projects/Shared/Agario/AgarioBlackboardKeys.h"
 #include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
 #include "framework/EliteAI/EliteData/EBlackboard.h"
+#include "projects/Movement/SteeringBehaviors/SpacePartitioning/SpatialIndex.h"
 
 
 //------------
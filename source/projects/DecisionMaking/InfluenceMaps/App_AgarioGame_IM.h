@@ -30,8 +30,16 @@ private:
 	float m_TrimWorldSize = 150.f;
 	const int m_AmountOfAgents{ 20 };
 	std::vector<AgarioAgent*> m_pAgentVec{};
+	Elite::BlackboardSchema m_BlackboardSchema{};  // Shared by the blackboards of all agents
 
 	AgarioAgent* m_pSmartAgent = nullptr;
+	Elite::Blackboard* m_pSmartBlackboard = nullptr;  // Owned by the tree of the smart agent
+	Elite::BehaviorTreeDefinition* m_pAgentBehavior = nullptr;  // Shared by all agents except the smart one
+	Elite::BehaviorTreeBatch* m_pAgentBatch = nullptr;  // Updates the trees of all agents except the smart one
+	const float m_DecisionRefreshInterval{ 0.1f };  // Event driven trees of the simple agents, see BehaviorTree::SetEventDriven
+	Elite::DecisionMakingScheduler m_DecisionMakingScheduler{};  // Fewer updates for agents far from the smart agent
+	const float m_DecisionMakingBudget{ 1.f };  // Milliseconds per frame
+	Elite::DecisionWorkers* m_pDecisionWorkers = nullptr;  // Runs the batch on all cores
 
 	const int m_AmountOfFood{ 40 };
 	const float m_FoodSpawnDelay{ 2.f };
@@ -46,6 +54,7 @@ private:
 
 	/* INFLUENCE MAP VARIABLES */
 	Elite::InfluenceMap<InfluenceGrid>* m_pInfluenceGrid = nullptr;
+	const Elite::BlackboardKey<Elite::InfluenceMap<InfluenceGrid>*> m_InfluenceMapKey{ "InfluenceMap" };
 	bool m_RenderInfluenceMap{ true };
 	float m_InfluenceMapCellSize = 5.0f;
 	int m_InfluenceMapCols = int(round(m_TrimWorldSize / m_InfluenceMapCellSize));
@@ -61,6 +70,7 @@ private:
 	void UpdateAgarioEntities(std::vector<T_AgarioType*>& entities, float deltaTime);
 
 	Elite::Blackboard* CreateBlackboard(AgarioAgent* a);
+	void PublishNearbyKeys();  // What the conditions observe, before the trees run
 	void UpdateImGui();
 private:
 	//C++ make the class non-copyable
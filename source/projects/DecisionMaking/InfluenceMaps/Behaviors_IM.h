@@ -12,6 +12,7 @@
 #include "framework/EliteAI/EliteDecisionMaking/EliteBehaviorTree/EBehaviorTree.h"
 #include "projects/Shared/Agario/AgarioAgent.h"
 #include "projects/Shared/Agario/AgarioFood.h"
+#include "projects/Shared/Agario/AgarioBlackboardKeys.h"
 #include "projects/Movement/SteeringBehaviors/Steering/SteeringBehaviors.h"
 
 //-----------------------------------------------------------------
@@ -23,14 +24,15 @@ namespace BT_Actions_IM
 	Elite::BehaviorState ChangeToWander(Elite::Blackboard* pBlackboard)
 	{
 		AgarioAgent* pAgent = nullptr;
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr) 
+		if (!pBlackboard->GetData(AgarioKeys::Agent, pAgent) || pAgent == nullptr) 
 		{
 			return Elite::BehaviorState::Failure;
 		}
 
 		//std::cout << "Wandering\n";
 
-		pAgent->SetToWander();
+		//Decisions can run in parallel, the agent only changes once they are all made
+		Elite::DecisionCommandBuffer::Submit([pAgent]() { pAgent->SetToWander(); });
 		return Elite::BehaviorState::Success;
 	}
 
@@ -38,11 +40,11 @@ namespace BT_Actions_IM
 	{
 		AgarioAgent* pAgent = nullptr;
 		Elite::Vector2 targetPos;
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr)
+		if (!pBlackboard->GetData(AgarioKeys::Agent, pAgent) || pAgent == nullptr)
 		{
 			return Elite::BehaviorState::Failure;
 		}
-		if (!pBlackboard->GetData("Target", targetPos))
+		if (!pBlackboard->GetData(AgarioKeys::Target, targetPos))
 		{
 			return Elite::BehaviorState::Failure;
 		}
@@ -50,7 +52,7 @@ namespace BT_Actions_IM
 		//std::cout << "Seeking\n";
 
 
-		pAgent->SetToSeek(targetPos);
+		Elite::DecisionCommandBuffer::Submit([pAgent, targetPos]() { pAgent->SetToSeek(targetPos); });
 		return Elite::BehaviorState::Success;
 	}
 
@@ -59,50 +61,46 @@ namespace BT_Actions_IM
 		AgarioAgent* pAgent = nullptr;
 		AgarioAgent* pFleeTarget = nullptr;
 
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr)
+		if (!pBlackboard->GetData(AgarioKeys::Agent, pAgent) || pAgent == nullptr)
 		{
 			return Elite::BehaviorState::Failure;
 		}
-		if (!pBlackboard->GetData("AgentFleeTarget", pFleeTarget) || pFleeTarget == nullptr)
+		if (!pBlackboard->GetData(AgarioKeys::AgentFleeTarget, pFleeTarget) || pFleeTarget == nullptr)
 		{
 			return Elite::BehaviorState::Failure;
 		}
 		
-		if (pAgent->CanRenderBehavior())
-		{
-			DEBUGRENDERER2D->DrawCircle(pFleeTarget->GetPosition(), pFleeTarget->GetRadius(), Elite::Color(1.0f, 0, 0), DEBUGRENDERER2D->NextDepthSlice());
-		}
-		pAgent->SetToFlee(pFleeTarget->GetPosition());
+		const Elite::Vector2 fleePos{ pFleeTarget->GetPosition() };
+		const float fleeRadius{ pFleeTarget->GetRadius() };
+		Elite::DecisionCommandBuffer::Submit([pAgent, fleePos, fleeRadius]()
+			{
+				if (pAgent->CanRenderBehavior())
+				{
+					DEBUGRENDERER2D->DrawCircle(fleePos, fleeRadius, Elite::Color(1.0f, 0, 0), DEBUGRENDERER2D->NextDepthSlice());
+				}
+				pAgent->SetToFlee(fleePos);
+			});
 		return Elite::BehaviorState::Success;
 
 	}
 }
 
 
-namespace BT_Conditions_IM
+namespace BT_Queries_IM
 {
-	bool IsFoodNearby(Elite::Blackboard* pBlackboard)
+	//The app runs these every frame and publishes the results on the blackboards (AgarioKeys::NearbyFood, ...), the
+	//conditions only read them. A result only changes the blackboard when it differs, that is what event driven trees observe
+	AgarioFood* FindNearbyFood(const AgarioAgent* pAgent, const std::vector<AgarioFood*>& foodVec)
 	{
-		AgarioAgent* pAgent = nullptr;
-		std::vector<AgarioFood*>* pFoodVec = nullptr;
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr)
-		{
-			return false;
-		}
-		if (!pBlackboard->GetData("FoodVec", pFoodVec) || pFoodVec == nullptr)
-		{
-			return false;
-		}
-
 		const float searchRadius{ 50.0f + pAgent->GetRadius() };
-		
+
 		AgarioFood* pClosestFood = nullptr;
 		float closestDistSqr{ searchRadius * searchRadius };
 
 		// TODO: Debug Rendering
 
 		Elite::Vector2 agentPos{ pAgent->GetPosition() };
-		for (auto& pFood : *pFoodVec)
+		for (AgarioFood* pFood : foodVec)
 		{
 			float distSq = pFood->GetPosition().DistanceSquared(agentPos);
 			if (distSq < closestDistSqr)
@@ -112,35 +110,17 @@ namespace BT_Conditions_IM
 			}
 		}
 
-		if (pClosestFood)
-		{			
-			pBlackboard->ChangeData("Target", pClosestFood->GetPosition());
-			return true;
-		}
-		
-		return false;		
+		return pClosestFood;
 	}
 
-	bool IsBiggerAgentNearby(Elite::Blackboard* pBlackboard)
+	AgarioAgent* FindBiggerAgentNearby(const AgarioAgent* pAgent, const std::vector<AgarioAgent*>& agentsVec)  // List of all non player agents
 	{
-		AgarioAgent* pAgent = nullptr;
-		std::vector<AgarioAgent*>* pAgentsVec = nullptr;  // List of all non player agents
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr)
-		{
-			return false;
-		}
-		if (!pBlackboard->GetData("AgentsVec", pAgentsVec) || pAgentsVec == nullptr)
-		{
-			return false;
-		}
-
-
 		const float fleeRadius{ 30.0f + pAgent->GetRadius() };
 		AgarioAgent* pFleeAgent = nullptr;
 		float closestDist{ fleeRadius };
 
 		Elite::Vector2 agentPos{ pAgent->GetPosition() };
-		for (auto& pEnemyAgent : *pAgentsVec)
+		for (AgarioAgent* pEnemyAgent : agentsVec)
 		{
 			//if (pEnemyAgent == pAgent)
 			//	continue;
@@ -152,39 +132,22 @@ namespace BT_Conditions_IM
 				{
 					pFleeAgent = pEnemyAgent;
 					closestDist = dist;
-				}				
+				}
 			}
 		}
 
-		if (pFleeAgent)
-		{
-			pBlackboard->ChangeData("AgentFleeTarget", pFleeAgent);
-			return true;
-		}
-
-		return false;
+		return pFleeAgent;
 	}
 
-	bool IsSmallerAgentNearby(Elite::Blackboard* pBlackboard)
+	AgarioAgent* FindSmallerAgentNearby(const AgarioAgent* pAgent, const std::vector<AgarioAgent*>& agentsVec)  // List of all non player agents
 	{
-		AgarioAgent* pAgent = nullptr;
-		std::vector<AgarioAgent*>* pAgentsVec = nullptr;  // List of all non player agents
-		if (!pBlackboard->GetData("Agent", pAgent) || pAgent == nullptr)
-		{
-			return false;
-		}
-		if (!pBlackboard->GetData("AgentsVec", pAgentsVec) || pAgentsVec == nullptr)
-		{
-			return false;
-		}
-
 		const float chaseRadius{ 10.0f + pAgent->GetRadius() };
 
 		AgarioAgent* pTargetAgent = nullptr;
 		float closestDistSqr{ chaseRadius * chaseRadius };
 
 		Elite::Vector2 agentPos{ pAgent->GetPosition() };
-		for (auto& pEnemyAgent : *pAgentsVec)
+		for (AgarioAgent* pEnemyAgent : agentsVec)
 		{
 			//if (pEnemyAgent == pAgent)
 			//	continue;
@@ -200,13 +163,47 @@ namespace BT_Conditions_IM
 			}
 		}
 
-		if (pTargetAgent)
+		return pTargetAgent;
+	}
+}
+
+
+namespace BT_Conditions_IM
+{
+	bool IsFoodNearby(Elite::Blackboard* pBlackboard)
+	{
+		AgarioFood* pClosestFood = nullptr;
+		if (!pBlackboard->GetData(AgarioKeys::NearbyFood, pClosestFood) || pClosestFood == nullptr)
 		{
-			pBlackboard->ChangeData("Target", pTargetAgent->GetPosition());
-			return true;
+			return false;
+		}
+
+		pBlackboard->ChangeData(AgarioKeys::Target, pClosestFood->GetPosition());
+		return true;
+	}
+
+	bool IsBiggerAgentNearby(Elite::Blackboard* pBlackboard)
+	{
+		AgarioAgent* pFleeAgent = nullptr;
+		if (!pBlackboard->GetData(AgarioKeys::NearbyBiggerAgent, pFleeAgent) || pFleeAgent == nullptr)
+		{
+			return false;
+		}
+
+		pBlackboard->ChangeData(AgarioKeys::AgentFleeTarget, pFleeAgent);
+		return true;
+	}
+
+	bool IsSmallerAgentNearby(Elite::Blackboard* pBlackboard)
+	{
+		AgarioAgent* pTargetAgent = nullptr;
+		if (!pBlackboard->GetData(AgarioKeys::NearbySmallerAgent, pTargetAgent) || pTargetAgent == nullptr)
+		{
+			return false;
 		}
 
-		return false;
+		pBlackboard->ChangeData(AgarioKeys::Target, pTargetAgent->GetPosition());
+		return true;
 	}
 }
 
@@ -0,0 +1,281 @@
+#include "stdafx.h"
+#include "OrcaAvoidance.h"
+
+#include "../SteeringAgent.h"
+#include "../SpacePartitioning/SpacePartitioning.h"
+#include "../SpacePartitioning/HierarchicalSpacePartitioning.h"
+
+using namespace Elite;
+
+namespace
+{
+	constexpr float OrcaEpsilon{ 0.00001f };
+
+	// 2D cross product, > 0 when b is on the left of a
+	inline float Determinant(const Vector2& a, const Vector2& b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
+}
+
+// --- Solver ---
+// --------------
+Vector2 OrcaSolver::ComputeVelocity(const Vector2& position, const Vector2& velocity, float radius, float maxSpeed,
+	const Vector2& preferredVelocity, const Neighbor* pNeighbors, int nrOfNeighbors, float timeHorizon, float deltaT)
+{
+	m_Lines.clear();
+	const float invTimeHorizon{ 1.f / timeHorizon };
+
+	for(int neighborIndex{}; neighborIndex < nrOfNeighbors; ++neighborIndex)
+	{
+		const Neighbor& neighbor{ pNeighbors[neighborIndex] };
+		const Vector2 relativePosition{ neighbor.Position - position };
+		const Vector2 relativeVelocity{ velocity - neighbor.Velocity };
+		const float distanceSquared{ relativePosition.MagnitudeSquared() };
+		const float combinedRadius{ radius + neighbor.Radius };
+		const float combinedRadiusSquared{ Square(combinedRadius) };
+
+		Line line{};
+		Vector2 u{};
+
+		if(distanceSquared > combinedRadiusSquared)
+		{
+			// No collision yet, w is the vector from the cutoff circle center to the relative velocity
+			const Vector2 w{ relativeVelocity - invTimeHorizon * relativePosition };
+			const float wLengthSquared{ w.MagnitudeSquared() };
+			const float dotProduct{ w.Dot(relativePosition) };
+
+			if(dotProduct < 0.f && Square(dotProduct) > combinedRadiusSquared * wLengthSquared)
+			{
+				// Project on the cutoff circle
+				const float wLength{ sqrtf(wLengthSquared) };
+				const Vector2 unitW{ w / wLength };
+				line.Direction = Vector2{ unitW.y, -unitW.x };
+				u = (combinedRadius * invTimeHorizon - wLength) * unitW;
+			}
+			else
+			{
+				// Project on the left or right leg of the velocity obstacle cone
+				const float leg{ sqrtf(distanceSquared - combinedRadiusSquared) };
+				if(Determinant(relativePosition, w) > 0.f)
+				{
+					line.Direction = Vector2{ relativePosition.x * leg - relativePosition.y * combinedRadius,
+						relativePosition.x * combinedRadius + relativePosition.y * leg } / distanceSquared;
+				}
+				else
+				{
+					line.Direction = -Vector2{ relativePosition.x * leg + relativePosition.y * combinedRadius,
+						-relativePosition.x * combinedRadius + relativePosition.y * leg } / distanceSquared;
+				}
+
+				u = relativeVelocity.Dot(line.Direction) * line.Direction - relativeVelocity;
+			}
+		}
+		else
+		{
+			// Already overlapping, resolve the collision within the next step
+			const float invTimeStep{ 1.f / deltaT };
+			const Vector2 w{ relativeVelocity - invTimeStep * relativePosition };
+			const float wLength{ w.Magnitude() };
+			const Vector2 unitW{ wLength > OrcaEpsilon ? w / wLength : Vector2{ 1.f, 0.f } };
+			line.Direction = Vector2{ unitW.y, -unitW.x };
+			u = (combinedRadius * invTimeStep - wLength) * unitW;
+		}
+
+		// Both agents take half of the responsibility to avoid each other
+		line.Point = velocity + 0.5f * u;
+		m_Lines.push_back(line);
+	}
+
+	Vector2 newVelocity{};
+	const size_t lineFail{ LinearProgram2(m_Lines, maxSpeed, preferredVelocity, false, newVelocity) };
+	if(lineFail < m_Lines.size())
+		LinearProgram3(lineFail, maxSpeed, newVelocity);
+
+	return newVelocity;
+}
+
+bool OrcaSolver::LinearProgram1(const std::vector<Line>& lines, size_t lineIndex, float radius, const Vector2& optimalVelocity, bool optimizeDirection, Vector2& result)
+{
+	// Intersect the line with the max speed circle
+	const Line& line{ lines[lineIndex] };
+	const float dotProduct{ line.Point.Dot(line.Direction) };
+	const float discriminant{ Square(dotProduct) + Square(radius) - line.Point.MagnitudeSquared() };
+	if(discriminant < 0.f)
+		return false;
+
+	const float sqrtDiscriminant{ sqrtf(discriminant) };
+	float tLeft{ -dotProduct - sqrtDiscriminant };
+	float tRight{ -dotProduct + sqrtDiscriminant };
+
+	// Clip the segment with all earlier lines
+	for(size_t otherIndex{}; otherIndex < lineIndex; ++otherIndex)
+	{
+		const Line& other{ lines[otherIndex] };
+		const float denominator{ Determinant(line.Direction, other.Direction) };
+		const float numerator{ Determinant(other.Direction, line.Point - other.Point) };
+
+		if(fabsf(denominator) <= OrcaEpsilon)
+		{
+			// Parallel lines, infeasible when this line lies outside of the other one
+			if(numerator < 0.f)
+				return false;
+			continue;
+		}
+
+		const float t{ numerator / denominator };
+		if(denominator >= 0.f)
+			tRight = std::min(tRight, t);
+		else
+			tLeft = std::max(tLeft, t);
+
+		if(tLeft > tRight)
+			return false;
+	}
+
+	if(optimizeDirection)
+	{
+		result = line.Point + (optimalVelocity.Dot(line.Direction) > 0.f ? tRight : tLeft) * line.Direction;
+	}
+	else
+	{
+		// Closest point on the segment to the optimal velocity
+		const float t{ Clamp(line.Direction.Dot(optimalVelocity - line.Point), tLeft, tRight) };
+		result = line.Point + t * line.Direction;
+	}
+
+	return true;
+}
+
+size_t OrcaSolver::LinearProgram2(const std::vector<Line>& lines, float radius, const Vector2& optimalVelocity, bool optimizeDirection, Vector2& result)
+{
+	if(optimizeDirection)
+		result = optimalVelocity * radius;  // optimalVelocity is a unit direction here
+	else if(optimalVelocity.MagnitudeSquared() > Square(radius))
+		result = optimalVelocity.GetNormalized() * radius;
+	else
+		result = optimalVelocity;
+
+	for(size_t lineIndex{}; lineIndex < lines.size(); ++lineIndex)
+	{
+		// Result is on the wrong side of this line, move it onto the line
+		if(Determinant(lines[lineIndex].Direction, lines[lineIndex].Point - result) > 0.f)
+		{
+			const Vector2 previousResult{ result };
+			if(!LinearProgram1(lines, lineIndex, radius, optimalVelocity, optimizeDirection, result))
+			{
+				result = previousResult;
+				return lineIndex;
+			}
+		}
+	}
+
+	return lines.size();
+}
+
+void OrcaSolver::LinearProgram3(size_t beginLine, float radius, Vector2& result)
+{
+	// No velocity satisfies every constraint, minimize the largest penetration into the half-planes instead
+	float distance{ 0.f };
+
+	for(size_t lineIndex{ beginLine }; lineIndex < m_Lines.size(); ++lineIndex)
+	{
+		const Line& line{ m_Lines[lineIndex] };
+		if(Determinant(line.Direction, line.Point - result) <= distance)
+			continue;
+
+		m_ProjectedLines.clear();
+		for(size_t otherIndex{}; otherIndex < lineIndex; ++otherIndex)
+		{
+			const Line& other{ m_Lines[otherIndex] };
+			Line projectedLine{};
+
+			const float determinant{ Determinant(line.Direction, other.Direction) };
+			if(fabsf(determinant) <= OrcaEpsilon)
+			{
+				// Same direction, the other line is already covered by this one
+				if(line.Direction.Dot(other.Direction) > 0.f)
+					continue;
+				projectedLine.Point = 0.5f * (line.Point + other.Point);
+			}
+			else
+			{
+				projectedLine.Point = line.Point + (Determinant(other.Direction, line.Point - other.Point) / determinant) * line.Direction;
+			}
+
+			projectedLine.Direction = (other.Direction - line.Direction).GetNormalized();
+			m_ProjectedLines.push_back(projectedLine);
+		}
+
+		const Vector2 previousResult{ result };
+		if(LinearProgram2(m_ProjectedLines, radius, Vector2{ -line.Direction.y, line.Direction.x }, true, result) < m_ProjectedLines.size())
+		{
+			// Can only fail because of floating point errors, keep the previous result
+			result = previousResult;
+		}
+
+		distance = Determinant(line.Direction, line.Point - result);
+	}
+}
+
+// --- Steering ---
+// ----------------
+OrcaSteering::OrcaSteering(ISteeringBehavior* pDesiredBehavior, CellSpace* pCellSpace, float neighborRadius, int maxNeighbors)
+	: m_pDesiredBehavior{ pDesiredBehavior }
+	, m_pCellSpace{ pCellSpace }
+	, m_NeighborRadius{ neighborRadius }
+	, m_MaxNeighbors{ maxNeighbors }
+{
+	m_Neighbors.resize(maxNeighbors);
+}
+
+OrcaSteering::OrcaSteering(ISteeringBehavior* pDesiredBehavior, QuadCellSpace* pQuadCellSpace, float neighborRadius, int maxNeighbors)
+	: m_pDesiredBehavior{ pDesiredBehavior }
+	, m_pQuadCellSpace{ pQuadCellSpace }
+	, m_NeighborRadius{ neighborRadius }
+	, m_MaxNeighbors{ maxNeighbors }
+{
+	m_QueryResults.resize(maxNeighbors);
+	m_Neighbors.resize(maxNeighbors);
+}
+
+SteeringOutput OrcaSteering::CalculateSteering(float deltaT, SteeringAgent* pAgent)
+{
+	SteeringOutput steering{ m_pDesiredBehavior->CalculateSteering(deltaT, pAgent) };
+	if(!steering.IsValid || deltaT <= 0.f)
+		return steering;
+
+	// Only the nearest neighbors matter, the farther ones are rarely reachable within the time horizon
+	const std::vector<SteeringAgent*>* pNeighborAgents{ &m_QueryResults };
+	int nrOfNeighbors{};
+	if(m_pQuadCellSpace)
+	{
+		nrOfNeighbors = m_pQuadCellSpace->QueryNearest(pAgent->GetPosition(), m_NeighborRadius, m_MaxNeighbors, m_QueryResults, pAgent);
+	}
+	else
+	{
+		m_pCellSpace->RegisterNearestNeighbors(pAgent, m_NeighborRadius, m_MaxNeighbors);
+		nrOfNeighbors = m_pCellSpace->GetNrOfNeighbors();
+		pNeighborAgents = &m_pCellSpace->GetNeighbors();
+	}
+
+	for(int neighborIndex{}; neighborIndex < nrOfNeighbors; ++neighborIndex)
+	{
+		const SteeringAgent* pNeighbor{ (*pNeighborAgents)[neighborIndex] };
+		m_Neighbors[neighborIndex] = { pNeighbor->GetPosition(), pNeighbor->GetLinearVelocity(), pNeighbor->GetRadius() };
+	}
+
+	// The desired behavior only gives the preferred velocity, the agent takes the solved velocity as is (no collision within the horizon)
+	const Vector2 desiredVelocity{ steering.LinearVelocity };
+	steering.LinearVelocity = m_Solver.ComputeVelocity(pAgent->GetPosition(), pAgent->GetLinearVelocity(), pAgent->GetRadius(),
+		pAgent->GetMaxLinearSpeed(), desiredVelocity, m_Neighbors.data(), nrOfNeighbors, m_TimeHorizon, deltaT);
+	steering.IsVelocityOverride = true;
+
+	if(pAgent->CanRenderBehavior())
+	{
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), desiredVelocity, desiredVelocity.Magnitude() * 0.2f, { 0.5f, 0.5f, 0.5f });
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), steering.LinearVelocity, steering.LinearVelocity.Magnitude() * 0.2f, { 1, 0.5f, 0 });
+	}
+
+	return steering;
+}
@@ -0,0 +1,81 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// OrcaAvoidance.h: Optimal reciprocal collision avoidance (ORCA) between agents.
+// Every neighbor adds a half-plane of velocities that stay collision free for the time horizon,
+// the new velocity is the one closest to the preferred velocity inside all half-planes (and the max speed).
+// OrcaSteering wraps any behavior and replaces its linear velocity with the avoiding one,
+// so agents can avoid each other without rigidbody contacts.
+/*=============================================================================*/
+#pragma once
+#include "../Steering/SteeringBehaviors.h"
+
+class CellSpace;
+class QuadCellSpace;
+
+// --- Solver ---
+// --------------
+class OrcaSolver final
+{
+public:
+	struct Neighbor
+	{
+		Elite::Vector2 Position;
+		Elite::Vector2 Velocity;
+		float Radius = 0.f;
+	};
+
+	// Velocity closest to preferredVelocity that doesn't collide with the neighbors within timeHorizon seconds,
+	// deltaT is only used to resolve agents that already overlap
+	Elite::Vector2 ComputeVelocity(const Elite::Vector2& position, const Elite::Vector2& velocity, float radius, float maxSpeed,
+		const Elite::Vector2& preferredVelocity, const Neighbor* pNeighbors, int nrOfNeighbors, float timeHorizon, float deltaT);
+
+private:
+	// Velocities on the left of the direction are allowed
+	struct Line
+	{
+		Elite::Vector2 Point;
+		Elite::Vector2 Direction;
+	};
+
+	// Members to avoid memory allocation on every call
+	std::vector<Line> m_Lines;
+	std::vector<Line> m_ProjectedLines;
+
+	static bool LinearProgram1(const std::vector<Line>& lines, size_t lineIndex, float radius, const Elite::Vector2& optimalVelocity, bool optimizeDirection, Elite::Vector2& result);
+	static size_t LinearProgram2(const std::vector<Line>& lines, float radius, const Elite::Vector2& optimalVelocity, bool optimizeDirection, Elite::Vector2& result);
+	void LinearProgram3(size_t beginLine, float radius, Elite::Vector2& result);
+};
+
+// --- Steering ---
+// ----------------
+// Neighbors come from the partitioning, the space has to be kept up to date by the owner (UpdateAgentCell / UpdateAgents)
+class OrcaSteering final : public ISteeringBehavior
+{
+public:
+	OrcaSteering(ISteeringBehavior* pDesiredBehavior, CellSpace* pCellSpace, float neighborRadius = 10.f, int maxNeighbors = 10);
+	OrcaSteering(ISteeringBehavior* pDesiredBehavior, QuadCellSpace* pQuadCellSpace, float neighborRadius = 10.f, int maxNeighbors = 10);
+
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+
+	void SetDesiredBehavior(ISteeringBehavior* pDesiredBehavior) { m_pDesiredBehavior = pDesiredBehavior; }
+	void SetTimeHorizon(float timeHorizon) { m_TimeHorizon = timeHorizon; }
+	float GetTimeHorizon() const { return m_TimeHorizon; }
+	void SetNeighborRadius(float neighborRadius) { m_NeighborRadius = neighborRadius; }
+
+private:
+	ISteeringBehavior* m_pDesiredBehavior;
+	CellSpace* m_pCellSpace{ nullptr };
+	QuadCellSpace* m_pQuadCellSpace{ nullptr };
+
+	float m_NeighborRadius;
+	int m_MaxNeighbors;
+	float m_TimeHorizon{ 2.f };
+
+	OrcaSolver m_Solver;
+	std::vector<SteeringAgent*> m_QueryResults;
+	std::vector<OrcaSolver::Neighbor> m_Neighbors;
+
+	using ISteeringBehavior::SetTarget; // made private because targets need to be set on the desired behavior
+};
@@ -6,6 +6,8 @@
 #include "../SteeringAgent.h"
 #include "CombinedSteeringBehaviors.h"
 #include "projects\Movement\SteeringBehaviors\Obstacle.h"
+#include "../Avoidance/OrcaAvoidance.h"
+#include "../SpacePartitioning/SpacePartitioning.h"
 
 using namespace Elite;
 App_CombinedSteering::~App_CombinedSteering()
@@ -23,6 +25,11 @@ App_CombinedSteering::~App_CombinedSteering()
 	SAFE_DELETE(m_pPrioritySteering);
 	SAFE_DELETE(m_pSoberWander);
 	SAFE_DELETE(m_pEvade);
+
+	// Avoidance
+	SAFE_DELETE(m_pDrunkAvoidance);
+	SAFE_DELETE(m_pEvadingAvoidance);
+	SAFE_DELETE(m_pCellSpace);
 }
 
 void App_CombinedSteering::Start()
@@ -37,7 +44,7 @@ void App_CombinedSteering::Start()
 	m_pDrunkWander->SetWanderOffset(0);
 	m_pBlendedSteering = new BlendedSteering({ {m_pSeek, 0.25f}, {m_pDrunkWander, 0.5f} });
 
-	m_pDrunkAgent = new SteeringAgent();
+	m_pDrunkAgent = new SteeringAgent(1.f, !m_UseAvoidance);
 	m_pDrunkAgent->SetSteeringBehavior(m_pBlendedSteering);
 	m_pDrunkAgent->SetMaxLinearSpeed(15.0f);
 	m_pDrunkAgent->SetAutoOrient(true);
@@ -48,13 +55,31 @@ void App_CombinedSteering::Start()
 	m_pEvade = new Evade();
 	m_pPrioritySteering = new PrioritySteering({ m_pEvade, m_pSoberWander });
 
-	m_pEvadingAgent = new SteeringAgent();
+	m_pEvadingAgent = new SteeringAgent(1.f, !m_UseAvoidance);
 	m_pEvadingAgent->SetSteeringBehavior(m_pPrioritySteering);
 	m_pEvadingAgent->SetMaxLinearSpeed(15.0f);
 	m_pEvadingAgent->SetAutoOrient(true);
 	m_pEvadingAgent->SetMass(0.3f);
-	
 
+	// Both agents avoid each other on top of their own behavior
+	m_pCellSpace = new CellSpace(m_TrimWorldSize, m_TrimWorldSize, 5, 5, 2);
+	m_pDrunkAgent->SetOldPosition(m_pDrunkAgent->GetPosition());
+	m_pEvadingAgent->SetOldPosition(m_pEvadingAgent->GetPosition());
+	m_pCellSpace->AddAgent(m_pDrunkAgent);
+	m_pCellSpace->AddAgent(m_pEvadingAgent);
+	m_pDrunkAvoidance = new OrcaSteering(m_pBlendedSteering, m_pCellSpace);
+	m_pEvadingAvoidance = new OrcaSteering(m_pPrioritySteering, m_pCellSpace);
+	SetAvoidanceEnabled(m_UseAvoidance);
+}
+
+void App_CombinedSteering::SetAvoidanceEnabled(bool isEnabled)
+{
+	// Without avoidance the agents fall back on their rigidbodies to keep apart
+	m_UseAvoidance = isEnabled;
+	m_pDrunkAgent->SetSteeringBehavior(isEnabled ? static_cast<ISteeringBehavior*>(m_pDrunkAvoidance) : m_pBlendedSteering);
+	m_pEvadingAgent->SetSteeringBehavior(isEnabled ? static_cast<ISteeringBehavior*>(m_pEvadingAvoidance) : m_pPrioritySteering);
+	m_pDrunkAgent->SetPhysicsEnabled(!isEnabled);
+	m_pEvadingAgent->SetPhysicsEnabled(!isEnabled);
 }
 
 void App_CombinedSteering::Update(float deltaTime)
@@ -109,6 +134,9 @@ void App_CombinedSteering::Update(float deltaTime)
 		ImGui::Spacing();
 
 		ImGui::Checkbox("Debug Rendering", &m_CanDebugRender);
+		bool useAvoidance{ m_UseAvoidance };
+		if (ImGui::Checkbox("Avoidance (ORCA)", &useAvoidance))
+			SetAvoidanceEnabled(useAvoidance);
 		ImGui::Checkbox("Trim World", &m_TrimWorld);
 		if (m_TrimWorld)
 		{
@@ -131,6 +159,11 @@ void App_CombinedSteering::Update(float deltaTime)
 	#pragma endregion
 #endif
 
+	m_pCellSpace->UpdateAgentCell(m_pDrunkAgent);
+	m_pCellSpace->UpdateAgentCell(m_pEvadingAgent);
+	m_pDrunkAgent->SetOldPosition(m_pDrunkAgent->GetPosition());
+	m_pEvadingAgent->SetOldPosition(m_pEvadingAgent->GetPosition());
+
 	m_pSeek->SetTarget(m_MouseTarget);
 	m_pDrunkAgent->Update(deltaTime);
 
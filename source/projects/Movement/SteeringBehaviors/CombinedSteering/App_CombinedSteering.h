@@ -9,6 +9,8 @@
 class SteeringAgent;
 class BlendedSteering;
 class PrioritySteering;
+class OrcaSteering;
+class CellSpace;
 
 //-----------------------------------------------------------------
 // Application
@@ -49,6 +51,12 @@ private:
 	Wander* m_pSoberWander = nullptr;
 	Evade* m_pEvade = nullptr;
 
-	
+	// Avoidance, replaces the rigidbody contacts between the agents
+	bool m_UseAvoidance = true;
+	CellSpace* m_pCellSpace = nullptr;
+	OrcaSteering* m_pDrunkAvoidance = nullptr;
+	OrcaSteering* m_pEvadingAvoidance = nullptr;
+
+	void SetAvoidanceEnabled(bool isEnabled);
 };
 #endif
\ No newline at end of file
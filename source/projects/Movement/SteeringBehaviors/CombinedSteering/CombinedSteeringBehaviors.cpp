@@ -36,6 +36,38 @@ SteeringOutput BlendedSteering::CalculateSteering(float deltaT, SteeringAgent* p
 	return blendedSteering;
 }
 
+void BlendedSteering::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	if (m_BatchOutputs.size() < states.Size)
+		m_BatchOutputs.resize(states.Size);
+
+	for (size_t index{}; index < states.Size; ++index)
+		outputs[index] = SteeringOutput{};
+
+	// Every behavior runs over the whole batch before its output is added
+	auto totalWeight = 0.f;
+	for (const WeightedBehavior& weightedBehavior : m_WeightedBehaviors)
+	{
+		weightedBehavior.pBehavior->CalculateSteeringBatch(deltaT, states, Span<SteeringOutput>(m_BatchOutputs).First(states.Size));
+
+		const float weight{ weightedBehavior.weight };
+		for (size_t index{}; index < states.Size; ++index)
+		{
+			outputs[index].LinearVelocity += weight * m_BatchOutputs[index].LinearVelocity;
+			outputs[index].AngularVelocity += weight * m_BatchOutputs[index].AngularVelocity;
+		}
+
+		totalWeight += weight;
+	}
+
+	if (totalWeight > 0.f)
+	{
+		const float scale{ 1.f / totalWeight };
+		for (size_t index{}; index < states.Size; ++index)
+			outputs[index] *= scale;
+	}
+}
+
 //*****************
 //PRIORITY STEERING
 SteeringOutput PrioritySteering::CalculateSteering(float deltaT, SteeringAgent* pAgent)
@@ -52,4 +84,47 @@ SteeringOutput PrioritySteering::CalculateSteering(float deltaT, SteeringAgent*
 
 	//If non of the behavior return a valid output, last behavior is returned
 	return steering;
-}
\ No newline at end of file
+}
+
+void PrioritySteering::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	if (m_PriorityBehaviors.empty())
+	{
+		for (size_t index{}; index < states.Size; ++index)
+			outputs[index] = SteeringOutput{};
+		return;
+	}
+
+	// Every behavior only gets the states that no earlier behavior gave a valid output
+	m_PendingStates.assign(states.begin(), states.end());
+	m_PendingIndices.resize(states.Size);
+	for (size_t index{}; index < states.Size; ++index)
+		m_PendingIndices[index] = index;
+
+	if (m_BatchOutputs.size() < states.Size)
+		m_BatchOutputs.resize(states.Size);
+
+	for (size_t behaviorIndex{}; behaviorIndex < m_PriorityBehaviors.size() && !m_PendingStates.empty(); ++behaviorIndex)
+	{
+		const bool isLastBehavior{ behaviorIndex + 1 == m_PriorityBehaviors.size() };
+		const size_t nrOfPending{ m_PendingStates.size() };
+		m_PriorityBehaviors[behaviorIndex]->CalculateSteeringBatch(deltaT, m_PendingStates, Span<SteeringOutput>(m_BatchOutputs).First(nrOfPending));
+
+		// Write the valid outputs and compact the rest in place, the last behavior is returned even when invalid
+		size_t nrOfRemaining{};
+		for (size_t pendingIndex{}; pendingIndex < nrOfPending; ++pendingIndex)
+		{
+			if (m_BatchOutputs[pendingIndex].IsValid || isLastBehavior)
+			{
+				outputs[m_PendingIndices[pendingIndex]] = m_BatchOutputs[pendingIndex];
+				continue;
+			}
+
+			m_PendingStates[nrOfRemaining] = m_PendingStates[pendingIndex];
+			m_PendingIndices[nrOfRemaining] = m_PendingIndices[pendingIndex];
+			++nrOfRemaining;
+		}
+		m_PendingStates.resize(nrOfRemaining);
+		m_PendingIndices.resize(nrOfRemaining);
+	}
+}
@@ -23,12 +23,14 @@ public:
 
 	void AddBehaviour(WeightedBehavior weightedBehavior) { m_WeightedBehaviors.push_back(weightedBehavior); }
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 
 	// returns a reference to the weighted behaviors, can be used to adjust weighting. Is not intended to alter the behaviors themselves.
 	std::vector<WeightedBehavior>& GetWeightedBehaviorsRef() { return m_WeightedBehaviors; }
 
 private:
 	std::vector<WeightedBehavior> m_WeightedBehaviors = {};
+	std::vector<SteeringOutput> m_BatchOutputs = {};  // Output of a single behavior, reused every batch
 
 	using ISteeringBehavior::SetTarget; // made private because targets need to be set on the individual behaviors, not the combined behavior
 };
@@ -44,9 +46,15 @@ public:
 
 	void AddBehaviour(ISteeringBehavior* pBehavior) { m_PriorityBehaviors.push_back(pBehavior); }
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 
 private:
 	std::vector<ISteeringBehavior*> m_PriorityBehaviors = {};
 
+	// States that have no valid output yet and their index in the batch, reused every batch
+	std::vector<AgentSteeringState> m_PendingStates = {};
+	std::vector<size_t> m_PendingIndices = {};
+	std::vector<SteeringOutput> m_BatchOutputs = {};
+
 	using ISteeringBehavior::SetTarget; // made private because targets need to be set on the individual behaviors, not the combined behavior
 };
\ No newline at end of file
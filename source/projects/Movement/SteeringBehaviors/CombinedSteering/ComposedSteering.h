@@ -0,0 +1,168 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// ComposedSteering.h: Blended and priority steering composed at compile time, e.g. Priority<Evade, Blended<Cohesion, Separation, Seek>>.
+// The behaviors are stored by value and called without virtual dispatch, so the whole stack can be inlined into one function.
+// Only the weights stay tunable at runtime, wrap the outer composition in ComposedSteering to give it to an agent.
+/*=============================================================================*/
+#pragma once
+#include <tuple>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include "../Steering/SteeringBehaviors.h"
+#include "../SteeringAgent.h"
+
+namespace ComposedSteeringDetail
+{
+	// Qualified call, resolved at compile time even when the behavior itself is virtual
+	template<typename Behavior>
+	inline SteeringOutput CalculateSteering(Behavior& behavior, float deltaT, SteeringAgent* pAgent)
+	{
+		return behavior.Behavior::CalculateSteering(deltaT, pAgent);
+	}
+}
+
+//****************
+//BLENDED
+template<typename... Behaviors>
+class Blended final
+{
+public:
+	static constexpr size_t NrOfBehaviors{ sizeof...(Behaviors) };
+
+	Blended(const std::array<float, NrOfBehaviors>& weights, Behaviors... behaviors)
+		: m_Behaviors{ std::move(behaviors)... }
+		, m_Weights{ weights }
+	{}
+
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent)
+	{
+		SteeringOutput blendedSteering{ Blend(deltaT, pAgent, std::index_sequence_for<Behaviors...>{}) };
+
+		if (pAgent->CanRenderBehavior())
+			DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), blendedSteering.LinearVelocity, 7, { 0, 1, 1 }, 0.40f);
+
+		return blendedSteering;
+	}
+
+	template<size_t Index>
+	auto& Get() { return std::get<Index>(m_Behaviors); }
+
+	float& GetWeightRef(size_t index) { return m_Weights[index]; }
+	std::array<float, NrOfBehaviors>& GetWeightsRef() { return m_Weights; }
+
+	// Weight of the behavior at that address, nullptr when it isn't part of this blend (lookup for the UI, not for the update)
+	float* FindWeight(const void* pBehavior)
+	{
+		return FindWeight(pBehavior, std::index_sequence_for<Behaviors...>{});
+	}
+
+private:
+	std::tuple<Behaviors...> m_Behaviors;
+	std::array<float, NrOfBehaviors> m_Weights;
+
+	template<size_t... Indices>
+	SteeringOutput Blend(float deltaT, SteeringAgent* pAgent, std::index_sequence<Indices...>)
+	{
+		SteeringOutput blendedSteering{};
+		float totalWeight{};
+		// Expands to one AddWeighted per behavior, in order (the leading 0 keeps the array valid for an empty blend)
+		const int expander[]{ 0, (AddWeighted<Indices>(deltaT, pAgent, blendedSteering, totalWeight), 0)... };
+		(void)expander;
+
+		if (totalWeight > 0.f)
+			blendedSteering *= 1.f / totalWeight;
+
+		return blendedSteering;
+	}
+
+	template<size_t Index>
+	void AddWeighted(float deltaT, SteeringAgent* pAgent, SteeringOutput& blendedSteering, float& totalWeight)
+	{
+		// Behaviors without weight don't contribute, so they aren't evaluated at all
+		const float weight{ m_Weights[Index] };
+		if (weight == 0.f)
+			return;
+
+		const SteeringOutput steering{ ComposedSteeringDetail::CalculateSteering(std::get<Index>(m_Behaviors), deltaT, pAgent) };
+		blendedSteering.LinearVelocity += weight * steering.LinearVelocity;
+		blendedSteering.AngularVelocity += weight * steering.AngularVelocity;
+		totalWeight += weight;
+	}
+
+	template<size_t... Indices>
+	float* FindWeight(const void* pBehavior, std::index_sequence<Indices...>)
+	{
+		float* pWeight{ nullptr };
+		const int expander[]{ 0, ((pWeight = (pBehavior == &std::get<Indices>(m_Behaviors)) ? &m_Weights[Indices] : pWeight), 0)... };
+		(void)expander;
+		return pWeight;
+	}
+};
+
+//*****************
+//PRIORITY
+template<typename... Behaviors>
+class Priority final
+{
+public:
+	static constexpr size_t NrOfBehaviors{ sizeof...(Behaviors) };
+
+	Priority(Behaviors... behaviors)
+		: m_Behaviors{ std::move(behaviors)... }
+	{}
+
+	// First valid output in order, the last behavior is returned when none of them is valid (same as PrioritySteering)
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent)
+	{
+		return Evaluate(deltaT, pAgent, std::integral_constant<size_t, 0>{});
+	}
+
+	template<size_t Index>
+	auto& Get() { return std::get<Index>(m_Behaviors); }
+
+private:
+	std::tuple<Behaviors...> m_Behaviors;
+
+	template<size_t Index>
+	SteeringOutput Evaluate(float deltaT, SteeringAgent* pAgent, std::integral_constant<size_t, Index>)
+	{
+		const SteeringOutput steering{ ComposedSteeringDetail::CalculateSteering(std::get<Index>(m_Behaviors), deltaT, pAgent) };
+		if (!steering.IsValid)
+			return Evaluate(deltaT, pAgent, std::integral_constant<size_t, Index + 1>{});
+		return steering;
+	}
+
+	// The last behavior ends the recursion, its output is returned whether it's valid or not
+	SteeringOutput Evaluate(float deltaT, SteeringAgent* pAgent, std::integral_constant<size_t, NrOfBehaviors - 1>)
+	{
+		return ComposedSteeringDetail::CalculateSteering(std::get<NrOfBehaviors - 1>(m_Behaviors), deltaT, pAgent);
+	}
+};
+
+//*****************
+//COMPOSED STEERING
+// Gives a composition the ISteeringBehavior interface, the only virtual call left is the one into this class
+template<typename Composition>
+class ComposedSteering final : public ISteeringBehavior
+{
+public:
+	template<typename... Arguments>
+	explicit ComposedSteering(Arguments&&... arguments)
+		: m_Composition{ std::forward<Arguments>(arguments)... }
+	{}
+
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override
+	{
+		return m_Composition.CalculateSteering(deltaT, pAgent);
+	}
+
+	Composition& GetComposition() { return m_Composition; }
+
+private:
+	Composition m_Composition;
+
+	using ISteeringBehavior::SetTarget; // made private because targets need to be set on the individual behaviors, not the combined behavior
+};
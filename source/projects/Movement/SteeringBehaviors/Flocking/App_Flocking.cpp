@@ -47,11 +47,16 @@ void App_Flocking::Update(float deltaTime)
 
 	
 	m_pFlock->UpdateAndRenderUI();
-	m_pFlock->Update(deltaTime);
-	m_pAgentToEvade->Update(deltaTime);
 	if (m_UseMouseTarget)
 		m_pFlock->SetTarget_Seek(m_MouseTarget);
-	
+}
+
+void App_Flocking::FixedUpdate(float fixedDeltaTime)
+{
+	//Simulation runs at the SIMULATIONCLOCK rate, not the frame rate
+	m_pFlock->Update(fixedDeltaTime);
+	m_pAgentToEvade->Update(fixedDeltaTime);
+
 	//if(m_TrimWorld)
 	m_pAgentToEvade->TrimToWorld(m_TrimWorldSize);
 }
@@ -22,6 +22,7 @@ public:
 	//App Functions
 	void Start() override;
 	void Update(float deltaTime) override;
+	void FixedUpdate(float fixedDeltaTime) override;
 	void Render(float deltaTime) const override;
 
 private:
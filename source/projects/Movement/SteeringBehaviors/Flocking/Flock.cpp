@@ -3,9 +3,11 @@
 
 #include "../SteeringAgent.h"
 #include "../Steering/SteeringBehaviors.h"
-#include "../CombinedSteering/CombinedSteeringBehaviors.h"
+#include "../CombinedSteering/ComposedSteering.h"
 #include "../SpacePartitioning/HierarchicalSpacePartitioning.h"
 #include "../SpacePartitioning/SpacePartitioning.h"
+#include "../SpacePartitioning/SpatialIndex.h"
+#include "framework\EliteMath\EVector2SIMD.h"
 
 using namespace Elite;
 
@@ -22,8 +24,9 @@ Flock::Flock(
 	, m_pAgentToEvade{ pAgentToEvade }
 	, m_NeighborhoodRadius{ 5.0f }
 	, m_NrOfNeighbors{ 0 }
-	, m_pQuadCellSpace{ new QuadCellSpace(Boundary({worldSize / 2.0f, worldSize / 2.0f}, worldSize / 2.0f), 1) }
+	, m_pQuadCellSpace{ new QuadCellSpace(Boundary({worldSize / 2.0f, worldSize / 2.0f}, worldSize / 2.0f), 16, flockSize, 1.5f) }
 	, m_pCellSpace{ new CellSpace(worldSize, worldSize, 100, 100, flockSize) }
+	, m_pSortedCellSpace{ new SortedCellSpace(worldSize, worldSize, 100, 100, flockSize) }
 	, m_DrawCellAgentCount{ false }
 	, m_DrawNeighborCells{ true }
 {
@@ -32,21 +35,24 @@ Flock::Flock(
 	// TODO: initialize the flock and the memory pool
 	InitializeFlock();
 	m_Neighbors.resize(m_FlockSize - 1);  // Don't include self in total amount of neighbours
+	m_QueryResults.resize(m_FlockSize);  // Quadtree query candidates, can include self
+	m_Candidates.resize(m_FlockSize);
+	m_IndexResults.resize(m_FlockSize);
+	m_PositionsX.resize(m_FlockSize);
+	m_PositionsY.resize(m_FlockSize);
+	m_NearbyIndices.resize(m_FlockSize);
+	m_NearbyDistancesSquared.resize(m_FlockSize);
+
+	if(!m_TrimWorld)
+		UseUnboundedSpatialIndex();
 }
 
 Flock::~Flock()
 {
 	// TODO: clean up any additional data
 
-	SAFE_DELETE(m_pBlendedSteering);
-	SAFE_DELETE(m_pPrioritySteering);
-
-	SAFE_DELETE(m_pCohesionBehavior);
-	SAFE_DELETE(m_pSeparationBehavior);
-	SAFE_DELETE(m_pVelMatchBehavior);
-	SAFE_DELETE(m_pSeekBehavior);
-	SAFE_DELETE(m_pWanderBehavior);
-	SAFE_DELETE(m_pEvadeBehavior);
+	// Also deletes the behaviors, they are stored inside the composition
+	SAFE_DELETE(m_pFlockSteering);
 
 	for(SteeringAgent* pAgent : m_Agents)
 	{
@@ -54,22 +60,40 @@ Flock::~Flock()
 	}
 	m_Agents.clear();
 	m_Neighbors.clear();
+	m_QueryResults.clear();
+	m_Candidates.clear();
+	m_IndexResults.clear();
+	m_PositionsX.clear();
+	m_PositionsY.clear();
+	m_NearbyIndices.clear();
+	m_NearbyDistancesSquared.clear();
 	m_NrOfNeighbors = 0;
 
 	SAFE_DELETE(m_pCellSpace);
+	SAFE_DELETE(m_pSortedCellSpace);
 	SAFE_DELETE(m_pQuadCellSpace);
+	SAFE_DELETE(m_pSpatialIndex);
 }
 
 void Flock::Update(float deltaT)
 {
-	// Reinit the quadtree every update
-	if(m_UseQuadCellSpace)
+	ELITE_PROFILE_SCOPE("Flock::Update");
+	if(m_UseSpatialIndex)
 	{
-		m_pQuadCellSpace->Clear();
-		for(SteeringAgent* pAgent : m_Agents)
-		{
-			m_pQuadCellSpace->AddAgent(pAgent);
-		}
+		// Positions of the start of the frame, same as the quadtree
+		m_pSpatialIndex->FitToQueryRadius(m_NeighborhoodRadius);
+		for(int agentIndex{}; agentIndex < m_FlockSize; ++agentIndex)
+			m_pSpatialIndex->Update(agentIndex, m_Agents[agentIndex]->GetPosition());
+	}
+	// Update the quadtree, only agents that left the loose bounds of their cell get moved
+	else if(m_UseQuadCellSpace)
+	{
+		m_pQuadCellSpace->UpdateAgents(m_Agents);
+	}
+	else if(m_UseSortedCellSpace)
+	{
+		// Counting sort of all agents into the grid, also a full rebuild every update
+		m_pSortedCellSpace->Rebuild(m_Agents);
 	}
 
 	TargetData evadeTarget{};
@@ -78,20 +102,41 @@ void Flock::Update(float deltaT)
 	evadeTarget.AngularVelocity = m_pAgentToEvade->GetAngularVelocity();
 
 
-	// Loop over every agent
+	// Copy the positions for the brute force neighbor search, kept up to date as agents move so it sees the same positions as before
+	if(!m_UseSpacePartitioning)
+	{
+		for(int agentIndex{}; agentIndex < m_FlockSize; ++agentIndex)
+		{
+			m_PositionsX[agentIndex] = m_Agents[agentIndex]->GetPosition().x;
+			m_PositionsY[agentIndex] = m_Agents[agentIndex]->GetPosition().y;
+		}
+	}
 
+	// The cells aren't kept up to date while another partitioning is used, refill them when switching back
+	const bool useCellSpace{ UsesCellSpace() };
+	const bool refillCellSpace{ useCellSpace && !m_IsCellSpaceUpToDate };
+	if(refillCellSpace)
+	{
+		m_pCellSpace->EmptyCells();
+		for(SteeringAgent* pAgent : m_Agents)
+			m_pCellSpace->AddAgent(pAgent);
+	}
+	m_IsCellSpaceUpToDate = useCellSpace;
 
-	for(SteeringAgent* pAgent : m_Agents)
+	// Loop over every agent
+	for(int agentIndex{}; agentIndex < m_FlockSize; ++agentIndex)
 	{
+		SteeringAgent* pAgent{ m_Agents[agentIndex] };
 		m_pEvadeBehavior->SetTarget(evadeTarget);
 		// Register every neighbour
 
 		// Check if agent moved to new cell
 
-		if(!m_UseQuadCellSpace)
+		if(useCellSpace)
 		{
-			m_pCellSpace->UpdateAgentCell(pAgent);
-			if(m_UseSpacePartitioning)
+			if(!refillCellSpace)
+				m_pCellSpace->UpdateAgentCell(pAgent);
+			if(!m_LimitNeighbors)
 				m_pCellSpace->RegisterNeighbors(pAgent, m_NeighborhoodRadius);
 		}
 		RegisterNeighbors(pAgent);
@@ -102,6 +147,12 @@ void Flock::Update(float deltaT)
 			// Trim the agent to the world
 			pAgent->TrimToWorld(m_WorldSize);
 		}
+
+		if(!m_UseSpacePartitioning)
+		{
+			m_PositionsX[agentIndex] = pAgent->GetPosition().x;
+			m_PositionsY[agentIndex] = pAgent->GetPosition().y;
+		}
 	}
 
 }
@@ -131,7 +182,8 @@ void Flock::Render(float deltaT)
 		SteeringAgent* agentToDebug{ m_Agents[0] };
 
 		// Update the neighbors to get the correct ones for the AgentToDebug (latest value will be of a (random) agent)
-		m_pCellSpace->RegisterNeighbors(agentToDebug, m_NeighborhoodRadius);
+		if(UsesCellSpace() && !m_LimitNeighbors)
+			m_pCellSpace->RegisterNeighbors(agentToDebug, m_NeighborhoodRadius);
 		RegisterNeighbors(agentToDebug);
 		const std::vector<SteeringAgent*> neighbors{ GetNeighbors() };
 		const size_t neighborCount{ size_t(GetNrOfNeighbors()) };
@@ -140,12 +192,24 @@ void Flock::Render(float deltaT)
 		if(m_UseSpacePartitioning)
 		{
 			// Draw the cell grid
-			if(m_UseQuadCellSpace)
+			if(m_UseSpatialIndex)
+			{
+				// The generic index has no debug drawing
+			}
+			else if(m_UseQuadCellSpace)
 			{
 				m_pQuadCellSpace->Render();
 				if(m_DrawNeighborCells)
 					m_pQuadCellSpace->RenderActiveCells(Boundary(agentToDebug->GetPosition(), m_NeighborhoodRadius));
 			}
+			else if(m_UseSortedCellSpace)
+			{
+				m_pSortedCellSpace->SetDrawCellAgentCount(m_DrawCellAgentCount);
+				m_pSortedCellSpace->RenderCells();
+
+				if(m_DrawNeighborCells)
+					m_pSortedCellSpace->RenderActiveCells();
+			}
 			else
 			{
 
@@ -212,6 +276,10 @@ void Flock::UpdateAndRenderUI()
 	ImGui::Indent();
 	ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 	ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+	ImGui::Text("%d steps/frame", SIMULATIONCLOCK->GetStepsThisFrame());
+	float updateRate{ SIMULATIONCLOCK->GetUpdateRate() };
+	if(ImGui::SliderFloat("Sim. Hz", &updateRate, 10.f, 120.f, "%.0f"))
+		SIMULATIONCLOCK->SetUpdateRate(updateRate);
 	ImGui::Unindent();
 
 	ImGui::Spacing();
@@ -233,23 +301,38 @@ void Flock::UpdateAndRenderUI()
 		ImGui::Checkbox("Draw Cell Agent Count", &m_DrawCellAgentCount);
 	}
 	ImGui::Spacing();
-	ImGui::Checkbox("Spatial Partitioning", &m_UseSpacePartitioning);
-
-	if(m_UseSpacePartitioning)
+	if(ImGui::Checkbox("Trim World", &m_TrimWorld))
+	{
+		if(!m_TrimWorld)
+			UseUnboundedSpatialIndex();
+		else if(GetPartitioning() == FlockPartitioning::SpatialHash)
+			SetPartitioning(m_BoundedPartitioning);  // Only when the spatial hash wasn't changed in the meantime
+	}
+	if(ImGui::Checkbox("Agent Physics", &m_UseAgentPhysics))
 	{
-		ImGui::Checkbox("Use Quadtree cells", &m_UseQuadCellSpace);
+		for(SteeringAgent* pAgent : m_Agents)
+			pAgent->SetPhysicsEnabled(m_UseAgentPhysics);
 	}
+	// Same order as FlockPartitioning
+	int partitioning{ int(GetPartitioning()) };
+	if(ImGui::Combo("Partitioning", &partitioning, "None\0Grid cells\0Quadtree cells\0Sorted grid cells\0Index: Grid\0Index: Quadtree\0Index: Spatial hash\0"))
+		SetPartitioning(FlockPartitioning(partitioning));
+	if(GetPartitioning() == FlockPartitioning::QuadCellSpace)
+		ImGui::Text("Relocated: %d", m_pQuadCellSpace->GetNrOfRelocations());
 
 	ImGui::Spacing();
 	ImGui::Spacing();
 	ImGui::SliderFloat("Neighborhood Radius", &m_NeighborhoodRadius, 3.f, 20.f, "%.1f");
+	ImGui::Checkbox("Limit Neighbors", &m_LimitNeighbors);
+	if(m_LimitNeighbors)
+		ImGui::SliderInt("Max Neighbors", &m_MaxNeighbors, 1, 64);
 	ImGui::Spacing();
 	ImGui::Spacing();
-	ImGui::SliderFloat("Cohesion", &m_pBlendedSteering->GetWeightedBehaviorsRef()[0].weight, 0.f, 1.f, "%.2f");
-	ImGui::SliderFloat("Seperation", &m_pBlendedSteering->GetWeightedBehaviorsRef()[1].weight, 0.f, 1.f, "%.2f");
-	ImGui::SliderFloat("Velocity Match", &m_pBlendedSteering->GetWeightedBehaviorsRef()[2].weight, 0.f, 1.f, "%.2f");
-	ImGui::SliderFloat("Seek", &m_pBlendedSteering->GetWeightedBehaviorsRef()[3].weight, 0.f, 1.f, "%.2f");
-	ImGui::SliderFloat("Wander", &m_pBlendedSteering->GetWeightedBehaviorsRef()[4].weight, 0.f, 1.f, "%.2f");
+	ImGui::SliderFloat("Cohesion", &m_pBlendedSteering->GetWeightRef(0), 0.f, 1.f, "%.2f");
+	ImGui::SliderFloat("Seperation", &m_pBlendedSteering->GetWeightRef(1), 0.f, 1.f, "%.2f");
+	ImGui::SliderFloat("Velocity Match", &m_pBlendedSteering->GetWeightRef(2), 0.f, 1.f, "%.2f");
+	ImGui::SliderFloat("Seek", &m_pBlendedSteering->GetWeightRef(3), 0.f, 1.f, "%.2f");
+	ImGui::SliderFloat("Wander", &m_pBlendedSteering->GetWeightRef(4), 0.f, 1.f, "%.2f");
 
 	//End
 	ImGui::PopAllowKeyboardFocus();
@@ -263,28 +346,87 @@ void Flock::RegisterNeighbors(SteeringAgent* pAgent)
 	m_NrOfNeighbors = 0;
 
 
-	std::vector<SteeringAgent*> agentList{};
+	// Point to the candidate list instead of copying it
+	const std::vector<SteeringAgent*>* pAgentList{ nullptr };
 	size_t agentAmount{};
 
 	if(m_UseSpacePartitioning)
 	{
-		if(m_UseQuadCellSpace)
+		if(m_UseSpatialIndex)
+		{
+			// Ids are the agent indices, the loop below does the exact check on the current positions
+			agentAmount = m_pSpatialIndex->QueryRadius(pAgent->GetPosition(), m_NeighborhoodRadius, m_IndexResults);
+			for(size_t resultIndex{}; resultIndex < agentAmount; ++resultIndex)
+				m_QueryResults[resultIndex] = m_Agents[m_IndexResults[resultIndex]];
+			pAgentList = &m_QueryResults;
+		}
+		else if(!m_UseQuadCellSpace && m_UseSortedCellSpace)
+		{
+			// The sorted grid already does the distance check on its own position snapshot
+			if(m_LimitNeighbors)
+				m_pSortedCellSpace->RegisterNearestNeighbors(pAgent, m_NeighborhoodRadius, m_MaxNeighbors);
+			else
+				m_pSortedCellSpace->RegisterNeighbors(pAgent, m_NeighborhoodRadius);
+			m_NrOfNeighbors = m_pSortedCellSpace->GetNrOfNeighbors();
+
+			const std::vector<SteeringAgent*>& neighbors{ m_pSortedCellSpace->GetNeighbors() };
+			std::copy(neighbors.begin(), neighbors.begin() + m_NrOfNeighbors, m_Neighbors.begin());
+			return;
+		}
+		else if(m_UseQuadCellSpace)
+		{
+			if(m_LimitNeighbors)
+			{
+				// The tree selects the nearest itself, straight into the neighbor buffer
+				m_NrOfNeighbors = m_pQuadCellSpace->QueryNearest(pAgent->GetPosition(), m_NeighborhoodRadius, m_MaxNeighbors, m_Neighbors, pAgent);
+				return;
+			}
+
+			agentAmount = m_pQuadCellSpace->QueryRange(Boundary(pAgent->GetPosition(), m_NeighborhoodRadius), m_QueryResults);
+			pAgentList = &m_QueryResults;
+		}
+		else if(m_LimitNeighbors)
 		{
-			agentList = m_pQuadCellSpace->QueryRange(Boundary(pAgent->GetPosition(), m_NeighborhoodRadius));
-			agentAmount = agentList.size();
+			m_pCellSpace->RegisterNearestNeighbors(pAgent, m_NeighborhoodRadius, m_MaxNeighbors);
+			m_NrOfNeighbors = m_pCellSpace->GetNrOfNeighbors();
+
+			const std::vector<SteeringAgent*>& neighbors{ m_pCellSpace->GetNeighbors() };
+			std::copy(neighbors.begin(), neighbors.begin() + m_NrOfNeighbors, m_Neighbors.begin());
+			return;
 		}
 		else
 		{
-			agentList = m_pCellSpace->GetNeighbors();
+			pAgentList = &m_pCellSpace->GetNeighbors();
 			agentAmount = m_pCellSpace->GetNrOfNeighbors();
 		}
 	}
 	else
 	{
-		agentList = m_Agents;
-		agentAmount = m_Agents.size();
+		// Distance filter over every agent at once, only the agents within the radius are visited afterwards
+		const int nrOfNearby{ SIMD::FilterWithinDistanceSquared(m_PositionsX.data(), m_PositionsY.data(), m_FlockSize, pAgent->GetPosition(),
+			Square(m_NeighborhoodRadius), m_NearbyIndices.data(), m_NearbyDistancesSquared.data()) };
+
+		int nrOfCandidates{ 0 };
+		for(int nearbyIndex{}; nearbyIndex < nrOfNearby; ++nearbyIndex)
+		{
+			SteeringAgent* pOther{ m_Agents[m_NearbyIndices[nearbyIndex]] };
+			if(pOther == pAgent)
+				continue;
+
+			if(m_LimitNeighbors)
+				m_Candidates[nrOfCandidates++] = { m_NearbyDistancesSquared[nearbyIndex], pOther };
+			else
+				m_Neighbors[m_NrOfNeighbors++] = pOther;
+		}
+
+		if(m_LimitNeighbors)
+			m_NrOfNeighbors = SelectNearestNeighbors(m_Candidates, nrOfCandidates, m_MaxNeighbors, m_Neighbors);
+		return;
 	}
 
+	const std::vector<SteeringAgent*>& agentList{ *pAgentList };
+	int nrOfCandidates{ 0 };
+
 	for(size_t agentIndex{}; agentIndex < agentAmount; ++agentIndex)
 	{
 		// Check if not self
@@ -299,10 +441,20 @@ void Flock::RegisterNeighbors(SteeringAgent* pAgent)
 		// Check if distance within squared neighbour radius
 		if(distanceSquared < Square(m_NeighborhoodRadius))
 		{
+			// Keep the distance when limiting, only the nearest get selected afterwards
+			if(m_LimitNeighbors)
+			{
+				m_Candidates[nrOfCandidates++] = { distanceSquared, agentList[agentIndex] };
+				continue;
+			}
+
 			// Add to memory pool & increase m_NrOfNeighbors afterwards (++ behind the var)
 			m_Neighbors[m_NrOfNeighbors++] = agentList[agentIndex];
 		}
 	}
+
+	if(m_LimitNeighbors)
+		m_NrOfNeighbors = SelectNearestNeighbors(m_Candidates, nrOfCandidates, m_MaxNeighbors, m_Neighbors);
 }
 
 Elite::Vector2 Flock::GetAverageNeighborPos() const
@@ -340,21 +492,80 @@ void Flock::SetTarget_Seek(TargetData target)
 float* Flock::GetWeight(ISteeringBehavior* pBehavior)
 {
 	if(m_pBlendedSteering)
+		return m_pBlendedSteering->FindWeight(pBehavior);
+
+	return nullptr;
+}
+
+void Flock::SetPartitioning(FlockPartitioning partitioning)
+{
+	m_UseSpacePartitioning = partitioning != FlockPartitioning::None;
+	m_UseQuadCellSpace = partitioning == FlockPartitioning::QuadCellSpace;
+	m_UseSortedCellSpace = partitioning == FlockPartitioning::SortedCellSpace;
+	m_UseSpatialIndex = false;
+
+	switch(partitioning)
 	{
-		auto& weightedBehaviors = m_pBlendedSteering->GetWeightedBehaviorsRef();
-		auto it = find_if(weightedBehaviors.begin(),
-			weightedBehaviors.end(),
-			[pBehavior](BlendedSteering::WeightedBehavior el)
-			{
-				return el.pBehavior == pBehavior;
-			}
-		);
+	case FlockPartitioning::SpatialIndexGrid:
+		m_SpatialIndexType = int(SpatialIndexType::Grid);
+		break;
+	case FlockPartitioning::SpatialIndexQuadTree:
+		m_SpatialIndexType = int(SpatialIndexType::QuadTree);
+		break;
+	case FlockPartitioning::SpatialHash:
+		m_SpatialIndexType = int(SpatialIndexType::SpatialHash);
+		break;
+	default:
+		return;
+	}
 
-		if(it != weightedBehaviors.end())
-			return &it->weight;
+	m_UseSpatialIndex = true;
+	CreateSpatialIndex();
+}
+
+FlockPartitioning Flock::GetPartitioning() const
+{
+	if(!m_UseSpacePartitioning)
+		return FlockPartitioning::None;
+
+	if(m_UseSpatialIndex)
+	{
+		switch(SpatialIndexType(m_SpatialIndexType))
+		{
+		case SpatialIndexType::Grid: return FlockPartitioning::SpatialIndexGrid;
+		case SpatialIndexType::QuadTree: return FlockPartitioning::SpatialIndexQuadTree;
+		default: return FlockPartitioning::SpatialHash;
+		}
 	}
 
-	return nullptr;
+	// Same priority as Update
+	if(m_UseQuadCellSpace)
+		return FlockPartitioning::QuadCellSpace;
+	if(m_UseSortedCellSpace)
+		return FlockPartitioning::SortedCellSpace;
+	return FlockPartitioning::CellSpace;
+}
+
+void Flock::CreateSpatialIndex()
+{
+	// Cell size based on the neighborhood radius, so a query only touches a few cells
+	SAFE_DELETE(m_pSpatialIndex);
+	m_pSpatialIndex = ::CreateSpatialIndex(SpatialIndexType(m_SpatialIndexType), m_WorldSize, std::max(m_NeighborhoodRadius, 1.0f) * 2.0f);
+
+	for(int agentIndex{}; agentIndex < m_FlockSize; ++agentIndex)
+		m_pSpatialIndex->Insert(agentIndex, m_Agents[agentIndex]->GetPosition());
+}
+
+bool Flock::UsesCellSpace() const
+{
+	return m_UseSpacePartitioning && !m_UseSpatialIndex && !m_UseQuadCellSpace && !m_UseSortedCellSpace;
+}
+
+void Flock::UseUnboundedSpatialIndex()
+{
+	// Agents that leave the world would all end up in the border cells of the bounded structures
+	m_BoundedPartitioning = GetPartitioning();
+	SetPartitioning(FlockPartitioning::SpatialHash);
 }
 
 void Flock::InitializeFlock()
@@ -362,22 +573,23 @@ void Flock::InitializeFlock()
 	// Initializes the steering behaviours for the flock	
 	// Initializes the all flock agents and gives them a position evenly on the grid
 
-	m_pCohesionBehavior = new Cohesion(this);
-	m_pSeparationBehavior = new Separation(this);
-	m_pVelMatchBehavior = new VelocityMatch(this);
-	m_pSeekBehavior = new Seek();
-	m_pWanderBehavior = new Wander();
-	m_pEvadeBehavior = new Evade();
-	m_pEvadeBehavior->SetEvadeRadius(50.0f);
+	Evade evade{};
+	evade.SetEvadeRadius(50.0f);
+
+	m_pFlockSteering = new FlockSteering(
+		evade,
+		FlockBlendedSteering({ 0.45f, 0.52f, 0.23f, 0.00f, 0.60f },
+			Cohesion(this), Separation(this), VelocityMatch(this), Seek(), Wander())
+	);
 
-	m_pBlendedSteering = new BlendedSteering({
-		{m_pCohesionBehavior, 0.45f},
-		{m_pSeparationBehavior, 0.52f},
-		{m_pVelMatchBehavior, 0.23f},
-		{m_pSeekBehavior, 0.00f},
-		{m_pWanderBehavior, 0.60f}
-		});
-	m_pPrioritySteering = new PrioritySteering({ m_pEvadeBehavior, m_pBlendedSteering });
+	// Pointers into the composition, targets and weights are still set on the individual behaviors
+	m_pEvadeBehavior = &m_pFlockSteering->GetComposition().Get<0>();
+	m_pBlendedSteering = &m_pFlockSteering->GetComposition().Get<1>();
+	m_pCohesionBehavior = &m_pBlendedSteering->Get<0>();
+	m_pSeparationBehavior = &m_pBlendedSteering->Get<1>();
+	m_pVelMatchBehavior = &m_pBlendedSteering->Get<2>();
+	m_pSeekBehavior = &m_pBlendedSteering->Get<3>();
+	m_pWanderBehavior = &m_pBlendedSteering->Get<4>();
 
 
 	// Split up the view into grid and randomly assign an agent to that spot
@@ -390,25 +602,23 @@ void Flock::InitializeFlock()
 			// Calc agent count / index
 			const int agentIndex{ rowIndex * gridSize + columnIndex };
 			if(agentIndex >= m_FlockSize) break;  // Stop the function when enough are created
-			std::cout << agentIndex << "\n";
-
-
 
 			// Calc position (+ random to have some randomizations)
 			const float x = ((float(columnIndex) + Elite::randomFloat(0.1f, 0.9f)) / float(gridSize)) * m_WorldSize;
 			const float y = ((float(rowIndex) + Elite::randomFloat(0.1f, 0.9f)) / float(gridSize)) * m_WorldSize;
 
 			// Create agent
-			SteeringAgent* pAgent = new SteeringAgent();
+			SteeringAgent* pAgent = new SteeringAgent(1.0f, m_UseAgentPhysics);
 
 			// Set position & init other agent variables
 			pAgent->SetPosition(Elite::Vector2{ x, y });
 			pAgent->SetOldPosition(pAgent->GetPosition());
-			pAgent->SetSteeringBehavior(m_pPrioritySteering);
+			pAgent->SetSteeringBehavior(m_pFlockSteering);
 			pAgent->SetMaxLinearSpeed(55.0f);
 			pAgent->SetMaxAngularSpeed(25.0f);
 			pAgent->SetAutoOrient(true);
 			pAgent->SetMass(1.0f);
+			pAgent->SetRenderInterpolation(true); // Updated in App_Flocking::FixedUpdate
 
 
 			// Add to flock pool
@@ -1,13 +1,33 @@
 #pragma once
 #include "../SteeringHelpers.h"
 #include "FlockingSteeringBehaviors.h"
+#include "../SpacePartitioning/NearestNeighbors.h"
 
 class ISteeringBehavior;
 class SteeringAgent;
-class BlendedSteering;
-class PrioritySteering;
+template<typename... Behaviors> class Blended;
+template<typename... Behaviors> class Priority;
+template<typename Composition> class ComposedSteering;
 class CellSpace;
+class SortedCellSpace;
 class QuadCellSpace;
+class ISpatialIndex;
+
+// Evade has priority, otherwise the flocking behaviors are blended (composed at compile time, see ComposedSteering.h)
+using FlockBlendedSteering = Blended<Cohesion, Separation, VelocityMatch, Seek, Wander>;
+using FlockSteering = ComposedSteering<Priority<Evade, FlockBlendedSteering>>;
+
+// Neighbor search used by the flock, the UI combo box lists these in the same order
+enum class FlockPartitioning
+{
+	None,  // Brute force over all agents
+	CellSpace,
+	QuadCellSpace,
+	SortedCellSpace,
+	SpatialIndexGrid,
+	SpatialIndexQuadTree,
+	SpatialHash
+};
 
 class Flock final
 {
@@ -32,6 +52,9 @@ public:
 	Elite::Vector2 GetAverageNeighborVelocity() const;
 
 	float GetNeighborhoodRadius() const { return m_NeighborhoodRadius; }
+	void SetNeighborhoodRadius(float radius) { m_NeighborhoodRadius = radius; }  // The spatial index fits itself to the radius on Update
+	void SetPartitioning(FlockPartitioning partitioning);
+	FlockPartitioning GetPartitioning() const;
 
 	void SetTarget_Seek(TargetData target);
 	void SetWorldTrimSize(float size) { m_WorldSize = size; }
@@ -42,18 +65,34 @@ private:
 
 	std::vector<SteeringAgent*> m_Agents;
 	std::vector<SteeringAgent*> m_Neighbors;
+	std::vector<SteeringAgent*> m_QueryResults;
+	std::vector<NeighborCandidate> m_Candidates;  // Input of SelectNearestNeighbors when the neighbors are limited and the search doesn't pick the nearest itself (brute force, spatial index)
+	std::vector<int> m_IndexResults;  // Ids (agent indices) returned by the spatial index
+	std::vector<float> m_PositionsX;  // Agent positions as separate x and y arrays for the SIMD distance filter without space partitioning
+	std::vector<float> m_PositionsY;
+	std::vector<int> m_NearbyIndices;
+	std::vector<float> m_NearbyDistancesSquared;
 
 	bool m_TrimWorld = false;
+	FlockPartitioning m_BoundedPartitioning{ FlockPartitioning::QuadCellSpace };  // Restored when the world is trimmed again
 	float m_WorldSize = 0.f;
 
 	bool m_CanDebugRender{ false };
 	bool m_RenderAgents{ false };
 	bool m_UseSpacePartitioning{ true };
 	bool m_UseQuadCellSpace{ true };
+	bool m_UseSortedCellSpace{ false };
+	bool m_UseSpatialIndex{ false };
+	bool m_UseAgentPhysics{ false };  // Boids don't need to collide, without rigidbody they skip the physics world completely
+	int m_SpatialIndexType{ 0 };  // SpatialIndexType, used while m_UseSpatialIndex is set
 
 	float m_NeighborhoodRadius = 5.f;
 	int m_NrOfNeighbors = 0;
 
+	// Only keep the nearest neighbors, keeps the cost per agent bounded in dense clumps
+	bool m_LimitNeighbors{ false };
+	int m_MaxNeighbors{ 16 };
+
 
 	bool m_DrawNeighborCells;
 	bool m_HighlightNeighbors;
@@ -62,7 +101,7 @@ private:
 
 	SteeringAgent* m_pAgentToEvade = nullptr;
 
-	//Steering Behaviors
+	//Steering Behaviors, all owned by m_pFlockSteering
 	Seek* m_pSeekBehavior = nullptr;
 	Separation* m_pSeparationBehavior = nullptr;
 	Cohesion* m_pCohesionBehavior = nullptr;
@@ -70,12 +109,15 @@ private:
 	Wander* m_pWanderBehavior = nullptr;
 	Evade* m_pEvadeBehavior = nullptr;
 
-	BlendedSteering* m_pBlendedSteering = nullptr;
-	PrioritySteering* m_pPrioritySteering = nullptr;
+	FlockBlendedSteering* m_pBlendedSteering = nullptr;
+	FlockSteering* m_pFlockSteering = nullptr;
 
 	// Cellspace
 	CellSpace* m_pCellSpace;
+	SortedCellSpace* m_pSortedCellSpace;
 	QuadCellSpace* m_pQuadCellSpace;
+	ISpatialIndex* m_pSpatialIndex{ nullptr };
+	bool m_IsCellSpaceUpToDate{ true };  // Only updated while it is the active partitioning
 
 	float* GetWeight(ISteeringBehavior* pBehaviour);
 
@@ -85,4 +127,7 @@ private:
 
 
 	void InitializeFlock();
+	void CreateSpatialIndex();
+	bool UsesCellSpace() const;
+	void UseUnboundedSpatialIndex();  // Switches to the spatial hash, the other structures only cover the world size
 };
\ No newline at end of file
@@ -11,6 +11,9 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Uses the neighbors registered for the agent, so batches go through CalculateSteering instead of the Seek batch
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override
+	{ ISteeringBehavior::CalculateSteeringBatch(deltaT, states, outputs); }
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -25,6 +28,9 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Uses the neighbors registered for the agent, so batches go through CalculateSteering instead of the Seek batch
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override
+	{ ISteeringBehavior::CalculateSteeringBatch(deltaT, states, outputs); }
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -39,6 +45,9 @@ public:
 
 	//Cohesion Behavior
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Uses the neighbors registered for the agent, so batches go through CalculateSteering instead of the Seek batch
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override
+	{ ISteeringBehavior::CalculateSteeringBatch(deltaT, states, outputs); }
 
 private:
 	Flock* m_pFlock = nullptr;
@@ -1,6 +1,5 @@
 #include "stdafx.h"
 #include "HierarchicalSpacePartitioning.h"
-#include "stdafx.h"
 #include "projects\Movement\SteeringBehaviors\SteeringAgent.h"
 
 // --- BOUNDARY STRUCT ---
@@ -60,213 +59,373 @@ std::vector<Elite::Vector2> Boundary::GetRectPoints() const
 
 // --- Partitioned Space ---
 // -------------------------
-QuadCellSpace::QuadCellSpace(const Boundary& _boundary, int _bucketSize):
+QuadCellSpace::QuadCellSpace(const Boundary& _boundary, int _bucketSize, int _maxEntities, float _looseness):
 	m_Boundary{ _boundary },
-	m_MaxAgentsPerCell{ _bucketSize }
+	m_MaxAgentsPerCell{ _bucketSize },
+	m_Looseness{ _looseness },
+	m_Nodes(1 + 2 * (_maxEntities / _bucketSize + 1) * 4),  // Rough guess, the pools grow when needed
+	m_NrOfNodes{ 1 },
+	m_Entries(std::max(_maxEntities, 1)),
+	m_NrOfEntries{ 0 },
+	m_NrOfNodesAfterRebuild{ 1 },
+	m_UpdatesSinceRebuild{ 0 },
+	m_NrOfRelocations{ 0 },
+	m_Candidates(std::max(_maxEntities, 1))
 {
-	m_Agents.reserve(_bucketSize);
-
+	m_Nodes[0].boundary = m_Boundary;
 }
 
 bool QuadCellSpace::AddAgent(SteeringAgent* pAgent)
 {
+	const Elite::Vector2 position{ pAgent->GetPosition() };
+
 	// Check if agent is in boundary or not
-	if(!m_Boundary.Contains(pAgent->GetPosition()))
+	if(!m_Boundary.Contains(position))
 		return false; // Agent not in boundary
 
-	// Check if cell is subdivided or not, and if it still has space
-	if(m_LeftTop == nullptr && int(m_Agents.size()) < m_MaxAgentsPerCell)
+	// Only grows when more agents are added than ever before
+	if(m_NrOfEntries == int(m_Entries.size()))
+		m_Entries.resize(m_Entries.size() * 2);
+
+	QuadEntry& entry{ m_Entries[m_NrOfEntries] };
+	entry.pAgent = pAgent;
+	entry.position = position;
+	entry.next = -1;
+	entry.leaf = -1;
+
+	InsertEntry(0, m_NrOfEntries++);
+	return true;
+}
+
+void QuadCellSpace::Rebuild(const std::vector<SteeringAgent*>& agents)
+{
+	Clear();
+
+	const int nrOfAgents{ int(agents.size()) };
+	if(nrOfAgents > int(m_Entries.size()))
+		m_Entries.resize(nrOfAgents);
+
+	// Every agent gets an entry, also the ones outside of the space, so they can be inserted once they come back
+	for(int agentIndex{}; agentIndex < nrOfAgents; ++agentIndex)
 	{
-		m_Agents.push_back(pAgent);
-		return true;
+		QuadEntry& entry{ m_Entries[agentIndex] };
+		entry.pAgent = agents[agentIndex];
+		entry.position = agents[agentIndex]->GetPosition();
+		entry.next = -1;
+		entry.leaf = -1;
+
+		if(m_Boundary.Contains(entry.position))
+			InsertEntry(0, agentIndex);
 	}
+	m_NrOfEntries = nrOfAgents;
 
-	// Subdivide if not yet subdivided
-	if(m_LeftTop == nullptr)
-		Subdivide();
-
-	// We dont want to add agents to a subdivided cell (since its children need to hold the data instead)
-	// So we check if the agent is in the children cells
-	if(m_LeftTop->AddAgent(pAgent))
-		return true;
-	if(m_RightTop->AddAgent(pAgent))
-		return true;
-	if(m_LeftBottom->AddAgent(pAgent))
-		return true;
-	if(m_RightBottom->AddAgent(pAgent))
-		return true;
-
-	// Shouldn't ever happen
-	std::cout << "FAILED TO INSERT INTO THE QUADTREE" << std::endl;
-	return false;
+	m_NrOfNodesAfterRebuild = m_NrOfNodes;
+	m_UpdatesSinceRebuild = 0;
+	m_NrOfRelocations = nrOfAgents;
 }
 
-void QuadCellSpace::Subdivide()
+void QuadCellSpace::UpdateAgents(const std::vector<SteeringAgent*>& agents)
 {
-	// Subdivides the current tree
-	// Needs to add its current cells to the children
-
-	// Calculate the new halfsize
-	float newHalfSize = m_Boundary.HalfSize / 2.f;
-
-	// Calculate the centers
-	Elite::Vector2 leftTopCenter{ m_Boundary.Center.x - newHalfSize, m_Boundary.Center.y + newHalfSize };
-	Elite::Vector2 rightTopCenter{ m_Boundary.Center.x + newHalfSize, m_Boundary.Center.y + newHalfSize };
-	Elite::Vector2 leftBottomCenter{ m_Boundary.Center.x - newHalfSize, m_Boundary.Center.y - newHalfSize };
-	Elite::Vector2 rightBottomCenter{ m_Boundary.Center.x + newHalfSize, m_Boundary.Center.y - newHalfSize };
-
-	// Create the new boundaries
-	Boundary leftTopBoundary{ leftTopCenter, newHalfSize };
-	Boundary rightTopBoundary{ rightTopCenter, newHalfSize };
-	Boundary leftBottomBoundary{ leftBottomCenter, newHalfSize };
-	Boundary rightBottomBoundary{ rightBottomCenter, newHalfSize };
-
-	// Create the new children
-	m_LeftTop = new QuadCellSpace(leftTopBoundary, m_MaxAgentsPerCell);
-	m_RightTop = new QuadCellSpace(rightTopBoundary, m_MaxAgentsPerCell);
-	m_LeftBottom = new QuadCellSpace(leftBottomBoundary, m_MaxAgentsPerCell);
-	m_RightBottom = new QuadCellSpace(rightBottomBoundary, m_MaxAgentsPerCell);
-
-	// Add the current agents to the children
-	for(SteeringAgent* pAgent : m_Agents)
+	const int nrOfAgents{ int(agents.size()) };
+
+	// Entries only map on the agents after a Rebuild with the same agents
+	// Leaves are never merged, so also rebuild when the tree has grown a lot or once every while
+	if(nrOfAgents != m_NrOfEntries || m_NrOfNodes > 2 * m_NrOfNodesAfterRebuild || ++m_UpdatesSinceRebuild >= m_UpdatesPerRebuild)
 	{
-		AddAgent(pAgent); // Should work since it will now find the children
+		Rebuild(agents);
+		return;
 	}
 
-	// Clear the current agents
-	m_Agents.clear();
+	m_NrOfRelocations = 0;
+	for(int agentIndex{}; agentIndex < nrOfAgents; ++agentIndex)
+	{
+		if(m_Entries[agentIndex].pAgent != agents[agentIndex])
+		{
+			Rebuild(agents);
+			return;
+		}
+
+		const Elite::Vector2 position{ agents[agentIndex]->GetPosition() };
+		const int leafIndex{ m_Entries[agentIndex].leaf };
+
+		// Still inside the loose bounds of its leaf, only update the position snapshot
+		if(leafIndex != -1 && m_Boundary.Contains(position) && GetLooseBoundary(m_Nodes[leafIndex]).Contains(position))
+		{
+			m_Entries[agentIndex].position = position;
+			continue;
+		}
+
+		// Moved out, relocate it starting from the root
+		if(leafIndex != -1)
+			RemoveEntry(agentIndex);
+
+		m_Entries[agentIndex].position = position;
+		if(m_Boundary.Contains(position))
+		{
+			InsertEntry(0, agentIndex);
+			++m_NrOfRelocations;
+		}
+	}
 }
 
-void QuadCellSpace::Clear()
+void QuadCellSpace::RemoveEntry(int entryIndex)
+{
+	QuadEntry& entry{ m_Entries[entryIndex] };
+	QuadNode& leaf{ m_Nodes[entry.leaf] };
+
+	// Unlink it from the entry list of the leaf (at most a bucket long)
+	int* pLink{ &leaf.firstEntry };
+	while(*pLink != entryIndex)
+		pLink = &m_Entries[*pLink].next;
+	*pLink = entry.next;
+	--leaf.nrOfEntries;
+
+	entry.next = -1;
+	entry.leaf = -1;
+}
+
+void QuadCellSpace::InsertEntry(int nodeIndex, int entryIndex)
 {
-	// Clear the current agents
-	m_Agents.clear();
+	const Elite::Vector2 position{ m_Entries[entryIndex].position };
 
-	// Clear the children
-	if(m_LeftTop != nullptr)
+	while(true)
 	{
-		m_LeftTop->Clear();
-		m_RightTop->Clear();
-		m_LeftBottom->Clear();
-		m_RightBottom->Clear();
-
-		delete m_LeftTop;
-		delete m_RightTop;
-		delete m_LeftBottom;
-		delete m_RightBottom;
-
-		m_LeftTop = nullptr;
-		m_RightTop = nullptr;
-		m_LeftBottom = nullptr;
-		m_RightBottom = nullptr;
+		// Subdivided nodes don't hold agents themselves, go down to the child that contains the position
+		if(m_Nodes[nodeIndex].firstChild != -1)
+		{
+			nodeIndex = m_Nodes[nodeIndex].firstChild + GetChildIndex(m_Nodes[nodeIndex], position);
+			continue;
+		}
+
+		// Full leaf, split it and try again
+		if(m_Nodes[nodeIndex].nrOfEntries >= m_MaxAgentsPerCell && m_Nodes[nodeIndex].depth < m_MaxDepth)
+		{
+			Subdivide(nodeIndex);
+			continue;
+		}
+
+		QuadNode& leaf{ m_Nodes[nodeIndex] };
+		m_Entries[entryIndex].next = leaf.firstEntry;
+		m_Entries[entryIndex].leaf = nodeIndex;
+		leaf.firstEntry = entryIndex;
+		++leaf.nrOfEntries;
+		return;
 	}
 }
 
-void QuadCellSpace::Render()
+void QuadCellSpace::Subdivide(int nodeIndex)
 {
-	// If subdivided, render the children
-	if(m_LeftTop != nullptr)
+	// Grab 4 consecutive nodes from the pool (only grows when the tree gets bigger than ever before)
+	if(m_NrOfNodes + 4 > int(m_Nodes.size()))
+		m_Nodes.resize(m_Nodes.size() * 2);
+
+	const int firstChild{ m_NrOfNodes };
+	m_NrOfNodes += 4;
+
+	QuadNode& node{ m_Nodes[nodeIndex] };
+
+	// Calculate the new halfsize and the centers
+	const float newHalfSize{ node.boundary.HalfSize / 2.f };
+	const Elite::Vector2 center{ node.boundary.Center };
+	const Elite::Vector2 childCenters[4]
+	{
+		{ center.x - newHalfSize, center.y + newHalfSize },  // Left top
+		{ center.x + newHalfSize, center.y + newHalfSize },  // Right top
+		{ center.x - newHalfSize, center.y - newHalfSize },  // Left bottom
+		{ center.x + newHalfSize, center.y - newHalfSize }   // Right bottom
+	};
+
+	for(int childIndex{}; childIndex < 4; ++childIndex)
 	{
-		m_LeftTop->Render();
-		m_RightTop->Render();
-		m_LeftBottom->Render();
-		m_RightBottom->Render();
+		QuadNode& child{ m_Nodes[firstChild + childIndex] };
+		child.boundary = Boundary(childCenters[childIndex], newHalfSize);
+		child.firstChild = -1;
+		child.firstEntry = -1;
+		child.nrOfEntries = 0;
+		child.depth = node.depth + 1;
 	}
-	else
+
+	// Move the current entries to the children
+	// With loose leaves an entry can lie outside of the loose bounds of the child, those get reinserted from the root
+	int pendingEntryIndex{ -1 };
+	int entryIndex{ node.firstEntry };
+	while(entryIndex != -1)
 	{
-		// Render own boundary
-		const Elite::Color gridColor{ 0.67f, 0.67f, 0.0f, 0.8f };
-		std::vector<Elite::Vector2> rectPoints = m_Boundary.GetRectPoints();
+		QuadEntry& entry{ m_Entries[entryIndex] };
+		const int nextEntryIndex{ entry.next };
 
-		//// Create Polygon object with the rectPoints
-		DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), gridColor, DEBUGRENDERER2D->NextDepthSlice());
-		//Elite::Vector2 leftTop = rectPoints[1];
-		//leftTop.x += 1.0f;
-		//leftTop.y -= 1.0f;
+		const int childNodeIndex{ firstChild + GetChildIndex(node, entry.position) };
+		QuadNode& child{ m_Nodes[childNodeIndex] };
+		if(GetLooseBoundary(child).Contains(entry.position))
+		{
+			entry.next = child.firstEntry;
+			entry.leaf = childNodeIndex;
+			child.firstEntry = entryIndex;
+			++child.nrOfEntries;
+		}
+		else
+		{
+			entry.next = pendingEntryIndex;
+			entry.leaf = -1;
+			pendingEntryIndex = entryIndex;
+		}
 
-		//if(m_DrawCellAgentCount)
+		entryIndex = nextEntryIndex;
+	}
+
+	node.firstChild = firstChild;
+	node.firstEntry = -1;
+	node.nrOfEntries = 0;
 
-		//	DEBUGRENDERER2D->DrawString(leftTop, std::to_string(c->agents.size()).c_str());
+	// All entries could have ended up in the same child
+	for(int childIndex{ firstChild }; childIndex < firstChild + 4; ++childIndex)
+	{
+		if(m_Nodes[childIndex].nrOfEntries > m_MaxAgentsPerCell && m_Nodes[childIndex].depth < m_MaxDepth)
+			Subdivide(childIndex);
 	}
+
+	while(pendingEntryIndex != -1)
+	{
+		const int nextEntryIndex{ m_Entries[pendingEntryIndex].next };
+		m_Entries[pendingEntryIndex].next = -1;
+		InsertEntry(0, pendingEntryIndex);
+		pendingEntryIndex = nextEntryIndex;
+	}
+}
+
+int QuadCellSpace::GetChildIndex(const QuadNode& node, const Elite::Vector2& position) const
+{
+	// Same order as the children are created: left top, right top, left bottom, right bottom
+	const int column{ position.x < node.boundary.Center.x ? 0 : 1 };
+	const int row{ position.y < node.boundary.Center.y ? 1 : 0 };
+	return row * 2 + column;
+}
+
+void QuadCellSpace::Clear()
+{
+	// Only the root stays, the rest of the pools gets overwritten on the next inserts
+	m_NrOfNodes = 1;
+	m_NrOfEntries = 0;
+
+	QuadNode& root{ m_Nodes[0] };
+	root.firstChild = -1;
+	root.firstEntry = -1;
+	root.nrOfEntries = 0;
 }
 
-void QuadCellSpace::RenderActiveCells(const Boundary& boundary)
+void QuadCellSpace::Render() const
 {
-	// Colors all cells in this boundary green
-	// If subdivided, render the children
-	if(m_LeftTop != nullptr)
+	const Elite::Color gridColor{ 0.67f, 0.67f, 0.0f, 0.8f };
+	for(int nodeIndex{}; nodeIndex < m_NrOfNodes; ++nodeIndex)
 	{
-		m_LeftTop->RenderActiveCells(boundary);
-		m_RightTop->RenderActiveCells(boundary);
-		m_LeftBottom->RenderActiveCells(boundary);
-		m_RightBottom->RenderActiveCells(boundary);
+		// Only render the leaves, the subdivided nodes are covered by their children
+		if(m_Nodes[nodeIndex].firstChild != -1)
+			continue;
+
+		std::vector<Elite::Vector2> rectPoints = m_Nodes[nodeIndex].boundary.GetRectPoints();
+		DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), gridColor, DEBUGRENDERER2D->NextDepthSlice());
 	}
-	else
-	{
-		// Check if this cell is inside the given boundary
-		if(boundary.Intersects(m_Boundary))
-		{
-			// Render own boundary
-			const Elite::Color activeColor{ 0.0f, 1.0f, 0.0f, 0.8f };
-			std::vector<Elite::Vector2> rectPoints = m_Boundary.GetRectPoints();
+}
 
-			// Create Polygon object with the rectPoints
-			DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), activeColor, -0.1f);
-		}
+void QuadCellSpace::RenderActiveCells(const Boundary& boundary) const
+{
+	// Colors all leaves in this boundary green
+	const Elite::Color activeColor{ 0.0f, 1.0f, 0.0f, 0.8f };
+	for(int nodeIndex{}; nodeIndex < m_NrOfNodes; ++nodeIndex)
+	{
+		const QuadNode& node{ m_Nodes[nodeIndex] };
+		if(node.firstChild != -1 || !boundary.Intersects(GetLooseBoundary(node)))
+			continue;
 
+		std::vector<Elite::Vector2> rectPoints = node.boundary.GetRectPoints();
+		DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), activeColor, -0.1f);
 	}
 }
 
-std::vector<SteeringAgent*> QuadCellSpace::QueryRange(const Boundary& queryRange) const
+int QuadCellSpace::QueryRange(const Boundary& queryRange, std::vector<SteeringAgent*>& results) const
 {
-	// Find all the agents within the given range
-
-	// Create vector to store the result
-	std::vector<SteeringAgent*> results{};
+	// Find all the agents within the given range, without recursion
+	// Every level pops one node and pushes at most 4, so the stack never exceeds 3 per level + 4
+	int nodeStack[3 * m_MaxDepth + 4];
+	int stackSize{};
+	nodeStack[stackSize++] = 0;
 
-	// Check if query range intersects with this cell
-	if(!m_Boundary.Intersects(queryRange))
-		return results;  // Empty
+	const int maxResults{ int(results.size()) };
+	int nrOfResults{};
 
-	// Check if the tree is subdivided
-	if(m_LeftTop == nullptr)
+	while(stackSize > 0)
 	{
-		// Check if the agents in this cell are in the query range
-		for(SteeringAgent* pAgent : m_Agents)
+		const QuadNode& node{ m_Nodes[nodeStack[--stackSize]] };
+
+		// Check if query range intersects with this cell, entries can be anywhere inside the loose bounds
+		if(!GetLooseBoundary(node).Intersects(queryRange))
+			continue;
+
+		// Subdivided, so it won't contain agents itself, check its children
+		if(node.firstChild != -1)
 		{
-			if(queryRange.Contains(pAgent->GetPosition()))
-				results.push_back(pAgent);
+			for(int childIndex{}; childIndex < 4; ++childIndex)
+				nodeStack[stackSize++] = node.firstChild + childIndex;
+			continue;
 		}
-		return results;
-	}
 
-	// Cell is subdivided, so it wont contain any cells itself, so we need to check its children
-	const std::vector<SteeringAgent*>& leftTopResults{ m_LeftTop->QueryRange(queryRange) };
-	const std::vector<SteeringAgent*>& rightTopResults{ m_RightTop->QueryRange(queryRange) };
-	const std::vector<SteeringAgent*>& leftBottomResults{ m_LeftBottom->QueryRange(queryRange) };
-	const std::vector<SteeringAgent*>& rightBottomResults{ m_RightBottom->QueryRange(queryRange) };
+		// Check if the agents in this leaf are in the query range
+		for(int entryIndex{ node.firstEntry }; entryIndex != -1; entryIndex = m_Entries[entryIndex].next)
+		{
+			const QuadEntry& entry{ m_Entries[entryIndex] };
+			if(!queryRange.Contains(entry.position))
+				continue;
 
-	// Add all the results to the results vector
-	results.insert(results.end(), leftTopResults.begin(), leftTopResults.end());
-	results.insert(results.end(), rightTopResults.begin(), rightTopResults.end());
-	results.insert(results.end(), leftBottomResults.begin(), leftBottomResults.end());
-	results.insert(results.end(), rightBottomResults.begin(), rightBottomResults.end());
+			if(nrOfResults == maxResults)
+				return nrOfResults;  // Caller buffer is full
 
+			results[nrOfResults++] = entry.pAgent;
+		}
+	}
 
-	return results;
+	return nrOfResults;
 }
 
-QuadCellSpace::~QuadCellSpace()
+int QuadCellSpace::QueryNearest(const Elite::Vector2& position, float radius, int maxNeighbors, std::vector<SteeringAgent*>& results, const SteeringAgent* pExclude) const
 {
-	// Clear the agents
-	m_Agents.clear();
+	// Same traversal as QueryRange, but collects the distances so only the nearest can be kept
+	if(int(m_Candidates.size()) < m_NrOfEntries)
+		m_Candidates.resize(m_NrOfEntries);
+
+	const Boundary queryRange{ position, radius };
+	const float radiusSquared{ radius * radius };
+
+	int nodeStack[3 * m_MaxDepth + 4];
+	int stackSize{};
+	nodeStack[stackSize++] = 0;
 
-	// Delete all the children
-	if(m_LeftTop != nullptr)
+	int nrOfCandidates{};
+
+	while(stackSize > 0)
 	{
-		delete m_LeftTop;
-		delete m_RightTop;
-		delete m_LeftBottom;
-		delete m_RightBottom;
+		const QuadNode& node{ m_Nodes[nodeStack[--stackSize]] };
+
+		if(!GetLooseBoundary(node).Intersects(queryRange))
+			continue;
+
+		if(node.firstChild != -1)
+		{
+			for(int childIndex{}; childIndex < 4; ++childIndex)
+				nodeStack[stackSize++] = node.firstChild + childIndex;
+			continue;
+		}
+
+		for(int entryIndex{ node.firstEntry }; entryIndex != -1; entryIndex = m_Entries[entryIndex].next)
+		{
+			const QuadEntry& entry{ m_Entries[entryIndex] };
+			if(entry.pAgent == pExclude)
+				continue;
+
+			const float distanceSquared{ entry.position.DistanceSquared(position) };
+			if(distanceSquared < radiusSquared)
+				m_Candidates[nrOfCandidates++] = { distanceSquared, entry.pAgent };
+		}
 	}
+
+	return SelectNearestNeighbors(m_Candidates, nrOfCandidates, maxNeighbors, results);
 }
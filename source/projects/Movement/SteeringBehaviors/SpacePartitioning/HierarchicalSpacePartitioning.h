@@ -17,13 +17,14 @@
 #include <iterator>
 #include "framework\EliteMath\EVector2.h"
 #include "framework\EliteGeometry\EGeometry2DTypes.h"
+#include "NearestNeighbors.h"
 
 class SteeringAgent;
 
 
 struct Boundary
 {
-
+	Boundary(): Center(), HalfSize(0.0f) {};
 	Boundary(Elite::Vector2 _center, float _halfSize): Center(_center), HalfSize(_halfSize) {};
 
 	bool Contains(const Elite::Vector2& point) const;
@@ -38,37 +39,72 @@ struct Boundary
 
 // --- Partitioned Space ---
 // -------------------------
+// Nodes and agent entries live in two pools that only grow, Clear() just resets the counters.
+// Children of a node are stored as 4 consecutive nodes, leaves keep their agents in a linked list of entries.
+// UpdateAgents keeps the tree between frames: leaves are loose (bounds scaled by the looseness),
+// agents that stay inside the loose bounds of their leaf are not touched, only the movers are relocated.
 class QuadCellSpace
 {
 public:
-	QuadCellSpace(const Boundary& _boundary, int _bucketSize);
+	QuadCellSpace(const Boundary& _boundary, int _bucketSize, int _maxEntities = 0, float _looseness = 1.0f);
 
-	~QuadCellSpace();
+	~QuadCellSpace() = default;
 	QuadCellSpace(const QuadCellSpace& other) = delete;
 	QuadCellSpace(QuadCellSpace&& other) = delete;
 	QuadCellSpace& operator=(const QuadCellSpace& other) = delete;
 	QuadCellSpace& operator=(QuadCellSpace&& other) = delete;
 
-	// Need add agent function, subdivide function and a get agents in radius
-	bool AddAgent(SteeringAgent* pAgent);  // Takes current position and adds it to the cell
-	void Subdivide();  // Subdivides the cell into 4 cells
-	std::vector<SteeringAgent*> QueryRange(const Boundary& queryRange) const;  // Returns all agents found inside the range
-	void Clear(); // Deletes children and clears list
-	void Render();
-	void RenderActiveCells(const Boundary& boundary);
+	bool AddAgent(SteeringAgent* pAgent);  // Takes current position and adds it to the correct leaf
+	void Rebuild(const std::vector<SteeringAgent*>& agents);  // Clears and adds all agents, entry i belongs to agent i
+	void UpdateAgents(const std::vector<SteeringAgent*>& agents);  // Incremental update, falls back to Rebuild when the agents changed
+	int QueryRange(const Boundary& queryRange, std::vector<SteeringAgent*>& results) const;  // Writes the agents inside the range to results (up to its size), returns the amount
+	int QueryNearest(const Elite::Vector2& position, float radius, int maxNeighbors, std::vector<SteeringAgent*>& results, const SteeringAgent* pExclude = nullptr) const;  // Same, but only the maxNeighbors nearest within the radius
+	void Clear(); // Resets the pools, keeps the memory
+	void Render() const;
+	void RenderActiveCells(const Boundary& boundary) const;
+
+	int GetNrOfRelocations() const { return m_NrOfRelocations; }
 
 private:
+	struct QuadNode
+	{
+		Boundary boundary;
+		int firstChild = -1;  // Index of the first of 4 children, -1 for a leaf
+		int firstEntry = -1;  // Head of the entry list (leaves only)
+		int nrOfEntries = 0;
+		int depth = 0;
+	};
+
+	struct QuadEntry
+	{
+		SteeringAgent* pAgent = nullptr;
+		Elite::Vector2 position;  // Position at insertion, avoids going through the rigidbody on every query
+		int next = -1;
+		int leaf = -1;  // Node the entry is linked in, -1 when outside of the space
+	};
+
+	static constexpr int m_MaxDepth{ 12 };  // Stops subdividing, leaves at this depth can hold more than the bucket size
+	static constexpr int m_UpdatesPerRebuild{ 120 };  // Nodes are never merged, so rebuild once in a while
+
 	const Boundary m_Boundary;
 	const int m_MaxAgentsPerCell;
+	const float m_Looseness;
 
-	std::vector<SteeringAgent*> m_Agents;  // Agents in this node
+	std::vector<QuadNode> m_Nodes;
+	int m_NrOfNodes;
 
-	// Children
-	QuadCellSpace* m_LeftTop;
-	QuadCellSpace* m_RightTop;
-	QuadCellSpace* m_LeftBottom;
-	QuadCellSpace* m_RightBottom;
+	std::vector<QuadEntry> m_Entries;
+	int m_NrOfEntries;
 
+	int m_NrOfNodesAfterRebuild;
+	int m_UpdatesSinceRebuild;
+	int m_NrOfRelocations;
 
+	mutable std::vector<NeighborCandidate> m_Candidates;  // Scratch buffer for QueryNearest
 
+	void Subdivide(int nodeIndex);  // Splits the leaf into 4 children and moves its entries down
+	void InsertEntry(int nodeIndex, int entryIndex);
+	void RemoveEntry(int entryIndex);
+	Boundary GetLooseBoundary(const QuadNode& node) const { return Boundary(node.boundary.Center, node.boundary.HalfSize * m_Looseness); }
+	int GetChildIndex(const QuadNode& node, const Elite::Vector2& position) const;
 };
@@ -0,0 +1,43 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// NearestNeighbors.h: Helper shared by the space partitioning structures to cap a neighbor query.
+// Candidates inside the query radius are collected with their squared distance,
+// only the nearest ones are kept using a partial selection (nth_element) instead of a full sort.
+/*=============================================================================*/
+
+#pragma once
+#include <vector>
+#include <algorithm>
+
+class SteeringAgent;
+
+struct NeighborCandidate
+{
+	float DistanceSquared;
+	SteeringAgent* pAgent;
+};
+
+// Writes the (at most) maxNeighbors nearest candidates to results, starting at index 0. Returns the amount written.
+// The order of the written agents is unspecified, only the set is guaranteed to be the nearest.
+inline int SelectNearestNeighbors(std::vector<NeighborCandidate>& candidates, int nrOfCandidates, int maxNeighbors, std::vector<SteeringAgent*>& results)
+{
+	const int nrOfResults{ std::min(std::min(nrOfCandidates, maxNeighbors), int(results.size())) };
+
+	if(nrOfResults < nrOfCandidates)
+	{
+		std::nth_element(candidates.begin(), candidates.begin() + nrOfResults, candidates.begin() + nrOfCandidates,
+			[](const NeighborCandidate& a, const NeighborCandidate& b)
+			{
+				return a.DistanceSquared < b.DistanceSquared;
+			});
+	}
+
+	for(int resultIndex{}; resultIndex < nrOfResults; ++resultIndex)
+	{
+		results[resultIndex] = candidates[resultIndex].pAgent;
+	}
+
+	return nrOfResults;
+}
@@ -0,0 +1,201 @@
+#include "stdafx.h"
+#include "ObstacleGrid.h"
+#include "../Obstacle.h"
+
+ObstacleGrid::ObstacleGrid(const Elite::Vector2& bottomLeft, float size, float cellSize, float margin):
+	m_BottomLeft{ bottomLeft },
+	m_Size{ size },
+	m_CellSize{ cellSize },
+	m_Margin{ margin },
+	m_NrOfCells{ std::max(1, int(std::ceil(size / cellSize))) },
+	m_Cells(m_NrOfCells * m_NrOfCells)
+{
+}
+
+void ObstacleGrid::Insert(const Obstacle* pObstacle)
+{
+	const int obstacleIndex{ int(m_Obstacles.size()) };
+	m_Obstacles.push_back(pObstacle);
+	m_QueryStamps.push_back(0);
+
+	// Every cell the grown circle overlaps
+	const Elite::Vector2 center{ pObstacle->GetCenter() - m_BottomLeft };
+	const float extent{ pObstacle->GetRadius() + m_Margin };
+
+	const int startColumn{ ToCell(center.x - extent) };
+	const int endColumn{ ToCell(center.x + extent) };
+	const int startRow{ ToCell(center.y - extent) };
+	const int endRow{ ToCell(center.y + extent) };
+
+	for(int row{ startRow }; row <= endRow; ++row)
+	{
+		for(int column{ startColumn }; column <= endColumn; ++column)
+			m_Cells[row * m_NrOfCells + column].push_back(obstacleIndex);
+	}
+}
+
+void ObstacleGrid::Clear()
+{
+	m_Obstacles.clear();
+	m_QueryStamps.clear();
+	for(std::vector<int>& cell : m_Cells)
+		cell.clear();
+}
+
+const Obstacle* ObstacleGrid::Raycast(const Elite::Vector2& origin, const Elite::Vector2& direction, float maxDistance, float radius, float& hitDistance) const
+{
+	hitDistance = maxDistance;
+	if(m_Obstacles.empty())
+		return nullptr;
+
+	const float start[2]{ origin.x - m_BottomLeft.x, origin.y - m_BottomLeft.y };
+	const float rayDirection[2]{ direction.x, direction.y };
+
+	// Walk the cells in the order the ray crosses them (Amanatides & Woo).
+	// Positions outside of the grid are clamped into the border cells, same as the obstacles, so those get walked too.
+	int cell[2]{};
+	int step[2]{};
+	float nextBoundary[2]{};  // Distance along the ray to the next cell boundary, FLT_MAX when there is none
+	float boundaryDelta[2]{};  // Distance along the ray between two boundaries
+	for(int axis{}; axis < 2; ++axis)
+	{
+		cell[axis] = ToCell(start[axis]);
+		step[axis] = rayDirection[axis] > 0.f ? 1 : -1;
+		nextBoundary[axis] = FLT_MAX;
+		boundaryDelta[axis] = FLT_MAX;
+
+		if(fabsf(rayDirection[axis]) < FLT_EPSILON)
+			continue;
+
+		// Behind the ray when the origin is outside of the grid and moving away from it
+		const float boundary{ float(cell[axis] + (step[axis] > 0 ? 1 : 0)) * m_CellSize };
+		const float boundaryDistance{ (boundary - start[axis]) / rayDirection[axis] };
+		if(boundaryDistance >= 0.f)
+		{
+			nextBoundary[axis] = boundaryDistance;
+			boundaryDelta[axis] = m_CellSize / fabsf(rayDirection[axis]);
+		}
+	}
+
+	const int queryStamp{ NextQueryStamp() };
+	const Obstacle* pHitObstacle{ nullptr };
+
+	while(true)
+	{
+		for(int obstacleIndex : m_Cells[cell[1] * m_NrOfCells + cell[0]])
+		{
+			if(m_QueryStamps[obstacleIndex] == queryStamp)
+				continue;
+			m_QueryStamps[obstacleIndex] = queryStamp;
+
+			// Ray against the obstacle grown by the ray radius
+			const Obstacle* pObstacle{ m_Obstacles[obstacleIndex] };
+			const Elite::Vector2 toCenter{ pObstacle->GetCenter() - origin };
+			const float projection{ toCenter.Dot(direction) };
+			const float outsideSquared{ toCenter.MagnitudeSquared() - Elite::Square(pObstacle->GetRadius() + radius) };
+
+			float distance{};
+			if(outsideSquared > 0.f)
+			{
+				const float discriminant{ Elite::Square(projection) - outsideSquared };
+				if(projection <= 0.f || discriminant < 0.f)
+					continue;
+				distance = projection - sqrtf(discriminant);
+			}
+
+			if(distance < hitDistance)
+			{
+				hitDistance = distance;
+				pHitObstacle = pObstacle;
+			}
+		}
+
+		// A hit before leaving this cell can't be beaten by obstacles in the next ones
+		const float cellExitDistance{ std::min(nextBoundary[0], nextBoundary[1]) };
+		if(hitDistance <= cellExitDistance)
+			break;
+
+		const int axis{ nextBoundary[0] < nextBoundary[1] ? 0 : 1 };
+		if(cell[axis] + step[axis] < 0 || cell[axis] + step[axis] >= m_NrOfCells)
+		{
+			// Leaving the grid on this axis, the rest of the ray stays in the border cells
+			nextBoundary[axis] = FLT_MAX;
+			continue;
+		}
+		cell[axis] += step[axis];
+		nextBoundary[axis] += boundaryDelta[axis];
+	}
+
+	return pHitObstacle;
+}
+
+int ObstacleGrid::QueryRadius(const Elite::Vector2& center, float radius, std::vector<const Obstacle*>& results) const
+{
+	const Elite::Vector2 localCenter{ center - m_BottomLeft };
+	const int startColumn{ ToCell(localCenter.x - radius) };
+	const int endColumn{ ToCell(localCenter.x + radius) };
+	const int startRow{ ToCell(localCenter.y - radius) };
+	const int endRow{ ToCell(localCenter.y + radius) };
+
+	const int maxNrOfResults{ int(results.size()) };
+	const int queryStamp{ NextQueryStamp() };
+	int nrOfResults{ 0 };
+
+	for(int row{ startRow }; row <= endRow; ++row)
+	{
+		for(int column{ startColumn }; column <= endColumn; ++column)
+		{
+			for(int obstacleIndex : m_Cells[row * m_NrOfCells + column])
+			{
+				if(m_QueryStamps[obstacleIndex] == queryStamp)
+					continue;
+				m_QueryStamps[obstacleIndex] = queryStamp;
+
+				const Obstacle* pObstacle{ m_Obstacles[obstacleIndex] };
+				if(pObstacle->GetCenter().DistanceSquared(center) >= Elite::Square(pObstacle->GetRadius() + radius))
+					continue;
+
+				if(nrOfResults == maxNrOfResults)
+					return nrOfResults;
+				results[nrOfResults++] = pObstacle;
+			}
+		}
+	}
+
+	return nrOfResults;
+}
+
+void ObstacleGrid::RenderCells() const
+{
+	// Only the cells that contain obstacles
+	const Elite::Color gridColor{ 0.67f, 0.67f, 0.0f, 0.8f };
+	for(int row{}; row < m_NrOfCells; ++row)
+	{
+		for(int column{}; column < m_NrOfCells; ++column)
+		{
+			if(m_Cells[row * m_NrOfCells + column].empty())
+				continue;
+
+			const Elite::Vector2 bottomLeft{ m_BottomLeft + Elite::Vector2{ column * m_CellSize, row * m_CellSize } };
+			const Elite::Vector2 rectPoints[4]{ bottomLeft, bottomLeft + Elite::Vector2{ 0.f, m_CellSize },
+				bottomLeft + Elite::Vector2{ m_CellSize, m_CellSize }, bottomLeft + Elite::Vector2{ m_CellSize, 0.f } };
+			DEBUGRENDERER2D->DrawPolygon(rectPoints, 4, gridColor, 0.8f);
+		}
+	}
+}
+
+int ObstacleGrid::ToCell(float value) const
+{
+	return Elite::Clamp(int(std::floor(value / m_CellSize)), 0, m_NrOfCells - 1);
+}
+
+int ObstacleGrid::NextQueryStamp() const
+{
+	// Reset the stamps when the counter would overflow
+	if(m_QueryStamp == INT_MAX)
+	{
+		std::fill(m_QueryStamps.begin(), m_QueryStamps.end(), 0);
+		m_QueryStamp = 0;
+	}
+	return ++m_QueryStamp;
+}
@@ -0,0 +1,51 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// ObstacleGrid.h: Static uniform grid over circular obstacles, answers feeler ray and radius queries
+// by only visiting the cells along the ray or inside the query box.
+// Every obstacle is stored in all cells its circle (grown by the margin) overlaps,
+// so rays can be thickened by up to the margin without missing obstacles in neighboring cells.
+// Obstacles are expected inside the bounds, the ones outside are clamped into the border cells.
+/*=============================================================================*/
+
+#pragma once
+#include <vector>
+#include "framework\EliteMath\EVector2.h"
+
+class Obstacle;
+
+class ObstacleGrid final
+{
+public:
+	ObstacleGrid(const Elite::Vector2& bottomLeft, float size, float cellSize, float margin);
+
+	void Insert(const Obstacle* pObstacle);
+	void Clear();
+
+	// First obstacle hit by the ray (direction is normalized) within maxDistance, treating the ray as a circle of the given radius.
+	// Returns nullptr when nothing is hit, radius should not exceed the margin.
+	const Obstacle* Raycast(const Elite::Vector2& origin, const Elite::Vector2& direction, float maxDistance, float radius, float& hitDistance) const;
+	// Write the obstacles overlapping the circle to results (up to its size) and return the amount written
+	int QueryRadius(const Elite::Vector2& center, float radius, std::vector<const Obstacle*>& results) const;
+
+	int GetNrOfObstacles() const { return int(m_Obstacles.size()); }
+	void RenderCells() const;
+
+private:
+	const Elite::Vector2 m_BottomLeft;
+	const float m_Size;
+	const float m_CellSize;
+	const float m_Margin;
+	const int m_NrOfCells;  // Per side
+
+	std::vector<const Obstacle*> m_Obstacles;
+	std::vector<std::vector<int>> m_Cells;  // Obstacle indices per cell
+
+	// Every obstacle is tested once per query, even when it's stored in multiple visited cells
+	mutable std::vector<int> m_QueryStamps;
+	mutable int m_QueryStamp{ 0 };
+
+	int ToCell(float value) const;
+	int NextQueryStamp() const;
+};
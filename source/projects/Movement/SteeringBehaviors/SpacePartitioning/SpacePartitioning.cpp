@@ -50,6 +50,7 @@ CellSpace::CellSpace(float width, float height, int rows, int cols, int maxEntit
 	m_NrOfNeighbors{ 0 },
 	m_NeighborCells{ rows * cols },
 	m_NrOfNeighborCells{ 0 },
+	m_Candidates(maxEntities),
 	m_CellWidth{ width / cols },
 	m_CellHeight{ height / rows },
 	m_DrawCellAgentCount{ false }
@@ -135,6 +136,41 @@ void CellSpace::RegisterNeighbors(SteeringAgent* agent, float queryRadius)
 
 }
 
+void CellSpace::RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors)
+{
+	const Elite::Vector2 agentPos{ agent->GetPosition() };
+	const float queryRadiusSquared{ queryRadius * queryRadius };
+
+	const Elite::Vector2 startIndex{ PositionToRowColumn({ agentPos.x - queryRadius, agentPos.y - queryRadius }) };
+	const Elite::Vector2 endIndex{ PositionToRowColumn({ agentPos.x + queryRadius, agentPos.y + queryRadius }) };
+
+	// Collect every agent within the radius together with its distance, the selection happens afterwards
+	int nrOfCandidates{ 0 };
+	m_NrOfNeighborCells = 0;
+
+	for(int row{ int(startIndex.y) }; row <= int(endIndex.y); ++row)
+	{
+		for(int column{ int(startIndex.x) }; column <= int(endIndex.x); ++column)
+		{
+			Cell* pCell{ m_Cells[row * m_NrOfCols + column] };
+			for(SteeringAgent* cellAgent : pCell->agents)
+			{
+				if(cellAgent == agent)
+					continue;
+
+				const float distanceSquared{ cellAgent->GetPosition().DistanceSquared(agentPos) };
+				if(distanceSquared < queryRadiusSquared)
+				{
+					m_Candidates[nrOfCandidates++] = { distanceSquared, cellAgent };
+				}
+			}
+			m_NeighborCells[m_NrOfNeighborCells++] = pCell;
+		}
+	}
+
+	m_NrOfNeighbors = SelectNearestNeighbors(m_Candidates, nrOfCandidates, maxNeighbors, m_Neighbors);
+}
+
 void CellSpace::EmptyCells()
 {
 	for(Cell* c : m_Cells)
@@ -191,4 +227,202 @@ Elite::Vector2 CellSpace::PositionToRowColumn(const Elite::Vector2& pos) const
 	assert(row >= 0 && column < m_NrOfRows);
 
 	return Elite::Vector2(float(column), float(row));
-}
\ No newline at end of file
+}
+
+// --- Sorted Partitioned Space ---
+// --------------------------------
+SortedCellSpace::SortedCellSpace(float width, float height, int rows, int cols, int maxEntities):
+	m_SpaceWidth{ width },
+	m_SpaceHeight{ height },
+	m_NrOfRows{ rows },
+	m_NrOfCols{ cols },
+	m_CellWidth{ width / cols },
+	m_CellHeight{ height / rows },
+	m_DrawCellAgentCount{ false },
+	m_CellStart(rows * cols + 1, 0),
+	m_CellCursor(rows * cols, 0),
+	m_AgentCell(maxEntities, 0),
+	m_SortedAgents(maxEntities, nullptr),
+	m_SortedPositions(maxEntities),
+	m_Neighbors(maxEntities, nullptr),
+	m_NrOfNeighbors{ 0 },
+	m_Candidates(maxEntities),
+	m_QueryStartRow{ 0 },
+	m_QueryStartCol{ 0 },
+	m_QueryEndRow{ -1 },
+	m_QueryEndCol{ -1 }
+{
+}
+
+void SortedCellSpace::Rebuild(const std::vector<SteeringAgent*>& agents)
+{
+	const int nrOfAgents{ int(agents.size()) };
+	const int nrOfCells{ m_NrOfRows * m_NrOfCols };
+
+	// Only grows when there are more agents than ever before, so no allocations in a steady state
+	if(int(m_SortedAgents.size()) < nrOfAgents)
+	{
+		m_AgentCell.resize(nrOfAgents);
+		m_SortedAgents.resize(nrOfAgents);
+		m_SortedPositions.resize(nrOfAgents);
+		m_Neighbors.resize(nrOfAgents);
+		m_Candidates.resize(nrOfAgents);
+	}
+
+	// Count the agents per cell, shifted by one so the prefix sum results in the start offset of every cell
+	std::fill(m_CellStart.begin(), m_CellStart.end(), 0);
+	for(int agentIndex{}; agentIndex < nrOfAgents; ++agentIndex)
+	{
+		const int cellIndex{ PositionToIndex(agents[agentIndex]->GetPosition()) };
+		m_AgentCell[agentIndex] = cellIndex;
+		++m_CellStart[cellIndex + 1];
+	}
+
+	for(int cellIndex{}; cellIndex < nrOfCells; ++cellIndex)
+	{
+		m_CellStart[cellIndex + 1] += m_CellStart[cellIndex];
+	}
+
+	// Scatter every agent to the next free slot of its cell
+	std::copy(m_CellStart.begin(), m_CellStart.end() - 1, m_CellCursor.begin());
+	for(int agentIndex{}; agentIndex < nrOfAgents; ++agentIndex)
+	{
+		const int sortedIndex{ m_CellCursor[m_AgentCell[agentIndex]]++ };
+		m_SortedAgents[sortedIndex] = agents[agentIndex];
+		m_SortedPositions[sortedIndex] = agents[agentIndex]->GetPosition();
+	}
+}
+
+void SortedCellSpace::RegisterNeighbors(SteeringAgent* agent, float queryRadius)
+{
+	const Elite::Vector2 agentPos{ agent->GetPosition() };
+	const float queryRadiusSquared{ queryRadius * queryRadius };
+
+	UpdateQueryRange(agentPos, queryRadius);
+
+	m_NrOfNeighbors = 0;  // Reset the value to 0
+
+	for(int row{ m_QueryStartRow }; row <= m_QueryEndRow; ++row)
+	{
+		// The cells of one row are sorted next to each other, so the column range is one contiguous block
+		const int rowOffset{ row * m_NrOfCols };
+		const int first{ m_CellStart[rowOffset + m_QueryStartCol] };
+		const int last{ m_CellStart[rowOffset + m_QueryEndCol + 1] };
+
+		for(int sortedIndex{ first }; sortedIndex < last; ++sortedIndex)
+		{
+			if(m_SortedAgents[sortedIndex] == agent)
+				continue;
+
+			if(m_SortedPositions[sortedIndex].DistanceSquared(agentPos) < queryRadiusSquared)
+			{
+				m_Neighbors[m_NrOfNeighbors++] = m_SortedAgents[sortedIndex];
+			}
+		}
+	}
+}
+
+void SortedCellSpace::RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors)
+{
+	const Elite::Vector2 agentPos{ agent->GetPosition() };
+	const float queryRadiusSquared{ queryRadius * queryRadius };
+
+	UpdateQueryRange(agentPos, queryRadius);
+
+	int nrOfCandidates{ 0 };
+
+	for(int row{ m_QueryStartRow }; row <= m_QueryEndRow; ++row)
+	{
+		const int rowOffset{ row * m_NrOfCols };
+		const int first{ m_CellStart[rowOffset + m_QueryStartCol] };
+		const int last{ m_CellStart[rowOffset + m_QueryEndCol + 1] };
+
+		for(int sortedIndex{ first }; sortedIndex < last; ++sortedIndex)
+		{
+			if(m_SortedAgents[sortedIndex] == agent)
+				continue;
+
+			const float distanceSquared{ m_SortedPositions[sortedIndex].DistanceSquared(agentPos) };
+			if(distanceSquared < queryRadiusSquared)
+			{
+				m_Candidates[nrOfCandidates++] = { distanceSquared, m_SortedAgents[sortedIndex] };
+			}
+		}
+	}
+
+	m_NrOfNeighbors = SelectNearestNeighbors(m_Candidates, nrOfCandidates, maxNeighbors, m_Neighbors);
+}
+
+void SortedCellSpace::RenderCells() const
+{
+	const Elite::Color gridColor{ 0.67f, 0.67f, 0.0f, 0.8f };
+	for(int row{}; row < m_NrOfRows; ++row)
+	{
+		for(int col{}; col < m_NrOfCols; ++col)
+		{
+			std::vector<Elite::Vector2> rectPoints = GetCellRectPoints(row, col);
+			DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), gridColor, 0.8f);
+
+			if(m_DrawCellAgentCount)
+			{
+				Elite::Vector2 leftTop = rectPoints[1];
+				leftTop.x += 1.0f;
+				leftTop.y -= 1.0f;
+				DEBUGRENDERER2D->DrawString(leftTop, std::to_string(GetNrOfAgentsInCell(row * m_NrOfCols + col)).c_str());
+			}
+		}
+	}
+}
+
+void SortedCellSpace::RenderActiveCells() const
+{
+	const Elite::Color activeColor{ 0.0f, 1.0f, 0.0f, 0.8f };
+	for(int row{ m_QueryStartRow }; row <= m_QueryEndRow; ++row)
+	{
+		for(int col{ m_QueryStartCol }; col <= m_QueryEndCol; ++col)
+		{
+			std::vector<Elite::Vector2> rectPoints = GetCellRectPoints(row, col);
+			DEBUGRENDERER2D->DrawPolygon(rectPoints.data(), rectPoints.size(), activeColor, -0.1f);
+		}
+	}
+}
+
+int SortedCellSpace::PositionToIndex(const Elite::Vector2& pos) const
+{
+	return PositionToRow(pos.y) * m_NrOfCols + PositionToColumn(pos.x);
+}
+
+int SortedCellSpace::PositionToColumn(float x) const
+{
+	// Clamping, agents outside of the space end up in the border cells
+	return Elite::Clamp(int(x / m_CellWidth), 0, m_NrOfCols - 1);
+}
+
+int SortedCellSpace::PositionToRow(float y) const
+{
+	return Elite::Clamp(int(y / m_CellHeight), 0, m_NrOfRows - 1);
+}
+
+void SortedCellSpace::UpdateQueryRange(const Elite::Vector2& pos, float queryRadius)
+{
+	m_QueryStartCol = PositionToColumn(pos.x - queryRadius);
+	m_QueryEndCol = PositionToColumn(pos.x + queryRadius);
+	m_QueryStartRow = PositionToRow(pos.y - queryRadius);
+	m_QueryEndRow = PositionToRow(pos.y + queryRadius);
+}
+
+std::vector<Elite::Vector2> SortedCellSpace::GetCellRectPoints(int row, int col) const
+{
+	const float left{ col * m_CellWidth };
+	const float bottom{ row * m_CellHeight };
+
+	std::vector<Elite::Vector2> rectPoints =
+	{
+		{ left , bottom  },
+		{ left , bottom + m_CellHeight  },
+		{ left + m_CellWidth , bottom + m_CellHeight },
+		{ left + m_CellWidth , bottom  },
+	};
+
+	return rectPoints;
+}
@@ -15,6 +15,7 @@
 #include <iterator>
 #include "framework\EliteMath\EVector2.h"
 #include "framework\EliteGeometry\EGeometry2DTypes.h"
+#include "NearestNeighbors.h"
 
 class SteeringAgent;
 
@@ -44,6 +45,8 @@ public:
 	void UpdateAgentCell(SteeringAgent* agent);
 
 	void RegisterNeighbors(SteeringAgent* agent, float queryRadius);
+	// Only keeps the maxNeighbors nearest agents within the radius (excluding the agent itself)
+	void RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors);
 	const std::vector<SteeringAgent*>& GetNeighbors() const { return m_Neighbors; }
 	int GetNrOfNeighbors() const { return m_NrOfNeighbors; }
 
@@ -78,7 +81,77 @@ private:
 	std::vector<Cell*> m_NeighborCells;
 	int m_NrOfNeighborCells;
 
+	std::vector<NeighborCandidate> m_Candidates;
+
 	// Helper functions
 	int PositionToIndex(const Elite::Vector2& pos) const;
 	Elite::Vector2 PositionToRowColumn(const Elite::Vector2& pos) const;
 };
+
+// --- Sorted Partitioned Space ---
+// --------------------------------
+// Uniform grid that is rebuilt every frame with a counting sort.
+// All agents end up in one contiguous array, ordered by cell, with a start offset per cell.
+// No per-cell containers and no removals, neighbor iteration walks memory linearly.
+class SortedCellSpace
+{
+public:
+	SortedCellSpace(float width, float height, int rows, int cols, int maxEntities);
+	~SortedCellSpace() = default;
+
+	// Sorts all given agents into the cells, uses their current position
+	void Rebuild(const std::vector<SteeringAgent*>& agents);
+
+	// Fills the neighbor list with all agents within the radius (excluding the agent itself)
+	void RegisterNeighbors(SteeringAgent* agent, float queryRadius);
+	// Same, but only keeps the maxNeighbors nearest ones
+	void RegisterNearestNeighbors(SteeringAgent* agent, float queryRadius, int maxNeighbors);
+	const std::vector<SteeringAgent*>& GetNeighbors() const { return m_Neighbors; }
+	int GetNrOfNeighbors() const { return m_NrOfNeighbors; }
+
+	int GetNrOfAgentsInCell(int cellIndex) const { return m_CellStart[cellIndex + 1] - m_CellStart[cellIndex]; }
+
+	void RenderCells() const;
+	void RenderActiveCells() const;
+
+	void SetDrawCellAgentCount(bool value) { m_DrawCellAgentCount = value; }
+	bool GetDrawCellAgentCount() const { return m_DrawCellAgentCount; }
+
+private:
+	float m_SpaceWidth;
+	float m_SpaceHeight;
+
+	int m_NrOfRows;
+	int m_NrOfCols;
+
+	float m_CellWidth;
+	float m_CellHeight;
+
+	bool m_DrawCellAgentCount;
+
+	// Sorted data, m_CellStart has one extra entry so the end of cell i is m_CellStart[i + 1]
+	std::vector<int> m_CellStart;
+	std::vector<int> m_CellCursor;  // Write position per cell while scattering
+	std::vector<int> m_AgentCell;  // Cell index of every agent passed to Rebuild
+	std::vector<SteeringAgent*> m_SortedAgents;
+	std::vector<Elite::Vector2> m_SortedPositions;  // Position snapshot, same order as m_SortedAgents
+
+	// Members to avoid memory allocation on every frame
+	std::vector<SteeringAgent*> m_Neighbors;
+	int m_NrOfNeighbors;
+
+	std::vector<NeighborCandidate> m_Candidates;
+
+	// Cell range of the last query, for debug rendering
+	int m_QueryStartRow;
+	int m_QueryStartCol;
+	int m_QueryEndRow;
+	int m_QueryEndCol;
+
+	// Helper functions
+	int PositionToIndex(const Elite::Vector2& pos) const;
+	int PositionToColumn(float x) const;
+	int PositionToRow(float y) const;
+	void UpdateQueryRange(const Elite::Vector2& pos, float queryRadius);
+	std::vector<Elite::Vector2> GetCellRectPoints(int row, int col) const;
+};
@@ -0,0 +1,737 @@
+#include "stdafx.h"
+#include "SpatialIndex.h"
+
+ISpatialIndex* CreateSpatialIndex(SpatialIndexType type, float worldSize, float cellSize)
+{
+	switch(type)
+	{
+	case SpatialIndexType::Grid:
+	{
+		const int nrOfCells{ std::max(1, int(worldSize / cellSize)) };
+		return new GridSpatialIndex(worldSize, worldSize, nrOfCells, nrOfCells);
+	}
+	case SpatialIndexType::QuadTree:
+		return new QuadTreeSpatialIndex(Boundary({ worldSize / 2.0f, worldSize / 2.0f }, worldSize / 2.0f), 16);
+	case SpatialIndexType::SpatialHash:
+		return new HashSpatialIndex(cellSize);
+	}
+
+	return nullptr;
+}
+
+// --- Uniform Grid ---
+// --------------------
+GridSpatialIndex::GridSpatialIndex(float width, float height, int rows, int cols):
+	m_NrOfRows{ rows },
+	m_NrOfCols{ cols },
+	m_CellWidth{ width / cols },
+	m_CellHeight{ height / rows },
+	m_CellHead(rows * cols, -1),
+	m_NrOfItems{ 0 }
+{
+}
+
+void GridSpatialIndex::Insert(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()))
+		m_Entries.resize(id + 1);
+
+	if(m_Entries[id].cell != -1)
+	{
+		Update(id, position);
+		return;
+	}
+
+	m_Entries[id].position = position;
+	Link(id, PositionToRow(position.y) * m_NrOfCols + PositionToColumn(position.x));
+	++m_NrOfItems;
+}
+
+void GridSpatialIndex::Update(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].cell == -1)
+	{
+		Insert(id, position);
+		return;
+	}
+
+	m_Entries[id].position = position;
+
+	// Only relink when the item moved to another cell
+	const int cell{ PositionToRow(position.y) * m_NrOfCols + PositionToColumn(position.x) };
+	if(cell != m_Entries[id].cell)
+	{
+		Unlink(id);
+		Link(id, cell);
+	}
+}
+
+void GridSpatialIndex::Remove(int id)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].cell == -1)
+		return;
+
+	Unlink(id);
+	--m_NrOfItems;
+}
+
+void GridSpatialIndex::Clear()
+{
+	std::fill(m_CellHead.begin(), m_CellHead.end(), -1);
+	std::fill(m_Entries.begin(), m_Entries.end(), Entry{});
+	m_NrOfItems = 0;
+}
+
+int GridSpatialIndex::QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	const float radiusSquared{ radius * radius };
+	int nrOfResults{};
+
+	ForEachInBox({ center.x - radius, center.y - radius }, { center.x + radius, center.y + radius },
+		[&](int id, const Elite::Vector2& position)
+		{
+			if(nrOfResults < maxResults && position.DistanceSquared(center) < radiusSquared)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int GridSpatialIndex::QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	int nrOfResults{};
+
+	ForEachInBox(min, max,
+		[&](int id, const Elite::Vector2&)
+		{
+			if(nrOfResults < maxResults)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int GridSpatialIndex::Nearest(const Elite::Vector2& position, float maxDistance, int excludeId) const
+{
+	int nearestId{ -1 };
+	float nearestDistanceSquared{ maxDistance * maxDistance };
+
+	ForEachInBox({ position.x - maxDistance, position.y - maxDistance }, { position.x + maxDistance, position.y + maxDistance },
+		[&](int id, const Elite::Vector2& itemPosition)
+		{
+			const float distanceSquared{ itemPosition.DistanceSquared(position) };
+			if(id != excludeId && distanceSquared < nearestDistanceSquared)
+			{
+				nearestId = id;
+				nearestDistanceSquared = distanceSquared;
+			}
+		});
+
+	return nearestId;
+}
+
+int GridSpatialIndex::PositionToColumn(float x) const
+{
+	// Clamp before the cast, positions far outside of the space would overflow the int
+	return int(Elite::Clamp(x / m_CellWidth, 0.0f, float(m_NrOfCols - 1)));
+}
+
+int GridSpatialIndex::PositionToRow(float y) const
+{
+	return int(Elite::Clamp(y / m_CellHeight, 0.0f, float(m_NrOfRows - 1)));
+}
+
+void GridSpatialIndex::Link(int id, int cell)
+{
+	Entry& entry{ m_Entries[id] };
+	entry.cell = cell;
+	entry.prev = -1;
+	entry.next = m_CellHead[cell];
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = id;
+	m_CellHead[cell] = id;
+}
+
+void GridSpatialIndex::Unlink(int id)
+{
+	Entry& entry{ m_Entries[id] };
+
+	if(entry.prev != -1)
+		m_Entries[entry.prev].next = entry.next;
+	else
+		m_CellHead[entry.cell] = entry.next;
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = entry.prev;
+
+	entry.cell = -1;
+	entry.next = -1;
+	entry.prev = -1;
+}
+
+template<typename Function>
+void GridSpatialIndex::ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const
+{
+	const int startCol{ PositionToColumn(min.x) };
+	const int endCol{ PositionToColumn(max.x) };
+	const int startRow{ PositionToRow(min.y) };
+	const int endRow{ PositionToRow(max.y) };
+
+	for(int row{ startRow }; row <= endRow; ++row)
+	{
+		for(int col{ startCol }; col <= endCol; ++col)
+		{
+			for(int id{ m_CellHead[row * m_NrOfCols + col] }; id != -1; id = m_Entries[id].next)
+			{
+				// Border cells also hold the clamped items, so always check the real position
+				const Elite::Vector2& position{ m_Entries[id].position };
+				if(position.x >= min.x && position.x <= max.x && position.y >= min.y && position.y <= max.y)
+					function(id, position);
+			}
+		}
+	}
+}
+
+// --- Quadtree ---
+// ----------------
+QuadTreeSpatialIndex::QuadTreeSpatialIndex(const Boundary& boundary, int bucketSize):
+	m_Boundary{ boundary },
+	m_BucketSize{ bucketSize },
+	m_Nodes(64),
+	m_NrOfNodes{ 1 },
+	m_MaxNrOfNodes{ 64 },
+	m_OutsideHead{ -1 },
+	m_NrOfItems{ 0 }
+{
+	m_Nodes[0].boundary = m_Boundary;
+}
+
+void QuadTreeSpatialIndex::Insert(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()))
+		m_Entries.resize(id + 1);
+
+	if(m_Entries[id].leaf != -1)
+	{
+		Update(id, position);
+		return;
+	}
+
+	m_Entries[id].position = position;
+	InsertEntry(id);
+	++m_NrOfItems;
+
+	// Filling the tree is not growth we want to compact away
+	m_MaxNrOfNodes = std::max(m_MaxNrOfNodes, 2 * m_NrOfNodes);
+}
+
+void QuadTreeSpatialIndex::Update(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].leaf == -1)
+	{
+		Insert(id, position);
+		return;
+	}
+
+	Entry& entry{ m_Entries[id] };
+	entry.position = position;
+
+	// Still in the same leaf (or still outside), nothing to relink
+	if(entry.leaf == m_OutsideLeaf ? !m_Boundary.Contains(position) : m_Nodes[entry.leaf].boundary.Contains(position))
+		return;
+
+	Unlink(id);
+	InsertEntry(id);
+
+	if(m_NrOfNodes > m_MaxNrOfNodes)
+		Compact();
+}
+
+void QuadTreeSpatialIndex::Remove(int id)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].leaf == -1)
+		return;
+
+	Unlink(id);
+	--m_NrOfItems;
+}
+
+void QuadTreeSpatialIndex::Clear()
+{
+	m_Nodes[0] = Node{};
+	m_Nodes[0].boundary = m_Boundary;
+	m_NrOfNodes = 1;
+
+	std::fill(m_Entries.begin(), m_Entries.end(), Entry{});
+	m_OutsideHead = -1;
+	m_NrOfItems = 0;
+}
+
+int QuadTreeSpatialIndex::QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	const float radiusSquared{ radius * radius };
+	int nrOfResults{};
+
+	ForEachInBox({ center.x - radius, center.y - radius }, { center.x + radius, center.y + radius },
+		[&](int id, const Elite::Vector2& position)
+		{
+			if(nrOfResults < maxResults && position.DistanceSquared(center) < radiusSquared)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int QuadTreeSpatialIndex::QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	int nrOfResults{};
+
+	ForEachInBox(min, max,
+		[&](int id, const Elite::Vector2&)
+		{
+			if(nrOfResults < maxResults)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int QuadTreeSpatialIndex::Nearest(const Elite::Vector2& position, float maxDistance, int excludeId) const
+{
+	int nearestId{ -1 };
+	float nearestDistanceSquared{ maxDistance * maxDistance };
+
+	ForEachInBox({ position.x - maxDistance, position.y - maxDistance }, { position.x + maxDistance, position.y + maxDistance },
+		[&](int id, const Elite::Vector2& itemPosition)
+		{
+			const float distanceSquared{ itemPosition.DistanceSquared(position) };
+			if(id != excludeId && distanceSquared < nearestDistanceSquared)
+			{
+				nearestId = id;
+				nearestDistanceSquared = distanceSquared;
+			}
+		});
+
+	return nearestId;
+}
+
+void QuadTreeSpatialIndex::InsertEntry(int id)
+{
+	const Elite::Vector2 position{ m_Entries[id].position };
+
+	if(!m_Boundary.Contains(position))
+	{
+		Link(id, m_OutsideLeaf);
+		return;
+	}
+
+	// Walk down to the leaf that contains the position
+	int nodeIndex{ 0 };
+	while(m_Nodes[nodeIndex].firstChild != -1)
+		nodeIndex = m_Nodes[nodeIndex].firstChild + GetChildIndex(m_Nodes[nodeIndex], position);
+
+	Link(id, nodeIndex);
+
+	if(m_Nodes[nodeIndex].nrOfEntries > m_BucketSize && m_Nodes[nodeIndex].depth < m_MaxDepth)
+		Subdivide(nodeIndex);
+}
+
+void QuadTreeSpatialIndex::Link(int id, int leaf)
+{
+	Entry& entry{ m_Entries[id] };
+	int& head{ leaf == m_OutsideLeaf ? m_OutsideHead : m_Nodes[leaf].firstEntry };
+
+	entry.leaf = leaf;
+	entry.prev = -1;
+	entry.next = head;
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = id;
+	head = id;
+
+	if(leaf != m_OutsideLeaf)
+		++m_Nodes[leaf].nrOfEntries;
+}
+
+void QuadTreeSpatialIndex::Unlink(int id)
+{
+	Entry& entry{ m_Entries[id] };
+
+	if(entry.prev != -1)
+		m_Entries[entry.prev].next = entry.next;
+	else if(entry.leaf == m_OutsideLeaf)
+		m_OutsideHead = entry.next;
+	else
+		m_Nodes[entry.leaf].firstEntry = entry.next;
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = entry.prev;
+
+	if(entry.leaf != m_OutsideLeaf)
+		--m_Nodes[entry.leaf].nrOfEntries;
+
+	entry.leaf = -1;
+	entry.next = -1;
+	entry.prev = -1;
+}
+
+void QuadTreeSpatialIndex::Subdivide(int nodeIndex)
+{
+	if(m_NrOfNodes + 4 > int(m_Nodes.size()))
+		m_Nodes.resize(m_Nodes.size() * 2);
+
+	const int firstChild{ m_NrOfNodes };
+	m_NrOfNodes += 4;
+
+	// Copy, the children are created in the same pool
+	const Node parent{ m_Nodes[nodeIndex] };
+	const float childHalfSize{ parent.boundary.HalfSize / 2.0f };
+
+	// Left top, right top, left bottom, right bottom
+	const Elite::Vector2 childOffsets[4]
+	{
+		{ -childHalfSize, childHalfSize },
+		{ childHalfSize, childHalfSize },
+		{ -childHalfSize, -childHalfSize },
+		{ childHalfSize, -childHalfSize }
+	};
+
+	for(int childIndex{}; childIndex < 4; ++childIndex)
+	{
+		Node& child{ m_Nodes[firstChild + childIndex] };
+		child = Node{};
+		child.boundary = Boundary(parent.boundary.Center + childOffsets[childIndex], childHalfSize);
+		child.depth = parent.depth + 1;
+	}
+
+	m_Nodes[nodeIndex].firstChild = firstChild;
+	m_Nodes[nodeIndex].firstEntry = -1;
+	m_Nodes[nodeIndex].nrOfEntries = 0;
+
+	// Move the entries down, the bounds are tight so every entry fits in one of the children
+	int id{ parent.firstEntry };
+	while(id != -1)
+	{
+		const int nextId{ m_Entries[id].next };
+		Link(id, firstChild + GetChildIndex(parent, m_Entries[id].position));
+		id = nextId;
+	}
+
+	for(int childIndex{}; childIndex < 4; ++childIndex)
+	{
+		if(m_Nodes[firstChild + childIndex].nrOfEntries > m_BucketSize && parent.depth + 1 < m_MaxDepth)
+			Subdivide(firstChild + childIndex);
+	}
+}
+
+void QuadTreeSpatialIndex::Compact()
+{
+	// Throw away all nodes and insert every item again, gets rid of the empty branches
+	m_Nodes[0] = Node{};
+	m_Nodes[0].boundary = m_Boundary;
+	m_NrOfNodes = 1;
+	m_OutsideHead = -1;
+
+	for(int id{}; id < int(m_Entries.size()); ++id)
+	{
+		if(m_Entries[id].leaf == -1)
+			continue;
+
+		InsertEntry(id);
+	}
+
+	m_MaxNrOfNodes = std::max(64, 2 * m_NrOfNodes);
+}
+
+int QuadTreeSpatialIndex::GetChildIndex(const Node& node, const Elite::Vector2& position) const
+{
+	const int column{ position.x < node.boundary.Center.x ? 0 : 1 };
+	const int row{ position.y < node.boundary.Center.y ? 1 : 0 };
+	return row * 2 + column;
+}
+
+template<typename Function>
+void QuadTreeSpatialIndex::ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const
+{
+	const auto isInBox = [&min, &max](const Elite::Vector2& position)
+	{
+		return position.x >= min.x && position.x <= max.x && position.y >= min.y && position.y <= max.y;
+	};
+
+	// Every level pops one node and pushes at most 4, so the stack never exceeds 3 per level + 4
+	int nodeStack[3 * m_MaxDepth + 4];
+	int stackSize{};
+	nodeStack[stackSize++] = 0;
+
+	while(stackSize > 0)
+	{
+		const Node& node{ m_Nodes[nodeStack[--stackSize]] };
+		const Boundary& bounds{ node.boundary };
+
+		if(bounds.Center.x - bounds.HalfSize > max.x || bounds.Center.x + bounds.HalfSize < min.x
+			|| bounds.Center.y - bounds.HalfSize > max.y || bounds.Center.y + bounds.HalfSize < min.y)
+			continue;
+
+		if(node.firstChild != -1)
+		{
+			for(int childIndex{}; childIndex < 4; ++childIndex)
+				nodeStack[stackSize++] = node.firstChild + childIndex;
+			continue;
+		}
+
+		for(int id{ node.firstEntry }; id != -1; id = m_Entries[id].next)
+		{
+			if(isInBox(m_Entries[id].position))
+				function(id, m_Entries[id].position);
+		}
+	}
+
+	for(int id{ m_OutsideHead }; id != -1; id = m_Entries[id].next)
+	{
+		if(isInBox(m_Entries[id].position))
+			function(id, m_Entries[id].position);
+	}
+}
+
+// --- Spatial Hash ---
+// --------------------
+HashSpatialIndex::HashSpatialIndex(float cellSize, int nrOfBuckets):
+	m_CellSize{ cellSize },
+	m_InvCellSize{ 1.0f / cellSize },
+	m_NrOfItems{ 0 }
+{
+	// Power of 2, so the bucket can be found with a mask
+	int nrOfBucketsPow2{ 1 };
+	while(nrOfBucketsPow2 < nrOfBuckets)
+		nrOfBucketsPow2 <<= 1;
+
+	m_BucketHead.resize(nrOfBucketsPow2, -1);
+}
+
+void HashSpatialIndex::Insert(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()))
+		m_Entries.resize(id + 1);
+
+	if(m_Entries[id].bucket != -1)
+	{
+		Update(id, position);
+		return;
+	}
+
+	Entry& entry{ m_Entries[id] };
+	entry.position = position;
+	entry.cellX = ToCell(position.x);
+	entry.cellY = ToCell(position.y);
+	Link(id);
+	++m_NrOfItems;
+
+	// Keep the buckets short, growing relinks everything so the size doubles each time
+	if(m_NrOfItems > int(m_BucketHead.size()))
+		Rehash(int(m_BucketHead.size()) * 2);
+}
+
+void HashSpatialIndex::Update(int id, const Elite::Vector2& position)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].bucket == -1)
+	{
+		Insert(id, position);
+		return;
+	}
+
+	Entry& entry{ m_Entries[id] };
+	entry.position = position;
+
+	const int cellX{ ToCell(position.x) };
+	const int cellY{ ToCell(position.y) };
+	if(cellX == entry.cellX && cellY == entry.cellY)
+		return;
+
+	Unlink(id);
+	entry.cellX = cellX;
+	entry.cellY = cellY;
+	Link(id);
+}
+
+void HashSpatialIndex::Remove(int id)
+{
+	if(id >= int(m_Entries.size()) || m_Entries[id].bucket == -1)
+		return;
+
+	Unlink(id);
+	--m_NrOfItems;
+}
+
+void HashSpatialIndex::Clear()
+{
+	std::fill(m_BucketHead.begin(), m_BucketHead.end(), -1);
+	std::fill(m_Entries.begin(), m_Entries.end(), Entry{});
+	m_NrOfItems = 0;
+}
+
+int HashSpatialIndex::QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	const float radiusSquared{ radius * radius };
+	int nrOfResults{};
+
+	ForEachInBox({ center.x - radius, center.y - radius }, { center.x + radius, center.y + radius },
+		[&](int id, const Elite::Vector2& position)
+		{
+			if(nrOfResults < maxResults && position.DistanceSquared(center) < radiusSquared)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int HashSpatialIndex::QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const
+{
+	const int maxResults{ int(results.size()) };
+	int nrOfResults{};
+
+	ForEachInBox(min, max,
+		[&](int id, const Elite::Vector2&)
+		{
+			if(nrOfResults < maxResults)
+				results[nrOfResults++] = id;
+		});
+
+	return nrOfResults;
+}
+
+int HashSpatialIndex::Nearest(const Elite::Vector2& position, float maxDistance, int excludeId) const
+{
+	int nearestId{ -1 };
+	float nearestDistanceSquared{ maxDistance * maxDistance };
+
+	ForEachInBox({ position.x - maxDistance, position.y - maxDistance }, { position.x + maxDistance, position.y + maxDistance },
+		[&](int id, const Elite::Vector2& itemPosition)
+		{
+			const float distanceSquared{ itemPosition.DistanceSquared(position) };
+			if(id != excludeId && distanceSquared < nearestDistanceSquared)
+			{
+				nearestId = id;
+				nearestDistanceSquared = distanceSquared;
+			}
+		});
+
+	return nearestId;
+}
+
+void HashSpatialIndex::FitToQueryRadius(float queryRadius)
+{
+	// Some slack, so dragging the radius around doesn't rehash every frame
+	const float targetCellSize{ std::max(queryRadius, 0.01f) * 2.0f };
+	if(m_CellSize < targetCellSize * 0.75f || m_CellSize > targetCellSize * 1.5f)
+		SetCellSize(targetCellSize);
+}
+
+void HashSpatialIndex::SetCellSize(float cellSize)
+{
+	m_CellSize = cellSize;
+	m_InvCellSize = 1.0f / cellSize;
+	Rehash(int(m_BucketHead.size()));
+}
+
+int HashSpatialIndex::ToCell(float value) const
+{
+	// Clamp before the cast, huge query ranges would overflow the int
+	return int(Elite::Clamp(std::floor(value * m_InvCellSize), -1.0e9f, 1.0e9f));
+}
+
+int HashSpatialIndex::GetBucket(int cellX, int cellY) const
+{
+	const unsigned int hash{ (unsigned int)(cellX) * 73856093u ^ (unsigned int)(cellY) * 19349663u };
+	return int(hash & (unsigned int)(m_BucketHead.size() - 1));
+}
+
+void HashSpatialIndex::Link(int id)
+{
+	Entry& entry{ m_Entries[id] };
+	entry.bucket = GetBucket(entry.cellX, entry.cellY);
+	entry.prev = -1;
+	entry.next = m_BucketHead[entry.bucket];
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = id;
+	m_BucketHead[entry.bucket] = id;
+}
+
+void HashSpatialIndex::Unlink(int id)
+{
+	Entry& entry{ m_Entries[id] };
+
+	if(entry.prev != -1)
+		m_Entries[entry.prev].next = entry.next;
+	else
+		m_BucketHead[entry.bucket] = entry.next;
+
+	if(entry.next != -1)
+		m_Entries[entry.next].prev = entry.prev;
+
+	entry.bucket = -1;
+	entry.next = -1;
+	entry.prev = -1;
+}
+
+void HashSpatialIndex::Rehash(int nrOfBuckets)
+{
+	m_BucketHead.assign(nrOfBuckets, -1);
+
+	for(int id{}; id < int(m_Entries.size()); ++id)
+	{
+		Entry& entry{ m_Entries[id] };
+		if(entry.bucket == -1)
+			continue;
+
+		entry.cellX = ToCell(entry.position.x);
+		entry.cellY = ToCell(entry.position.y);
+		Link(id);
+	}
+}
+
+template<typename Function>
+void HashSpatialIndex::ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const
+{
+	const auto isInBox = [&min, &max](const Elite::Vector2& position)
+	{
+		return position.x >= min.x && position.x <= max.x && position.y >= min.y && position.y <= max.y;
+	};
+
+	const int startX{ ToCell(min.x) };
+	const int endX{ ToCell(max.x) };
+	const int startY{ ToCell(min.y) };
+	const int endY{ ToCell(max.y) };
+
+	// More cells than buckets, every bucket would be visited several times, just check everything once
+	const long long nrOfCells{ (long long)(endX - startX + 1) * (endY - startY + 1) };
+	if(nrOfCells > (long long)(m_BucketHead.size()))
+	{
+		for(int id{}; id < int(m_Entries.size()); ++id)
+		{
+			if(m_Entries[id].bucket != -1 && isInBox(m_Entries[id].position))
+				function(id, m_Entries[id].position);
+		}
+		return;
+	}
+
+	for(int cellY{ startY }; cellY <= endY; ++cellY)
+	{
+		for(int cellX{ startX }; cellX <= endX; ++cellX)
+		{
+			for(int id{ m_BucketHead[GetBucket(cellX, cellY)] }; id != -1; id = m_Entries[id].next)
+			{
+				// Other cells can hash to the same bucket, only take the ones of this cell
+				const Entry& entry{ m_Entries[id] };
+				if(entry.cellX == cellX && entry.cellY == cellY && isInBox(entry.position))
+					function(id, entry.position);
+			}
+		}
+	}
+}
@@ -0,0 +1,220 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// SpatialIndex.h: Common interface for the point based spatial structures, with a grid, quadtree and spatial hash backend.
+// Items are identified by an id chosen by the user (usually the index in its own container),
+// ids are used to index internal arrays, so keep them small and dense.
+// The index keeps its own copy of the positions, Update has to be called when an item moves.
+/*=============================================================================*/
+
+#pragma once
+#include <vector>
+#include "framework\EliteMath\EVector2.h"
+#include "HierarchicalSpacePartitioning.h"
+
+enum class SpatialIndexType
+{
+	Grid,
+	QuadTree,
+	SpatialHash
+};
+
+// --- Interface ---
+// -----------------
+class ISpatialIndex
+{
+public:
+	ISpatialIndex() = default;
+	virtual ~ISpatialIndex() = default;
+
+	ISpatialIndex(const ISpatialIndex& other) = delete;
+	ISpatialIndex& operator=(const ISpatialIndex& other) = delete;
+
+	virtual void Insert(int id, const Elite::Vector2& position) = 0;
+	virtual void Update(int id, const Elite::Vector2& position) = 0;  // Inserts the item when it is not in the index yet
+	virtual void Remove(int id) = 0;
+	virtual void Clear() = 0;
+
+	// Write the ids to results (up to its size) and return the amount written
+	virtual int QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const = 0;
+	virtual int QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const = 0;
+	// Id of the nearest item within maxDistance, -1 if there is none
+	virtual int Nearest(const Elite::Vector2& position, float maxDistance, int excludeId = -1) const = 0;
+
+	// Hint of the radius most queries will use, backends that can adapt their cell size do so
+	virtual void FitToQueryRadius(float) {}
+
+	virtual int GetNrOfItems() const = 0;
+	virtual const char* GetName() const = 0;
+};
+
+ISpatialIndex* CreateSpatialIndex(SpatialIndexType type, float worldSize, float cellSize);
+
+// --- Uniform Grid ---
+// --------------------
+// Bounded grid like CellSpace, positions outside of the space are clamped into the border cells.
+// Every cell keeps a doubly linked list of ids, so moving an item between cells is O(1).
+class GridSpatialIndex final : public ISpatialIndex
+{
+public:
+	GridSpatialIndex(float width, float height, int rows, int cols);
+
+	void Insert(int id, const Elite::Vector2& position) override;
+	void Update(int id, const Elite::Vector2& position) override;
+	void Remove(int id) override;
+	void Clear() override;
+
+	int QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const override;
+	int QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const override;
+	int Nearest(const Elite::Vector2& position, float maxDistance, int excludeId = -1) const override;
+
+	int GetNrOfItems() const override { return m_NrOfItems; }
+	const char* GetName() const override { return "Grid"; }
+
+private:
+	struct Entry
+	{
+		Elite::Vector2 position;
+		int cell = -1;  // -1 when the id is not in the index
+		int next = -1;
+		int prev = -1;
+	};
+
+	int m_NrOfRows;
+	int m_NrOfCols;
+	float m_CellWidth;
+	float m_CellHeight;
+
+	std::vector<int> m_CellHead;
+	std::vector<Entry> m_Entries;  // Indexed by id
+	int m_NrOfItems;
+
+	int PositionToColumn(float x) const;
+	int PositionToRow(float y) const;
+	void Link(int id, int cell);
+	void Unlink(int id);
+
+	template<typename Function>
+	void ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const;
+};
+
+// --- Quadtree ---
+// ----------------
+// Id based quadtree with pooled nodes, items that stay inside their leaf are only moved in place.
+// Items outside of the boundary are kept in a separate list that every query checks.
+class QuadTreeSpatialIndex final : public ISpatialIndex
+{
+public:
+	QuadTreeSpatialIndex(const Boundary& boundary, int bucketSize);
+
+	void Insert(int id, const Elite::Vector2& position) override;
+	void Update(int id, const Elite::Vector2& position) override;
+	void Remove(int id) override;
+	void Clear() override;
+
+	int QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const override;
+	int QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const override;
+	int Nearest(const Elite::Vector2& position, float maxDistance, int excludeId = -1) const override;
+
+	int GetNrOfItems() const override { return m_NrOfItems; }
+	const char* GetName() const override { return "Quadtree"; }
+
+private:
+	struct Node
+	{
+		Boundary boundary;
+		int firstChild = -1;  // Index of the first of 4 children, -1 for a leaf
+		int firstEntry = -1;
+		int nrOfEntries = 0;
+		int depth = 0;
+	};
+
+	struct Entry
+	{
+		Elite::Vector2 position;
+		int leaf = -1;  // -1 when the id is not in the index, m_OutsideLeaf when outside of the boundary
+		int next = -1;
+		int prev = -1;
+	};
+
+	static constexpr int m_MaxDepth{ 10 };
+	static constexpr int m_OutsideLeaf{ -2 };
+
+	const Boundary m_Boundary;
+	const int m_BucketSize;
+
+	std::vector<Node> m_Nodes;
+	int m_NrOfNodes;
+	int m_MaxNrOfNodes;  // Nodes are never merged, the tree is rebuilt when it grows past this
+
+	std::vector<Entry> m_Entries;  // Indexed by id
+	int m_OutsideHead;
+	int m_NrOfItems;
+
+	void InsertEntry(int id);
+	void Link(int id, int leaf);
+	void Unlink(int id);
+	void Subdivide(int nodeIndex);
+	void Compact();
+	int GetChildIndex(const Node& node, const Elite::Vector2& position) const;
+
+	template<typename Function>
+	void ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const;
+};
+
+// --- Spatial Hash ---
+// --------------------
+// Cells are hashed into buckets, so there are no bounds to the space and nothing gets clamped.
+// Entries remember their cell, different cells that share a bucket are filtered out during queries.
+// The bucket table doubles when there are more items than buckets, the cell size can follow the query radius.
+class HashSpatialIndex final : public ISpatialIndex
+{
+public:
+	HashSpatialIndex(float cellSize, int nrOfBuckets = 1024);
+
+	void Insert(int id, const Elite::Vector2& position) override;
+	void Update(int id, const Elite::Vector2& position) override;
+	void Remove(int id) override;
+	void Clear() override;
+
+	int QueryRadius(const Elite::Vector2& center, float radius, std::vector<int>& results) const override;
+	int QueryAABB(const Elite::Vector2& min, const Elite::Vector2& max, std::vector<int>& results) const override;
+	int Nearest(const Elite::Vector2& position, float maxDistance, int excludeId = -1) const override;
+
+	// Cells of about twice the radius (0.75x to 1.5x, so small radius changes don't rehash), a query box overlaps at most 3x3 cells
+	// and 2x2 while the cell size is exactly twice the radius
+	void FitToQueryRadius(float queryRadius) override;
+	void SetCellSize(float cellSize);
+	float GetCellSize() const { return m_CellSize; }
+
+	int GetNrOfItems() const override { return m_NrOfItems; }
+	const char* GetName() const override { return "Spatial hash"; }
+
+private:
+	struct Entry
+	{
+		Elite::Vector2 position;
+		int cellX = 0;
+		int cellY = 0;
+		int bucket = -1;  // -1 when the id is not in the index
+		int next = -1;
+		int prev = -1;
+	};
+
+	float m_CellSize;
+	float m_InvCellSize;
+
+	std::vector<int> m_BucketHead;  // Size is a power of 2
+	std::vector<Entry> m_Entries;  // Indexed by id
+	int m_NrOfItems;
+
+	int ToCell(float value) const;
+	int GetBucket(int cellX, int cellY) const;
+	void Link(int id);
+	void Unlink(int id);
+	void Rehash(int nrOfBuckets);  // Relinks every entry, cells are recalculated with the current cell size
+
+	template<typename Function>
+	void ForEachInBox(const Elite::Vector2& min, const Elite::Vector2& max, Function function) const;
+};
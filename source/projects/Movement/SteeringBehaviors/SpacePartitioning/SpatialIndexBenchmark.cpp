@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "SpatialIndexBenchmark.h"
+#include "SpatialIndex.h"
+
+#include <iomanip>
+
+namespace
+{
+	enum class Distribution
+	{
+		Uniform,
+		Clustered
+	};
+
+	const char* ToString(Distribution distribution)
+	{
+		return distribution == Distribution::Uniform ? "uniform" : "clustered";
+	}
+
+	std::vector<Elite::Vector2> GeneratePoints(Distribution distribution, int nrOfPoints, float worldSize, std::mt19937& generator)
+	{
+		std::vector<Elite::Vector2> points(nrOfPoints);
+		std::uniform_real_distribution<float> uniform{ 0.0f, worldSize };
+
+		if(distribution == Distribution::Uniform)
+		{
+			for(Elite::Vector2& point : points)
+				point = Elite::Vector2{ uniform(generator), uniform(generator) };
+			return points;
+		}
+
+		// A few dense groups, like a flock that split up
+		const int nrOfClusters{ 8 };
+		std::vector<Elite::Vector2> clusterCenters(nrOfClusters);
+		for(Elite::Vector2& center : clusterCenters)
+			center = Elite::Vector2{ uniform(generator), uniform(generator) };
+
+		std::normal_distribution<float> spread{ 0.0f, worldSize * 0.02f };
+		for(int pointIndex{}; pointIndex < nrOfPoints; ++pointIndex)
+		{
+			const Elite::Vector2& center{ clusterCenters[pointIndex % nrOfClusters] };
+			points[pointIndex] = Elite::Vector2{ Elite::Clamp(center.x + spread(generator), 0.0f, worldSize), Elite::Clamp(center.y + spread(generator), 0.0f, worldSize) };
+		}
+		return points;
+	}
+
+	double GetMilliseconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+void SpatialIndexBenchmark::Run(const Settings& settings, std::ostream& output)
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	const SpatialIndexType types[]{ SpatialIndexType::Grid, SpatialIndexType::QuadTree, SpatialIndexType::SpatialHash };
+	const Distribution distributions[]{ Distribution::Uniform, Distribution::Clustered };
+
+	output << std::left << std::setw(11) << "layout" << std::setw(8) << "points" << std::setw(14) << "index"
+		<< std::right << std::setw(11) << "build ms" << std::setw(11) << "update ms" << std::setw(11) << "query ms"
+		<< std::setw(13) << "nearest ms" << std::setw(14) << "queries/s" << std::setw(12) << "avg found" << "\n";
+
+	for(Distribution distribution : distributions)
+	{
+		for(int nrOfPoints : settings.pointCounts)
+		{
+			// Every backend gets the same points and the same movement
+			std::mt19937 generator{ settings.seed };
+			const std::vector<Elite::Vector2> startPoints{ GeneratePoints(distribution, nrOfPoints, settings.worldSize, generator) };
+
+			std::vector<Elite::Vector2> steps(nrOfPoints);
+			std::uniform_real_distribution<float> step{ -1.0f, 1.0f };
+			for(Elite::Vector2& s : steps)
+				s = Elite::Vector2{ step(generator), step(generator) };
+
+			std::vector<int> results(nrOfPoints);
+
+			for(SpatialIndexType type : types)
+			{
+				ISpatialIndex* pIndex{ CreateSpatialIndex(type, settings.worldSize, settings.queryRadius) };
+				std::vector<Elite::Vector2> points{ startPoints };
+
+				Clock::time_point start{ Clock::now() };
+				for(int id{}; id < nrOfPoints; ++id)
+					pIndex->Insert(id, points[id]);
+				const double buildTime{ GetMilliseconds(start) };
+
+				start = Clock::now();
+				for(int update{}; update < settings.nrOfUpdates; ++update)
+				{
+					for(int id{}; id < nrOfPoints; ++id)
+					{
+						points[id] += steps[id];
+						pIndex->Update(id, points[id]);
+					}
+				}
+				const double updateTime{ GetMilliseconds(start) / settings.nrOfUpdates };
+
+				long long nrOfFound{};
+				start = Clock::now();
+				for(int id{}; id < nrOfPoints; ++id)
+					nrOfFound += pIndex->QueryRadius(points[id], settings.queryRadius, results);
+				const double queryTime{ GetMilliseconds(start) };
+
+				int nrOfNearestFound{};
+				start = Clock::now();
+				for(int id{}; id < nrOfPoints; ++id)
+					nrOfNearestFound += pIndex->Nearest(points[id], settings.queryRadius, id) != -1;
+				const double nearestTime{ GetMilliseconds(start) };
+				UNREFERENCED_PARAMETER(nrOfNearestFound);
+
+				output << std::left << std::setw(11) << ToString(distribution) << std::setw(8) << nrOfPoints << std::setw(14) << pIndex->GetName()
+					<< std::right << std::fixed << std::setprecision(3)
+					<< std::setw(11) << buildTime << std::setw(11) << updateTime << std::setw(11) << queryTime << std::setw(13) << nearestTime
+					<< std::setprecision(0) << std::setw(14) << (queryTime > 0.0 ? nrOfPoints / (queryTime / 1000.0) : 0.0)
+					<< std::setprecision(1) << std::setw(12) << double(nrOfFound) / nrOfPoints << "\n";
+
+				SAFE_DELETE(pIndex);
+			}
+		}
+	}
+}
@@ -0,0 +1,26 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// SpatialIndexBenchmark.h: Headless benchmark of the ISpatialIndex backends.
+// Measures build, update and query times for different point counts and distributions,
+// no window, physics or agents are needed. Run the executable with --benchmark-spatial.
+/*=============================================================================*/
+
+#pragma once
+#include <vector>
+#include <ostream>
+
+namespace SpatialIndexBenchmark
+{
+	struct Settings
+	{
+		std::vector<int> pointCounts{ 1000, 4000, 16000 };
+		float worldSize{ 1000.0f };
+		float queryRadius{ 15.0f };
+		int nrOfUpdates{ 10 };  // Frames of movement that are timed
+		unsigned int seed{ 1337 };
+	};
+
+	void Run(const Settings& settings, std::ostream& output);
+}
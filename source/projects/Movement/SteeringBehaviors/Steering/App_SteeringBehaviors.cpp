@@ -6,6 +6,7 @@
 #include "../SteeringAgent.h"
 #include "SteeringBehaviors.h"
 #include "../Obstacle.h"
+#include "../SpacePartitioning/ObstacleGrid.h"
 
 using namespace Elite;
 
@@ -22,6 +23,7 @@ App_SteeringBehaviors::~App_SteeringBehaviors()
 	for (auto& o : m_Obstacles)
 		SAFE_DELETE(o);
 	m_Obstacles.clear();
+	SAFE_DELETE(m_pObstacleGrid);
 }
 
 void App_SteeringBehaviors::RemoveAgent(UINT index)
@@ -80,6 +82,9 @@ void App_SteeringBehaviors::Start()
 	DEBUGRENDERER2D->GetActiveCamera()->SetZoom(55.0f);
 	DEBUGRENDERER2D->GetActiveCamera()->SetCenter(Elite::Vector2(m_TrimWorldSize / 1.5f, m_TrimWorldSize / 2));
 
+	// Cells of the largest obstacle diameter, the margin covers the agent radius for the feelers
+	m_pObstacleGrid = new ObstacleGrid(Elite::ZeroVector2, m_ObstacleGridSize, m_MaxObstacleRadius * 2.f, 1.f);
+
 	AddAgent(BehaviorTypes::Seek, -1);
 	m_AgentVec[0].pAgent->SetRenderBehavior(true);
 
@@ -166,6 +171,14 @@ void App_SteeringBehaviors::Update(float deltaTime)
 
 		if (ImGui::Button("Add Obstacle"))
 			AddObstacle();
+		ImGui::SameLine();
+		if (ImGui::Button("Add 100"))
+		{
+			for (int i{}; i < 100; ++i)
+				AddObstacle();
+		}
+		ImGui::Text("%i obstacles", int(m_Obstacles.size()));
+		ImGui::Checkbox("Render Obstacle Grid", &m_RenderObstacleGrid);
 
 		ImGui::Spacing();
 		ImGui::Separator();
@@ -305,6 +318,9 @@ void App_SteeringBehaviors::Render(float deltaTime) const
 		RenderWorldBounds(m_TrimWorldSize);
 	}
 
+	if (m_RenderObstacleGrid)
+		m_pObstacleGrid->RenderCells();
+
 	//Render Target
 	if (m_VisualizeTarget)
 		DEBUGRENDERER2D->DrawSolidCircle(m_Target.Position, 0.3f, { 0.f,0.f }, { 1.f,0.f,0.f }, -0.8f);
@@ -339,6 +355,9 @@ void App_SteeringBehaviors::SetAgentBehavior(ImGui_Agent& a)
 	case BehaviorTypes::Evade:
 		a.pBehavior = new Evade();
 		break;
+	case BehaviorTypes::AvoidObstacle:
+		a.pBehavior = new AvoidObstacle(m_pObstacleGrid);
+		break;
 	}
 
 	UpdateTarget(a);
@@ -386,7 +405,10 @@ void App_SteeringBehaviors::AddObstacle()
 	auto pos = GetRandomObstaclePosition(radius, positionFound);
 
 	if (positionFound)
+	{
 		m_Obstacles.push_back(new Obstacle(pos, radius));
+		m_pObstacleGrid->Insert(m_Obstacles.back());
+	}
 }
 
 Elite::Vector2 App_SteeringBehaviors::GetRandomObstaclePosition(float newRadius, bool& positionFound)
@@ -401,17 +423,9 @@ Elite::Vector2 App_SteeringBehaviors::GetRandomObstaclePosition(float newRadius,
 		positionFound = true;
 		pos = randomVector2(0, m_TrimWorldSize);
 
-		for (const auto& obstacle : m_Obstacles)
-		{
-			auto radiusSum = newRadius + obstacle->GetRadius();
-			auto distance = Distance(pos, obstacle->GetCenter());
-
-			if (distance < radiusSum + m_MinObstacleDistance)
-			{
-				positionFound = false;
-				break;
-			}
-		}
+		// Any obstacle closer than the minimum distance, only the nearby cells are checked
+		if (m_pObstacleGrid->QueryRadius(pos, newRadius + m_MinObstacleDistance, m_ObstacleQueryResults) > 0)
+			positionFound = false;
 		++tries;
 	}
 
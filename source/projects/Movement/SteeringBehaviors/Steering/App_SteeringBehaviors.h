@@ -7,6 +7,7 @@
 #include "SteeringBehaviors.h"
 class SteeringAgent;
 class Obstacle;
+class ObstacleGrid;
 
 //-----------------------------------------------------------------
 // Application
@@ -66,6 +67,12 @@ private:
 	const float m_MinObstacleRadius = 1.f;
 	const float m_MinObstacleDistance = 10.f;
 
+	// Static grid over the obstacles, covers the largest trim size
+	ObstacleGrid* m_pObstacleGrid = nullptr;
+	const float m_ObstacleGridSize = 200.f;
+	std::vector<const Obstacle*> m_ObstacleQueryResults = std::vector<const Obstacle*>(1);  // Only needs to know if any obstacle is too close
+	bool m_RenderObstacleGrid = false;
+
 	//Interface Functions
 	void RemoveAgent(UINT index);
 	ImGui_Agent App_SteeringBehaviors::AddAgent(BehaviorTypes behaviorType = BehaviorTypes::Wander, int targetId = -1, bool autoOrient = true, float mass = 1.f, float maxSpd = 7.f);
@@ -5,8 +5,33 @@
 #include "SteeringBehaviors.h"
 #include "../SteeringAgent.h"
 #include "../Obstacle.h"
+#include "../SpacePartitioning/ObstacleGrid.h"
 #include "framework\EliteMath\EMatrix2x3.h"
 
+namespace
+{
+	// Direction scaled to the given speed, zero when the direction is too small to normalize (same as Vector2::Normalize)
+	// Written without branches on the vector so the batch loops can be vectorized
+	inline Elite::Vector2 ScaleToSpeed(float x, float y, float speed)
+	{
+		const float magnitudeSquared{ x * x + y * y };
+		const float scale{ magnitudeSquared > Elite::Square(FLT_EPSILON) ? speed / sqrtf(magnitudeSquared) : 0.0f };
+		return Elite::Vector2{ x * scale, y * scale };
+	}
+}
+
+///////////////////////////////////////
+//ISTEERINGBEHAVIOR
+//****
+void ISteeringBehavior::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	// No batch version for this behavior, evaluate agent per agent
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		outputs[index] = states[index].pAgent ? CalculateSteering(deltaT, states[index].pAgent) : SteeringOutput{ Elite::ZeroVector2, 0.0f, false };
+	}
+}
+
 ///////////////////////////////////////
 //SEEK
 //****
@@ -32,6 +57,16 @@ SteeringOutput Seek::CalculateSteering(float deltaT, SteeringAgent * pAgent)
 	return steering;
 }
 
+void Seek::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	const Elite::Vector2 target{ m_Target.Position };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		outputs[index] = SteeringOutput{ ScaleToSpeed(target.x - state.Position.x, target.y - state.Position.y, state.MaxLinearSpeed) };
+	}
+}
+
 ///////////////////////////////////////
 //FLEE
 //****
@@ -59,6 +94,16 @@ SteeringOutput Flee::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Flee::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	const Elite::Vector2 target{ m_Target.Position };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		outputs[index] = SteeringOutput{ ScaleToSpeed(state.Position.x - target.x, state.Position.y - target.y, state.MaxLinearSpeed) };
+	}
+}
+
 ///////////////////////////////////////
 //ARRIVE
 //****
@@ -109,6 +154,26 @@ SteeringOutput Arrive::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Arrive::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	// Same radii as CalculateSteering
+	constexpr float arrivalRadiusSquared{ Elite::Square(1.0f) };
+	constexpr float slowRadiusSquared{ Elite::Square(15.0f) };
+
+	const Elite::Vector2 target{ m_Target.Position };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		const float x{ target.x - state.Position.x };
+		const float y{ target.y - state.Position.y };
+		const float distanceSquared{ x * x + y * y };
+
+		float speed{ state.MaxLinearSpeed * std::min(distanceSquared / slowRadiusSquared, 1.0f) };
+		speed = distanceSquared < arrivalRadiusSquared ? 0.0f : speed;
+		outputs[index] = SteeringOutput{ ScaleToSpeed(x, y, speed) };
+	}
+}
+
 SteeringOutput Face::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 {
 
@@ -155,6 +220,26 @@ SteeringOutput Face::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 
 }
 
+void Face::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	const Elite::Vector2 target{ m_Target.Position };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		const Elite::Vector2 targetVector{ target - state.Position };
+		const Elite::Vector2 agentDirection{ cosf(state.Rotation), sinf(state.Rotation) };
+		const float angleBetween{ Elite::AngleBetween(targetVector, agentDirection) };
+		const float absoluteAngle{ fabsf(angleBetween) };
+
+		// Full speed towards the target, slowing down within the slow angle and stopping within the stop angle
+		float angularVelocity{ angleBetween > 0.0f ? -state.MaxAngularSpeed : state.MaxAngularSpeed };
+		angularVelocity *= std::min(absoluteAngle / m_SlowRotationAngle, 1.0f);
+		angularVelocity = absoluteAngle > m_StopRotationAngle ? angularVelocity : 0.0f;
+
+		outputs[index] = SteeringOutput{ Elite::ZeroVector2, angularVelocity };
+	}
+}
+
 SteeringOutput Wander::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 {
 	SteeringOutput steering{};
@@ -188,6 +273,29 @@ SteeringOutput Wander::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return Seek::CalculateSteering(deltaT, pAgent);
 }
 
+void Wander::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	if (m_BatchWanderAngles.size() < states.Size)
+		m_BatchWanderAngles.resize(states.Size, m_WanderAngle);
+
+	// Random numbers are drawn first, the steering loop itself has no calls that block vectorization
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		m_BatchWanderAngles[index] += Elite::randomFloat(-m_MaxAngleChange, m_MaxAngleChange);
+	}
+
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		const Elite::Vector2 direction{ ScaleToSpeed(state.LinearVelocity.x, state.LinearVelocity.y, 1.0f) };
+		const float wanderAngle{ m_BatchWanderAngles[index] };
+
+		const float targetX{ state.Position.x + m_OffsetDistance * direction.x + m_Radius * cosf(wanderAngle) };
+		const float targetY{ state.Position.y + m_OffsetDistance * direction.y + m_Radius * sinf(wanderAngle) };
+		outputs[index] = SteeringOutput{ ScaleToSpeed(targetX - state.Position.x, targetY - state.Position.y, state.MaxLinearSpeed) };
+	}
+}
+
 SteeringOutput Pursuit::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 {
 	// Calculate intercept target
@@ -214,6 +322,22 @@ SteeringOutput Pursuit::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 }
 
+void Pursuit::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	// m_Target is shared by the whole batch, so the predicted position is kept local instead of overwriting the target
+	const Elite::Vector2 target{ m_Target.Position };
+	const Elite::Vector2 targetVelocity{ m_Target.LinearVelocity };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		const float x{ target.x - state.Position.x };
+		const float y{ target.y - state.Position.y };
+		const float timeToTarget{ sqrtf(x * x + y * y) / state.MaxLinearSpeed };
+
+		outputs[index] = SteeringOutput{ ScaleToSpeed(x + targetVelocity.x * timeToTarget, y + targetVelocity.y * timeToTarget, state.MaxLinearSpeed) };
+	}
+}
+
 SteeringOutput Evade::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 {
 	// Tries to evade the path of the target	
@@ -250,3 +374,64 @@ SteeringOutput Evade::CalculateSteering(float deltaT, SteeringAgent* pAgent)
 	return steering;
 
 }
+
+void Evade::CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs)
+{
+	const Elite::Vector2 target{ m_Target.Position };
+	const Elite::Vector2 targetVelocity{ m_Target.LinearVelocity };
+	const float evadeRadiusSquared{ Elite::Square(m_EvadeRadius) };
+	for (size_t index{}; index < states.Size; ++index)
+	{
+		const AgentSteeringState& state{ states[index] };
+		const float x{ target.x - state.Position.x };
+		const float y{ target.y - state.Position.y };
+		const float distanceSquared{ x * x + y * y };
+		const float timeToTarget{ sqrtf(distanceSquared) / state.MaxLinearSpeed };
+
+		// Flee from the predicted position, invalid when the target is too far to evade
+		const bool isValid{ distanceSquared <= evadeRadiusSquared };
+		const Elite::Vector2 fleeVelocity{ ScaleToSpeed(-x - targetVelocity.x * timeToTarget, -y - targetVelocity.y * timeToTarget, state.MaxLinearSpeed) };
+		outputs[index] = SteeringOutput{ isValid ? fleeVelocity : Elite::ZeroVector2, 0.0f, isValid };
+	}
+}
+
+SteeringOutput AvoidObstacle::CalculateSteering(float deltaT, SteeringAgent* pAgent)
+{
+	SteeringOutput steering{ Seek::CalculateSteering(deltaT, pAgent) };
+
+	// Feeler along the current velocity, towards the target when standing still
+	Elite::Vector2 forward{ pAgent->GetLinearVelocity() };
+	if (forward.Normalize() == 0.0f)
+		forward = steering.LinearVelocity.GetNormalized();
+	if (forward.MagnitudeSquared() == 0.0f)
+		return steering;
+
+	// Only the cells along the feeler are checked, not every obstacle in the scene
+	float hitDistance{};
+	const Obstacle* pObstacle{ m_pObstacleGrid->Raycast(pAgent->GetPosition(), forward, m_FeelerLength, pAgent->GetRadius(), hitDistance) };
+
+	if (pAgent->CanRenderBehavior())
+	{
+		DEBUGRENDERER2D->DrawSegment(pAgent->GetPosition(), pAgent->GetPosition() + forward * hitDistance, pObstacle ? Elite::Color(1.0f, 0.0f, 0.0f) : Elite::Color(0.0f, 1.0f, 1.0f));
+	}
+
+	if (!pObstacle)
+		return steering;
+
+	// Steer sideways, away from the obstacle center, the closer the hit the more the avoidance takes over
+	const Elite::Vector2 toCenter{ pObstacle->GetCenter() - pAgent->GetPosition() };
+	Elite::Vector2 awayDirection{ forward * forward.Dot(toCenter) - toCenter };
+	if (awayDirection.Normalize() == 0.0f)
+		awayDirection = Elite::Vector2{ forward.y, -forward.x };  // Heading straight at the center, pick a side
+
+	const float urgency{ 1.0f - hitDistance / m_FeelerLength };
+	steering.LinearVelocity = steering.LinearVelocity * (1.0f - urgency) + awayDirection * (pAgent->GetMaxLinearSpeed() * urgency);
+
+	if (pAgent->CanRenderBehavior())
+	{
+		DEBUGRENDERER2D->DrawCircle(pObstacle->GetCenter(), pObstacle->GetRadius() + 0.5f, Elite::Color(1.0f, 0.0f, 0.0f), 0.0f);
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), awayDirection, 5.0f * urgency, Elite::Color(1.0f, 0.5f, 0.0f));
+	}
+
+	return steering;
+}
@@ -13,6 +13,7 @@
 #include "../SteeringHelpers.h"
 class SteeringAgent;
 class Obstacle;
+class ObstacleGrid;
 
 #pragma region **ISTEERINGBEHAVIOR** (BASE)
 class ISteeringBehavior
@@ -22,6 +23,9 @@ public:
 	virtual ~ISteeringBehavior() = default;
 
 	virtual SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) = 0;
+	//Evaluates the behavior for every state and writes the result to the output with the same index (outputs needs at least as many elements as states)
+	//Batches don't draw debug visualization, the default implementation calls CalculateSteering on the agent of every state
+	virtual void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs);
 
 	//Seek Functions
 	void SetTarget(const TargetData& target) { m_Target = target; }
@@ -46,6 +50,7 @@ public:
 
 	//Seek Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 };
 
 ///////////////////////////////////////
@@ -59,6 +64,7 @@ public:
 
 	// Fleeing Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 };
 
 ///////////////////////////////////////
@@ -72,6 +78,7 @@ public:
 
 	//Arrive Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 };
 
 ///////////////////////////////////////
@@ -85,6 +92,8 @@ public:
 
 	//Facing Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Doesn't turn off auto orient like CalculateSteering does, agents facing in a batch need it disabled beforehand
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 private:
 	const float m_SlowRotationAngle{ Elite::ToRadians(10.0f) };  // Angle in radians when to slow down the rotation
 	const float m_StopRotationAngle{ Elite::ToRadians(0.1f) };  // Angle in radians when to stop the rotation
@@ -101,6 +110,8 @@ public:
 
 	//Wander Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//Every index in the batch keeps its own wander angle, so keep the agents in the same order between updates
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 	void SetWanderOffset(float offset) { m_OffsetDistance = offset; };
 
 protected:
@@ -108,6 +119,7 @@ protected:
 	float m_Radius{ 4.0f };  // Radius of the circle used to pick the target
 	float m_MaxAngleChange{ Elite::ToRadians(20.0f) };
 	float m_WanderAngle{};
+	std::vector<float> m_BatchWanderAngles{};  // Wander angle per index of the batch
 
 };
 
@@ -123,6 +135,7 @@ public:
 
 	//Pursuit Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 };
 
 
@@ -137,6 +150,7 @@ public:
 
 	//Evade Behaviour
 	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override;
 	
 	void SetEvadeRadius(float evadeRadius) { m_EvadeRadius = evadeRadius; };
 	
@@ -147,6 +161,29 @@ protected:
 	
 };
 
+
+///////////////////////////////////////
+//Avoid Obstacle
+//****
+class AvoidObstacle : public Seek
+{
+public:
+	AvoidObstacle(const ObstacleGrid* pObstacleGrid) : m_pObstacleGrid(pObstacleGrid) {};
+	virtual ~AvoidObstacle() = default;
+
+	//Avoid Obstacle Behaviour (seeks the target and steers around the first obstacle along the feeler)
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* pAgent) override;
+	//The feeler needs the agent radius, so batches go through CalculateSteering instead of the Seek batch
+	void CalculateSteeringBatch(float deltaT, Span<const AgentSteeringState> states, Span<SteeringOutput> outputs) override
+	{ ISteeringBehavior::CalculateSteeringBatch(deltaT, states, outputs); }
+
+	void SetFeelerLength(float feelerLength) { m_FeelerLength = feelerLength; };
+
+protected:
+	const ObstacleGrid* m_pObstacleGrid = nullptr;
+	float m_FeelerLength{ 10.0f };  // Distance in front of the agent that is checked for obstacles
+};
+
 #endif
 
 
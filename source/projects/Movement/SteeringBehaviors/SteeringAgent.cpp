@@ -6,13 +6,39 @@ void SteeringAgent::Update(float dt)
 {
 	if(m_pSteeringBehavior)
 	{
-		auto output = m_pSteeringBehavior->CalculateSteering(dt, this);
+		ApplySteering(m_pSteeringBehavior->CalculateSteering(dt, this), dt);
+	}
+
+	//Agents without rigidbody are not moved by the physics world
+	IntegrateKinematicState(dt);
+}
 
-		//Linear Movement
-		//***************
+AgentSteeringState SteeringAgent::GetSteeringState() const
+{
+	AgentSteeringState state{};
+	state.Position = GetPosition();
+	state.Rotation = GetRotation();
+	state.LinearVelocity = GetLinearVelocity();
+	state.MaxLinearSpeed = m_MaxLinearSpeed;
+	state.MaxAngularSpeed = m_MaxAngularSpeed;
+	state.pAgent = const_cast<SteeringAgent*>(this);
+	return state;
+}
+
+void SteeringAgent::ApplySteering(const SteeringOutput& output, float dt)
+{
+	//Linear Movement
+	//***************
+	if(output.IsVelocityOverride)
+	{
+		//The velocity was solved for this frame (e.g. ORCA), steering towards it would lose what it was solved for
+		SetLinearVelocity(output.LinearVelocity);
+	}
+	else
+	{
 		auto linVel = GetLinearVelocity();
 		auto steeringForce = output.LinearVelocity - linVel;
-		auto acceleration = steeringForce / GetMass();		
+		auto acceleration = steeringForce / GetMass();
 
 		if(m_RenderBehavior)
 		{
@@ -20,20 +46,43 @@ void SteeringAgent::Update(float dt)
 			//DEBUGRENDERER2D->DrawDirection(GetPosition(), linVel, linVel.Magnitude(), { 1, 0, 1 ,0.5f }, 0.40f);
 		}
 		SetLinearVelocity(linVel + (acceleration*dt));
+	}
 
-		//Angular Movement
-		//****************
-		if(m_AutoOrient)
-		{
-			auto desiredOrientation = Elite::VectorToOrientation(GetLinearVelocity());
-			SetRotation(desiredOrientation);
-		}
-		else
-		{
-			if (output.AngularVelocity > m_MaxAngularSpeed)
-				output.AngularVelocity = m_MaxAngularSpeed;
-			SetAngularVelocity(output.AngularVelocity);
-		}
+	//Angular Movement
+	//****************
+	if(m_AutoOrient)
+	{
+		auto desiredOrientation = Elite::VectorToOrientation(GetLinearVelocity());
+		SetRotation(desiredOrientation);
+	}
+	else
+	{
+		SetAngularVelocity(std::min(output.AngularVelocity, m_MaxAngularSpeed));
+	}
+}
+
+void SteeringAgent::UpdateBatch(float dt, ISteeringBehavior* pBehavior, const std::vector<SteeringAgent*>& agents,
+	std::vector<AgentSteeringState>& states, std::vector<SteeringOutput>& outputs)
+{
+	const size_t nrOfAgents{ agents.size() };
+	if(states.size() < nrOfAgents)
+		states.resize(nrOfAgents);
+	if(outputs.size() < nrOfAgents)
+		outputs.resize(nrOfAgents);
+
+	//Gather, evaluate the whole batch with a single call, then scatter the results back to the agents
+	for(size_t index{}; index < nrOfAgents; ++index)
+		states[index] = agents[index]->GetSteeringState();
+
+	if(pBehavior)
+		pBehavior->CalculateSteeringBatch(dt, Span<const AgentSteeringState>(states).First(nrOfAgents), Span<SteeringOutput>(outputs).First(nrOfAgents));
+
+	for(size_t index{}; index < nrOfAgents; ++index)
+	{
+		SteeringAgent* pAgent{ agents[index] };
+		if(pBehavior)
+			pAgent->ApplySteering(outputs[index], dt);
+		pAgent->IntegrateKinematicState(dt);
 	}
 }
 
@@ -19,7 +19,7 @@ class SteeringAgent : public BaseAgent
 public:
 	//--- Constructor & Destructor ---
 	SteeringAgent() = default;
-	SteeringAgent(float radius) : BaseAgent(radius) {};
+	SteeringAgent(float radius, bool usePhysics = true) : BaseAgent(radius, usePhysics) {};
 	virtual ~SteeringAgent() = default;
 
 	//--- Agent Functions ---
@@ -40,6 +40,14 @@ public:
 	virtual void SetSteeringBehavior(ISteeringBehavior* pBehavior) { m_pSteeringBehavior = pBehavior; }
 	ISteeringBehavior* GetSteeringBehavior() const { return m_pSteeringBehavior; }
 
+	//--- Batched Steering ---
+	AgentSteeringState GetSteeringState() const;
+	void ApplySteering(const SteeringOutput& output, float dt);  // Steers towards the output like Update does, without integrating the kinematic state
+	//Evaluates one behavior for all agents at once, then steers and integrates every agent (same result as Update on each agent with that behavior)
+	//The state and output buffers are resized when they are too small, keep them around between updates
+	static void UpdateBatch(float dt, ISteeringBehavior* pBehavior, const std::vector<SteeringAgent*>& agents,
+		std::vector<AgentSteeringState>& states, std::vector<SteeringOutput>& outputs);
+
 	void SetRenderBehavior(bool isEnabled) { m_RenderBehavior = isEnabled; }
 	bool CanRenderBehavior() const { return m_RenderBehavior; }
 
@@ -1,4 +1,5 @@
 #pragma once
+class SteeringAgent;
 
 //SteeringParams (alias TargetData)
 struct SteeringParams //Also used as Target for SteeringBehaviors
@@ -79,6 +80,7 @@ struct SteeringOutput
 	Elite::Vector2 LinearVelocity = { 0.f,0.f };
 	float AngularVelocity = 0.f;
 	bool IsValid = true;
+	bool IsVelocityOverride = false; //LinearVelocity is the new velocity of the agent instead of a target to steer towards
 
 	SteeringOutput(Elite::Vector2 linVel = { 0.f,0.f }, float angVel = 0.f, bool isValid = true)
 	{
@@ -92,6 +94,7 @@ struct SteeringOutput
 		LinearVelocity = other.LinearVelocity;
 		AngularVelocity = other.AngularVelocity;
 		IsValid = other.IsValid;
+		IsVelocityOverride = other.IsVelocityOverride;
 
 		return *this;
 	}
@@ -129,6 +132,42 @@ struct SteeringOutput
 	}
 };
 
+//Span
+//Non owning view on a contiguous array, used to pass batches around without copying (C++17 has no std::span)
+template<typename T>
+struct Span
+{
+	T* pData = nullptr;
+	size_t Size = 0;
+
+	Span() = default;
+	Span(T* pFirst, size_t size) : pData(pFirst), Size(size) {}
+	template<typename U>
+	Span(std::vector<U>& container) : pData(container.data()), Size(container.size()) {}
+	template<typename U>
+	Span(const std::vector<U>& container) : pData(container.data()), Size(container.size()) {}
+	template<typename U>
+	Span(const Span<U>& other) : pData(other.pData), Size(other.Size) {}
+
+	T& operator[](size_t index) const { return pData[index]; }
+	T* begin() const { return pData; }
+	T* end() const { return pData + Size; }
+	Span First(size_t count) const { return Span(pData, count); }
+};
+
+//AgentSteeringState
+//Copy of the agent data the behaviors read, batches are evaluated on these instead of on the agents themselves
+struct AgentSteeringState
+{
+	Elite::Vector2 Position = Elite::ZeroVector2;
+	float Rotation = 0.f;
+	Elite::Vector2 LinearVelocity = Elite::ZeroVector2;
+	float MaxLinearSpeed = 0.f;
+	float MaxAngularSpeed = 0.f;
+
+	SteeringAgent* pAgent = nullptr; //Only used by behaviors that have no batch implementation
+};
+
 //=== TEMPORARILY ADDED HERE - IS PART OF COMBINED STEERING! ===
 struct Goal
 {
@@ -0,0 +1,42 @@
+/*=============================================================================*/
+// Copyright 2023
+// Authors: Dejonckheere Ward
+/*=============================================================================*/
+// AgarioBlackboardKeys.h: the blackboard keys of the agario games, made once at startup so the behaviors
+// and states don't look up a name every frame. Every translation unit gets its own copy of the keys, keys with the
+// same name and type resolve to the same index so the copies are interchangeable.
+/*=============================================================================*/
+#ifndef ELITE_AGARIO_BLACKBOARD_KEYS
+#define ELITE_AGARIO_BLACKBOARD_KEYS
+
+#include "framework/EliteAI/EliteData/EBlackboard.h"
+
+class AgarioAgent;
+class AgarioFood;
+class ISpatialIndex;
+
+namespace AgarioKeys
+{
+	// --- Behavior Tree & Influence Map ---
+	const Elite::BlackboardKey<AgarioAgent*> Agent{ "Agent" };
+	const Elite::BlackboardKey<std::vector<AgarioAgent*>*> AgentsVec{ "AgentsVec" };
+	const Elite::BlackboardKey<std::vector<AgarioFood*>*> FoodVec{ "FoodVec" };
+	const Elite::BlackboardKey<float> WorldSize{ "WorldSize" };
+	const Elite::BlackboardKey<Elite::Vector2> Target{ "Target" };
+	const Elite::BlackboardKey<AgarioAgent*> AgentFleeTarget{ "AgentFleeTarget" };
+	const Elite::BlackboardKey<float> Time{ "Time" };
+	// Published by the app every frame, the conditions of the event driven trees observe these (see BT_Queries)
+	const Elite::BlackboardKey<AgarioFood*> NearbyFood{ "NearbyFood" };
+	const Elite::BlackboardKey<AgarioAgent*> NearbyBiggerAgent{ "NearbyBiggerAgent" };
+	const Elite::BlackboardKey<AgarioAgent*> NearbySmallerAgent{ "NearbySmallerAgent" };
+
+	// --- Finite State Machine ---
+	const Elite::BlackboardKey<AgarioAgent*> AgentPtr{ "AgentPtr" };
+	const Elite::BlackboardKey<std::vector<AgarioFood*>*> FoodVecPtr{ "FoodVecPtr" };
+	const Elite::BlackboardKey<AgarioFood*> FoodPtr{ "FoodPtr" };
+	const Elite::BlackboardKey<std::vector<AgarioAgent*>*> AgentVecPtr{ "AgentVecPtr" };  // List of all agents, to check for bigger agents
+	const Elite::BlackboardKey<AgarioAgent*> FleeAgentPtr{ "FleeAgentPtr" };  // The agent that is bigger than the current agent and we evade
+	const Elite::BlackboardKey<ISpatialIndex*> FoodIndexPtr{ "FoodIndexPtr" };  // Ids are indices in FoodVecPtr
+	const Elite::BlackboardKey<ISpatialIndex*> AgentIndexPtr{ "AgentIndexPtr" };  // Ids are indices in AgentVecPtr
+}
+#endif
@@ -1,17 +1,10 @@
 #include "stdafx.h"
 #include "BaseAgent.h"
 
-BaseAgent::BaseAgent(float radius) : m_Radius(radius)
+BaseAgent::BaseAgent(float radius, bool usePhysics) : m_Radius(radius)
 {
-	//Create Rigidbody
-	const Elite::RigidBodyDefine define = Elite::RigidBodyDefine(0.01f, 0.1f, Elite::eDynamic, false);
-	const Transform transform = Transform(Elite::ZeroVector2, {0,90});
-	m_pRigidBody = new RigidBody(define, transform);
-
-	//Add shape
-	Elite::EPhysicsCircleShape shape;
-	shape.radius = m_Radius;
-	m_pRigidBody->AddShape(&shape);
+	if (usePhysics)
+		CreateRigidBody();
 }
 
 
@@ -24,14 +17,75 @@ void BaseAgent::Update(float dt)
 {
 }
 
+void BaseAgent::SetPhysicsEnabled(bool isEnabled)
+{
+	if (isEnabled == HasPhysics())
+		return;
+
+	if (isEnabled)
+	{
+		//Take over the current state, the rigidbody starts where the agent is
+		const KinematicState state = m_KinematicState;
+		CreateRigidBody();
+		m_pRigidBody->SetPosition(state.Position);
+		m_pRigidBody->SetRotation({ state.Rotation, 0.f });
+		m_pRigidBody->SetLinearVelocity(state.LinearVelocity);
+		m_pRigidBody->SetAngularVelocity({ state.AngularVelocity, 0.f });
+		m_pRigidBody->SetMass(state.Mass);
+		m_pRigidBody->SetUserData(m_UserData);
+	}
+	else
+	{
+		m_KinematicState.Position = m_pRigidBody->GetPosition();
+		m_KinematicState.Rotation = m_pRigidBody->GetRotation().x;
+		m_KinematicState.LinearVelocity = m_pRigidBody->GetLinearVelocity();
+		m_KinematicState.AngularVelocity = m_pRigidBody->GetAngularVelocity().x;
+		m_KinematicState.Mass = m_pRigidBody->GetMass();
+		m_PreviousPosition = m_KinematicState.Position;
+		m_UserData = m_pRigidBody->GetUserData();
+		SAFE_DELETE(m_pRigidBody);
+	}
+}
+
+void BaseAgent::IntegrateKinematicState(float dt)
+{
+	if (m_pRigidBody)
+		return;
+
+	m_PreviousPosition = m_KinematicState.Position;
+	m_KinematicState.Position += m_KinematicState.LinearVelocity * dt;
+	m_KinematicState.Rotation += m_KinematicState.AngularVelocity * dt;
+}
+
+Elite::Vector2 BaseAgent::GetRenderPosition() const
+{
+	if (!m_InterpolateRender || m_pRigidBody)
+		return GetPosition();
+
+	return Elite::Lerp(m_PreviousPosition, m_KinematicState.Position, SIMULATIONCLOCK->GetAlpha());
+}
+
+void BaseAgent::CreateRigidBody()
+{
+	//Create Rigidbody
+	const Elite::RigidBodyDefine define = Elite::RigidBodyDefine(0.01f, 0.1f, Elite::eDynamic, false);
+	const Transform transform = Transform(Elite::ZeroVector2, {0,90});
+	m_pRigidBody = new RigidBody(define, transform);
+
+	//Add shape
+	Elite::EPhysicsCircleShape shape;
+	shape.radius = m_Radius;
+	m_pRigidBody->AddShape(&shape);
+}
+
 void BaseAgent::Render(float dt)
 {
 	auto o = GetRotation();
-	auto p = GetPosition();
+	auto p = GetRenderPosition();
 	auto r = Elite::ToRadians(150.f);
 
 	//EliteDebugRenderer2D::GetInstance()->DrawSolidCircle(GetPosition(), m_Radius, { 0,0 }, m_BodyColor);
-	DEBUGRENDERER2D->DrawSolidCircle(GetPosition(), m_Radius, { 0,0 }, m_BodyColor);
+	DEBUGRENDERER2D->DrawSolidCircle(p, m_Radius, { 0,0 }, m_BodyColor);
 
 	std::vector<Elite::Vector2> points;
 	points.push_back(Elite::Vector2(static_cast<float>(cos(o)) * m_Radius, static_cast<float>(sin(o)) * m_Radius) + p);
@@ -40,12 +94,13 @@ void BaseAgent::Render(float dt)
 
 	DEBUGRENDERER2D->DrawSolidPolygon(&points[0], 3, { 0,0,0,1 }, DEBUGRENDERER2D->NextDepthSlice());
 }
-void BaseAgent::TrimToWorld(float worldBounds, bool isWorldLooping) const {
+void BaseAgent::TrimToWorld(float worldBounds, bool isWorldLooping) {
 	TrimToWorld({ 0, 0 }, { worldBounds, worldBounds }, isWorldLooping);
 }
-void BaseAgent::TrimToWorld(const Elite::Vector2& bottomLeft, const Elite::Vector2& topRight, bool isWorldLooping /* = true */) const
+void BaseAgent::TrimToWorld(const Elite::Vector2& bottomLeft, const Elite::Vector2& topRight, bool isWorldLooping /* = true */)
 {
-	auto pos = GetPosition();
+	const auto oldPos = GetPosition();
+	auto pos = oldPos;
 
 	if (isWorldLooping)
 	{
@@ -65,5 +120,7 @@ void BaseAgent::TrimToWorld(const Elite::Vector2& bottomLeft, const Elite::Vecto
 		pos.y = Elite::Clamp(pos.y, bottomLeft.y, topRight.y);
 	}
 
-	SetPosition(pos);
+	//Only teleport agents that left the world, setting the position also resets the render interpolation
+	if (pos != oldPos)
+		SetPosition(pos);
 }
\ No newline at end of file
@@ -4,54 +4,82 @@
 class BaseAgent
 {
 public:
-	BaseAgent(float radius = 1.f);
+	BaseAgent(float radius = 1.f, bool usePhysics = true);
 	virtual ~BaseAgent();
 
 	virtual void Update(float dt);
 	virtual void Render(float dt);
 
 	//Functions
-	void TrimToWorld(float worldBounds, bool isWorldLooping = true) const;
-	void TrimToWorld(const Elite::Vector2& bottomLeft, const Elite::Vector2& topRight, bool isWorldLooping = true) const;
+	void TrimToWorld(float worldBounds, bool isWorldLooping = true);
+	void TrimToWorld(const Elite::Vector2& bottomLeft, const Elite::Vector2& topRight, bool isWorldLooping = true);
+
+	//Physics
+	//Without a rigidbody the state lives in the agent itself and has to be integrated by the agent (IntegrateKinematicState)
+	bool HasPhysics() const { return m_pRigidBody != nullptr; }
+	void SetPhysicsEnabled(bool isEnabled); //Creates or destroys the rigidbody, the current state is carried over
 
 	//Get - Set
-	Elite::Vector2 GetPosition() const { return m_pRigidBody->GetPosition(); }
+	Elite::Vector2 GetPosition() const { return m_pRigidBody ? m_pRigidBody->GetPosition() : m_KinematicState.Position; }
 	Elite::Vector2 GetOldPosition() const { return m_OldPosition; }
-	void SetPosition(const Elite::Vector2& pos) const { m_pRigidBody->SetPosition(pos); }
+	void SetPosition(const Elite::Vector2& pos) { if (m_pRigidBody) m_pRigidBody->SetPosition(pos); else m_KinematicState.Position = m_PreviousPosition = pos; }
 	void SetOldPosition(const Elite::Vector2& pos) { m_OldPosition = pos; }
 
 	float GetRotation() const {
-		return Elite::ClampedAngle(m_pRigidBody->GetRotation().x);}
-	void SetRotation(float rot) const { m_pRigidBody->SetRotation({ rot, 0.0f }); } 
+		return Elite::ClampedAngle(m_pRigidBody ? m_pRigidBody->GetRotation().x : m_KinematicState.Rotation);}
+	void SetRotation(float rot) { if (m_pRigidBody) m_pRigidBody->SetRotation({ rot, 0.0f }); else m_KinematicState.Rotation = rot; }
 
-	Elite::Vector2 GetLinearVelocity() const { return m_pRigidBody->GetLinearVelocity(); }
-	void SetLinearVelocity(const Elite::Vector2& linVel) const { m_pRigidBody->SetLinearVelocity(linVel); }
+	Elite::Vector2 GetLinearVelocity() const { return m_pRigidBody ? m_pRigidBody->GetLinearVelocity() : m_KinematicState.LinearVelocity; }
+	void SetLinearVelocity(const Elite::Vector2& linVel) { if (m_pRigidBody) m_pRigidBody->SetLinearVelocity(linVel); else m_KinematicState.LinearVelocity = linVel; }
 
-	float GetAngularVelocity() const { return m_pRigidBody->GetAngularVelocity().x; }
-	void SetAngularVelocity(float angVel) const { m_pRigidBody->SetAngularVelocity({ angVel,0.f }); }
+	float GetAngularVelocity() const { return m_pRigidBody ? m_pRigidBody->GetAngularVelocity().x : m_KinematicState.AngularVelocity; }
+	void SetAngularVelocity(float angVel) { if (m_pRigidBody) m_pRigidBody->SetAngularVelocity({ angVel,0.f }); else m_KinematicState.AngularVelocity = angVel; }
 	
-	float GetMass() const { return m_pRigidBody->GetMass(); }
-	void SetMass(float mass) const { m_pRigidBody->SetMass(mass); }
+	float GetMass() const { return m_pRigidBody ? m_pRigidBody->GetMass() : m_KinematicState.Mass; }
+	void SetMass(float mass) { if (m_pRigidBody) m_pRigidBody->SetMass(mass); else m_KinematicState.Mass = mass; }
 
 	const Elite::Color& GetBodyColor() const { return m_BodyColor; }
 	void SetBodyColor(const Elite::Color& col) { m_BodyColor = col; }
 
-	Elite::RigidBodyUserData GetUserData() const { return m_pRigidBody->GetUserData(); }
-	void SetUserData(Elite::RigidBodyUserData userData) { m_pRigidBody->SetUserData(userData); }
+	Elite::RigidBodyUserData GetUserData() const { return m_pRigidBody ? m_pRigidBody->GetUserData() : m_UserData; }
+	void SetUserData(Elite::RigidBodyUserData userData) { if (m_pRigidBody) m_pRigidBody->SetUserData(userData); else m_UserData = userData; }
 
 	float GetRadius() const { return m_Radius; }
 
+	//Rendering
+	//Agents updated in IApp::FixedUpdate can be drawn in between their last two steps (SIMULATIONCLOCK alpha), only without rigidbody
+	void SetRenderInterpolation(bool isEnabled) { m_InterpolateRender = isEnabled; }
+	Elite::Vector2 GetRenderPosition() const;
+
 protected:
+	//State of an agent without rigidbody, same meaning as the rigidbody values
+	struct KinematicState
+	{
+		Elite::Vector2 Position = {};
+		float Rotation = 0.f;
+		Elite::Vector2 LinearVelocity = {};
+		float AngularVelocity = 0.f;
+		float Mass = 1.f;
+	};
+
 	RigidBody* m_pRigidBody = nullptr;
+	KinematicState m_KinematicState = {};
 	float m_Radius = 1.f;
 	Elite::Color m_BodyColor = { 1,1,0,1 };
+	Elite::Vector2 m_PreviousPosition = {};  //Kinematic position before the last integration step
+	bool m_InterpolateRender = false;
+
+	//Explicit euler step of the kinematic state, does nothing when the rigidbody (box2D) moves the agent
+	void IntegrateKinematicState(float dt);
 
 private:
+	void CreateRigidBody();
 
 	//C++ make the class non-copyable
 	BaseAgent(const BaseAgent&) {};
 	BaseAgent& operator=(const BaseAgent&) {};
 
 	Elite::Vector2 m_OldPosition;
+	Elite::RigidBodyUserData m_UserData = {};
 };
 #endif
\ No newline at end of file
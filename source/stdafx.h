@@ -27,6 +27,9 @@ stdafx.h: Precompiled header for engine. Includes all standard files, as well as
 #include <functional>
 #include <unordered_map>
 #include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #pragma endregion //StandardLibraryIncludes
 
@@ -121,6 +124,7 @@ extern bool gRequestShutdown;
 /* --- DEFINES --- */
 #define USE_BOX2D
 #define USE_VLD
+#define USE_PROFILER //Scoped timing markers, see EProfiler.h
 
 /* --- PLATFORMS --- */
 #define PLATFORM_WINDOWS 0
@@ -175,6 +179,8 @@ extern bool gRequestShutdown;
 #include "framework/EliteInput/EInputManager.h"
 #include "framework/EliteWindow/EWindow.h"
 #include "framework/EliteTimer/ETimer.h"
+#include "framework/EliteTimer/ESimulationClock.h"
+#include "framework/EliteProfiler/EProfiler.h"
 #include "framework/EliteRendering/ERendering.h"
 #include "framework/EliteUI/EImmediateUI.h"
 #include "framework/EliteAI/EliteDecisionMaking/EDecisionMaking.h"
@@ -183,6 +189,8 @@ extern bool gRequestShutdown;
 /* --- FRAMEWORK MACROS ---- */
 #define INPUTMANAGER Elite::EInputManager::GetInstance()
 #define TIMER Elite::ETimer<PLATFORM_ID>::GetInstance()
+#define SIMULATIONCLOCK Elite::ESimulationClock::GetInstance()
+#define PROFILER Elite::EProfiler::GetInstance()
 #define DEBUGRENDERER2D EliteDebugRenderer2D::GetInstance()
 #define PHYSICSWORLD PhysicsWorld::GetInstance()
 #define LEVELLOADER LevelLoader::GetInstance()